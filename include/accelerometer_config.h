@@ -1,18 +1,25 @@
 #ifndef ACCELEROMETER_CONFIG_H
 #define ACCELEROMETER_CONFIG_H
 
-// Accelerometer selection - uncomment one
+#include <stdint.h>
+
+// Accelerometer selection - both drivers are built in and the sensor is
+// detected at boot (ADXL355 DEVID on SPI, then MPU6050 WHO_AM_I on I2C).
+// Uncomment one to skip probing and force a sensor.
 // #define USE_ADXL355
-#define USE_MPU6050
+// #define USE_MPU6050
 
 // Validate configuration
 #if defined(USE_ADXL355) && defined(USE_MPU6050)
     #error "Cannot define both USE_ADXL355 and USE_MPU6050"
 #endif
 
-#if !defined(USE_ADXL355) && !defined(USE_MPU6050)
-    #error "Must define either USE_ADXL355 or USE_MPU6050"
-#endif
+// Sensor found at boot
+enum AccelSensorType : uint8_t {
+    ACCEL_SENSOR_NONE = 0,
+    ACCEL_SENSOR_ADXL355 = 1,
+    ACCEL_SENSOR_MPU6050 = 2
+};
 
 // Common accelerometer interface
 struct AccelData {
@@ -22,9 +29,58 @@ struct AccelData {
     bool valid;
 };
 
+// Native sensor output in raw counts, before any scaling
+struct AccelRawData {
+    int32_t x;
+    int32_t y;
+    int32_t z;
+    bool valid;
+};
+
+// How raw counts map to g at the active configuration
+struct AccelScale {
+    int32_t counts_per_g;     // Raw counts for 1 g
+    uint8_t resolution_bits;  // Significant bits per axis
+    uint8_t range_g;          // Full-scale range in g
+};
+
+// Measurement configuration applied at runtime
+struct AccelConfig {
+    uint16_t sample_rate_hz;  // Requested output data rate
+    uint8_t range_g;          // Full-scale range in g
+    uint8_t hpf_corner;       // Sensor high-pass corner code (0 = off, sensor specific)
+    uint8_t lpf_code;         // Sensor low-pass code (MPU6050 DLPF_CFG 0-6; the ADXL355 filter follows the ODR)
+};
+
+// What the active sensor accepts in an AccelConfig
+struct AccelCapabilities {
+    uint16_t max_sample_rate_hz;  // 0 = no sensor, nothing is accepted
+    uint8_t range_mask;           // Supported ranges OR'd together (2 | 4 | 8 | 16)
+    uint8_t max_hpf_corner;       // 0 = no sensor high-pass filter
+    uint8_t max_lpf_code;         // 0 = no selectable low-pass filter
+};
+
+// Status reported with each burst (FIFO) read
+struct AccelBurstInfo {
+    uint8_t fifo_entries;  // Samples that were waiting in the sensor FIFO
+    bool overrun;          // Sensor FIFO overflowed since the previous drain
+};
+
 // Function prototypes for accelerometer interface
 bool accel_init();
+AccelSensorType accel_get_type();
+uint8_t accel_get_channel_mask();  // Bit n set = channel n sensor is active
 bool accel_read(AccelData& data);
+bool accel_read_raw(AccelRawData& data);
+bool accel_fifo_begin(uint8_t watermark_samples);
+uint16_t accel_read_burst(AccelData* samples, uint16_t max_samples, AccelBurstInfo& info);
+uint16_t accel_read_burst_raw(AccelRawData* samples, uint16_t max_samples, AccelBurstInfo& info);
+bool accel_data_ready_begin(bool use_int1);
+bool accel_configure(const AccelConfig& config);
+float accel_get_scale_factor();    // Raw counts per g at the active range
+AccelScale accel_get_scale();      // Integer scale descriptor for raw reads
+uint16_t accel_get_sample_rate();  // Active output data rate in Hz
+AccelCapabilities accel_get_capabilities();
 void accel_deinit();
 const char* accel_get_name();
 void accel_print_info();
@@ -19,12 +19,24 @@ public:
     
     // Data reading
     bool readData(AccelData& data);
+    bool readRaw(AccelRawData& data);
+    bool beginFifo(uint8_t watermark_samples);
+    bool beginDataReady(bool use_int1);
+    bool configure(const AccelConfig& config);
+    float getScaleFactor() const;
+    AccelScale getScale() const;
+    uint16_t getSampleRate() const;
+    AccelCapabilities getCapabilities() const;
+    uint16_t readBurst(AccelData* samples, uint16_t max_samples, AccelBurstInfo& info);
+    uint16_t readBurstRaw(AccelRawData* samples, uint16_t max_samples, AccelBurstInfo& info);
     AccelData getLastReading() const { return last_reading; }
     unsigned long getLastReadTime() const { return last_read_time; }
     
     // Status and information
     bool isInitialized() const { return is_initialized; }
     const char* getSensorName() const;
+    AccelSensorType getSensorType() const { return accel_get_type(); }
+    uint8_t getChannelMask() const { return accel_get_channel_mask(); }
     void printSensorInfo() const;
     
     // Utility functions
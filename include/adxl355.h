@@ -4,16 +4,44 @@
 #include <Arduino.h>
 #include <SPI.h>
 #include "config.h"
+#include "adxl355_spi.h"
 
 class ADXL355 {
 private:
   bool initialized;
+  uint8_t cs_pin;
+  uint8_t power_ctl;
+  uint8_t range_g;
+  uint8_t odr_code;
+  uint8_t hpf_corner;
+  unsigned long fifo_overruns;
+  unsigned long fifo_realignments;
+  bool fifo_overrun_pending;
+  uint8_t fifo_waiting;  // Complete samples in the FIFO when the last drain was queued
+  uint8_t fifo_queued;   // Samples the queued drain will hand back
+  uint8_t fifo_carry[9];  // Entries read past the last whole sample, oldest first
+  uint8_t fifo_carry_entries;
+  
+  #if ADXL355_SPI_TRANSPORT == SPI_TRANSPORT_IDF_DMA
+  ADXL355SpiTransport transport;
+  #else
+  uint8_t fifo_buffer[ADXL355_FIFO_DEPTH * 3];
+  uint16_t fifo_bytes;
+  #endif
+  
+  static bool power_sequenced;
+  
+  static int32_t convertSample(const uint8_t* bytes);
+  const uint8_t* fifoEntry(const uint8_t* buffer, uint16_t entry) const;
+  bool startBus();
+  void stopBus();
   
 public:
   ADXL355();
   
   // Initialization
-  bool begin();
+  bool probe(uint8_t cs = CS_PIN);
+  bool begin(uint8_t cs = CS_PIN);
   void end();
   
   // Low-level register access
@@ -24,12 +52,35 @@ public:
   void readXYZ(int32_t &x, int32_t &y, int32_t &z);
   void readAcceleration(float &x_g, float &y_g, float &z_g);
   
+  // Measurement configuration (RANGE and FILTER registers)
+  bool setRange(uint8_t range_g);
+  bool setOutputDataRate(uint16_t rate_hz);
+  bool setHighPassCorner(uint8_t corner);
+  uint8_t getRange() const { return range_g; }
+  uint16_t getOutputDataRate() const;
+  uint8_t getHighPassCorner() const { return hpf_corner; }
+  
+  // FIFO burst acquisition
+  bool configureFifo(uint8_t watermark_samples);
+  uint8_t readStatus();
+  uint8_t getFifoEntries();
+  uint16_t readFifo(int32_t* xyz, uint16_t max_samples, bool* overrun = nullptr, uint16_t* waiting = nullptr);
+  bool queueFifoRead(uint16_t max_samples);
+  uint16_t collectFifoRead(int32_t* xyz, bool* overrun = nullptr, uint16_t* waiting = nullptr);
+  unsigned long getFifoOverruns() const { return fifo_overruns; }
+  unsigned long getFifoRealignments() const { return fifo_realignments; }
+  
+  // Data-ready signalling
+  void enableDataReadyPin(bool enable);
+  void mapInterrupt1(uint8_t int_map, bool active_high);
+  
   // Device identification
   bool checkDeviceID();
   void printDeviceInfo();
   
   // Status
   bool isInitialized() const { return initialized; }
+  uint8_t getChipSelect() const { return cs_pin; }
   float getScaleFactor() const;
 };
 
@@ -0,0 +1,61 @@
+#ifndef ADXL355_SPI_H
+#define ADXL355_SPI_H
+
+#include <Arduino.h>
+#include "driver/spi_master.h"
+#include "config.h"
+
+// Largest single burst: a full FIFO drain (96 entries x 3 bytes)
+#define ADXL355_SPI_MAX_BURST  (ADXL355_FIFO_DEPTH * 3)
+
+// DMA transfers are padded to whole 32-bit words; any other length makes
+// ESP-IDF malloc a bounce buffer for every transaction. The padding clocks
+// the registers after the requested block, so callers reading FIFO_DATA (or
+// a block that ends just before it) ask for aligned lengths themselves.
+#define ADXL355_SPI_DMA_ALIGN  4
+
+// ESP-IDF spi_device transport for the ADXL355: hardware chip select,
+// DMA-capable buffers and whole-burst transactions
+class ADXL355SpiTransport {
+private:
+  spi_device_handle_t device;
+  spi_host_device_t host;
+  bool initialized;
+  
+  // Single in-flight DMA burst
+  spi_transaction_t burst_transaction;
+  uint8_t* burst_buffer;  // DMA-capable
+  uint16_t burst_length;
+  bool burst_pending;
+  
+  static uint8_t bus_users[3];  // Devices attached per SPI host
+  
+public:
+  ADXL355SpiTransport();
+  ~ADXL355SpiTransport();
+  
+  // Initialization
+  bool begin(spi_host_device_t spi_host, int8_t cs_pin, uint32_t clock_hz);
+  void end();
+  
+  // Register access (polled, lowest latency for short transfers)
+  void writeRegister(uint8_t reg, uint8_t value);
+  uint8_t readRegister(uint8_t reg);
+  bool readRegisters(uint8_t reg, uint8_t* data, uint16_t length);
+  
+  // DMA burst read: queue, then collect the completed buffer. One burst may
+  // be pending and register access is refused until it is collected; the
+  // task sleeps on the SPI interrupt instead of clocking bytes.
+  bool queueBurstRead(uint8_t reg, uint16_t length);
+  const uint8_t* collectBurstRead(uint16_t& length, TickType_t timeout = portMAX_DELAY);
+  
+  // Status
+  bool isInitialized() const { return initialized; }
+  bool isBurstPending() const { return burst_pending; }
+  
+  static uint16_t paddedLength(uint16_t length) {
+    return (length + ADXL355_SPI_DMA_ALIGN - 1) & ~(uint16_t)(ADXL355_SPI_DMA_ALIGN - 1);
+  }
+};
+
+#endif // ADXL355_SPI_H
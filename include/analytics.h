@@ -2,45 +2,71 @@
 #define ANALYTICS_H
 
 #include <Arduino.h>
+#include "config.h"
 #include "data_buffer.h"
 
-// Analytics data structure for running statistics
+// Exponential moving average weight of each new window, Q16 (6554 = 0.1)
+#define ANALYTICS_EMA_ALPHA_Q16 6554
+
+// Analytics data structure for running statistics. Values stay in raw
+// sensor counts as Q.8 fixed point (see BufferStats) all the way to the
+// register map, which converts them to milli-g with counts_per_g.
 struct AnalyticsData {
   // Current window statistics (updated every second)
-  float current_avg_x = 0.0;
-  float current_avg_y = 0.0;
-  float current_avg_z = 0.0;
-  float current_max_x = 0.0;
-  float current_max_y = 0.0;
-  float current_max_z = 0.0;
-  float current_min_x = 0.0;
-  float current_min_y = 0.0;
-  float current_min_z = 0.0;
-  float current_std_x = 0.0;
-  float current_std_y = 0.0;
-  float current_std_z = 0.0;
-  float current_rms_x = 0.0;
-  float current_rms_y = 0.0;
-  float current_rms_z = 0.0;
+  int32_t current_avg_x = 0;
+  int32_t current_avg_y = 0;
+  int32_t current_avg_z = 0;
+  int32_t current_max_x = 0;
+  int32_t current_max_y = 0;
+  int32_t current_max_z = 0;
+  int32_t current_min_x = 0;
+  int32_t current_min_y = 0;
+  int32_t current_min_z = 0;
+  int32_t current_std_x = 0;
+  int32_t current_std_y = 0;
+  int32_t current_std_z = 0;
+  int32_t current_rms_x = 0;
+  int32_t current_rms_y = 0;
+  int32_t current_rms_z = 0;
+  
+  // Shape and data quality of the current window (see BufferStats)
+  int32_t current_p2p_x = 0;
+  int32_t current_p2p_y = 0;
+  int32_t current_p2p_z = 0;
+  int32_t current_crest_x = 0;     // Q.16 ratios from here to the kurtosis
+  int32_t current_crest_y = 0;
+  int32_t current_crest_z = 0;
+  int32_t current_skew_x = 0;
+  int32_t current_skew_y = 0;
+  int32_t current_skew_z = 0;
+  int32_t current_kurt_x = 0;
+  int32_t current_kurt_y = 0;
+  int32_t current_kurt_z = 0;
+  int32_t current_vector_rms = 0;
+  uint16_t current_clipped_x = 0;
+  uint16_t current_clipped_y = 0;
+  uint16_t current_clipped_z = 0;
+  unsigned long clipped_total = 0;  // Clipped axis-samples since startup
   
   // Running statistics (accumulated over time)
-  float running_avg_x = 0.0;
-  float running_avg_y = 0.0;
-  float running_avg_z = 0.0;
-  float running_std_x = 0.0;
-  float running_std_y = 0.0;
-  float running_std_z = 0.0;
-  float running_rms_x = 0.0;
-  float running_rms_y = 0.0;
-  float running_rms_z = 0.0;
-  float global_max_x = 0.0;
-  float global_max_y = 0.0;
-  float global_max_z = 0.0;
-  float global_min_x = 0.0;
-  float global_min_y = 0.0;
-  float global_min_z = 0.0;
+  int32_t running_avg_x = 0;
+  int32_t running_avg_y = 0;
+  int32_t running_avg_z = 0;
+  int32_t running_std_x = 0;
+  int32_t running_std_y = 0;
+  int32_t running_std_z = 0;
+  int32_t running_rms_x = 0;
+  int32_t running_rms_y = 0;
+  int32_t running_rms_z = 0;
+  int32_t global_max_x = 0;
+  int32_t global_max_y = 0;
+  int32_t global_max_z = 0;
+  int32_t global_min_x = 0;
+  int32_t global_min_y = 0;
+  int32_t global_min_z = 0;
   
   // Metadata
+  int32_t counts_per_g = (int32_t)ADXL355_SCALE_2G;  // Scale of every value above
   unsigned long window_count = 0;
   unsigned long last_update_time = 0;
   bool data_valid = false;
@@ -51,6 +77,8 @@ private:
   AnalyticsData analytics_data;
   bool initialized;
   
+  void rescale(int32_t counts_per_g);
+  
 public:
   Analytics();
   
@@ -71,7 +99,13 @@ public:
   unsigned long getWindowCount() const { return analytics_data.window_count; }
 };
 
-// Global analytics instance
-extern Analytics analytics;
+// Q.8 counts to g, for logging only
+static inline float countsToG(int32_t value, int32_t counts_per_g) {
+  return (float)value / ((float)counts_per_g * (1 << STATS_FRAC_BITS));
+}
+
+// Per-channel analytics instances; 'analytics' is channel 0
+extern Analytics analyticsChannels[NUM_ACCEL_CHANNELS];
+extern Analytics& analytics;
 
 #endif // ANALYTICS_H
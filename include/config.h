@@ -15,21 +15,183 @@
 #define MISO_PIN 19
 #define SCLK_PIN 18
 #define POWER_EN 15  // GPIO connected to ADXL355 VDD
+#define DRDY_PIN 26  // ADXL355 DRDY output (MPU6050 INT when that sensor is used)
+#define INT1_PIN 25  // ADXL355 INT1 output
+
+// Multi-channel acquisition: up to 4 ADXL355s share the SPI bus, one CS each.
+// Channel 0 paces sampling (its DRDY/INT1 is the one wired); all channels are
+// read back-to-back in the same pass.
+#define MAX_ACCEL_CHANNELS  4
+#define NUM_ACCEL_CHANNELS  1
+#define ADXL355_CS_PINS     { CS_PIN, 27, 32, 33 }  // CS for channels 0..3
+
+#if NUM_ACCEL_CHANNELS < 1 || NUM_ACCEL_CHANNELS > MAX_ACCEL_CHANNELS
+  #error "NUM_ACCEL_CHANNELS must be between 1 and MAX_ACCEL_CHANNELS"
+#endif
 
 // ADXL355 Register addresses
 #define DEVID_AD      0x00
 #define DEVID_MST     0x01
 #define PARTID        0x02
 #define STATUS        0x04
+#define FIFO_ENTRIES  0x05
 #define XDATA3        0x08
+#define FIFO_DATA     0x11
+#define FILTER        0x28
+#define FIFO_SAMPLES  0x29
+#define INT_MAP       0x2A
+#define RANGE         0x2C
 #define POWER_CTL     0x2D
 
+// POWER_CTL register bits
+#define POWER_CTL_STANDBY   0x01
+#define POWER_CTL_TEMP_OFF  0x02
+#define POWER_CTL_DRDY_OFF  0x04
+
+// INT_MAP register bits (INT1 routing)
+#define INT_MAP_RDY_EN1   0x01
+#define INT_MAP_FULL_EN1  0x02
+#define INT_MAP_OVR_EN1   0x04
+
+// RANGE register bits
+#define RANGE_INT_POL     0x40  // 1 = INT1/INT2 active high
+#define RANGE_MASK        0x03  // 01 = ±2g, 10 = ±4g, 11 = ±8g
+
+// FILTER register fields
+#define FILTER_ODR_MASK   0x0F  // ODR_LPF code: 0 = 4000 Hz ... 10 = 3.906 Hz
+#define FILTER_HPF_SHIFT  4     // HPF_CORNER code: 0 = off, 1..6 = ODR-relative corners
+#define FILTER_HPF_MASK   0x70
+#define ADXL355_MAX_HPF_CORNER  6
+
+// Scale factor at ±2g (LSB/g); halves with each range step
+#define ADXL355_SCALE_2G  256000.0f
+
+// STATUS register bits
+#define STATUS_DATA_RDY   0x01
+#define STATUS_FIFO_FULL  0x02
+#define STATUS_FIFO_OVR   0x04
+
+// FIFO_DATA entry markers (bits of the last byte of each 3-byte entry)
+#define FIFO_X_MARKER     0x01  // Entry holds X-axis data (start of a sample)
+#define FIFO_EMPTY_MARKER 0x02  // Entry was read from an empty FIFO
+
+// FIFO geometry: 96 entries, one per axis, so 32 complete XYZ samples
+#define ADXL355_FIFO_DEPTH        96
+#define ADXL355_FIFO_MAX_SAMPLES  (ADXL355_FIFO_DEPTH / 3)
+#define ACCEL_MAX_BURST_SAMPLES   ADXL355_FIFO_MAX_SAMPLES  // Per-drain batch size for either sensor
+
+// MPU6050 Register addresses
+#define MPU6050_SMPLRT_DIV    0x19
+#define MPU6050_CONFIG        0x1A
+#define MPU6050_ACCEL_CONFIG  0x1C
+#define MPU6050_FIFO_EN       0x23
+#define MPU6050_INT_PIN_CFG   0x37
+#define MPU6050_INT_ENABLE    0x38
+#define MPU6050_INT_STATUS    0x3A
+#define MPU6050_ACCEL_XOUT_H  0x3B
+#define MPU6050_USER_CTRL     0x6A
+#define MPU6050_PWR_MGMT_1    0x6B
+#define MPU6050_PWR_MGMT_2    0x6C
+#define MPU6050_FIFO_COUNTH   0x72
+#define MPU6050_FIFO_R_W      0x74
+#define MPU6050_WHO_AM_I      0x75
+
+// MPU6050 register bits
+#define MPU6050_FIFO_EN_ACCEL      0x08  // FIFO_EN: accelerometer XYZ into FIFO
+#define MPU6050_INT_DATA_RDY       0x01  // INT_ENABLE / INT_STATUS
+#define MPU6050_INT_FIFO_OFLOW     0x10  // INT_ENABLE / INT_STATUS
+#define MPU6050_USER_FIFO_ENABLE   0x40
+#define MPU6050_USER_FIFO_RESET    0x04
+#define MPU6050_PWR_DEVICE_RESET   0x80
+#define MPU6050_PWR_SLEEP          0x40
+#define MPU6050_PWR_CLK_INTERNAL   0x00  // 8 MHz oscillator (gyro is in standby)
+#define MPU6050_PWR2_GYRO_STANDBY  0x07  // STBY_XG | STBY_YG | STBY_ZG
+#define MPU6050_DLPF_MASK          0x07
+#define MPU6050_DEFAULT_DLPF       4     // 21 Hz accel bandwidth, 1 kHz internal rate
+
+// MPU6050 FIFO geometry: 1024 bytes, 6 bytes per accel-only sample
+#define MPU6050_FIFO_SIZE          1024
+#define MPU6050_FIFO_SAMPLE_BYTES  6
+
 // Expected device IDs
 #define EXPECTED_DEVID_AD   0xAD
 #define EXPECTED_PARTID     0xED
+#define EXPECTED_MPU6050_ID 0x68
 
 // Communication settings
 #define SPI_MODE          0
-#define SPI_FREQUENCY     1000000  // 1 MHz
+#define SPI_FREQUENCY     1000000  // 1 MHz (Arduino SPI transport)
+
+// MPU6050 I2C settings
+#define MPU6050_SDA_PIN        21
+#define MPU6050_SCL_PIN        22
+#define MPU6050_I2C_ADDRESS    0x68
+#define MPU6050_I2C_FREQUENCY  400000   // 400 kHz fast mode
+#define MPU6050_I2C_CHUNK      120      // Max bytes per read (Wire buffer is 128), multiple of 6
+
+// SPI transport selection for the ADXL355
+#define SPI_TRANSPORT_ARDUINO  0   // Arduino SPI, byte transfers, GPIO chip select
+#define SPI_TRANSPORT_IDF_DMA  1   // ESP-IDF spi_device, hardware chip select, DMA bursts
+#define ADXL355_SPI_TRANSPORT  SPI_TRANSPORT_IDF_DMA
+#define ADXL355_SPI_HOST       SPI3_HOST  // VSPI on SCLK/MISO/MOSI 18/19/23
+#define SPI_DMA_FREQUENCY      10000000   // 10 MHz (ADXL355 maximum)
+
+// Default measurement configuration (overridable at runtime via Modbus)
+#define DEFAULT_ACCEL_RANGE_G      2
+#define DEFAULT_HPF_CORNER         0     // High-pass filter disabled
+#define DEFAULT_SENSOR_LPF         MPU6050_DEFAULT_DLPF  // Sensor low-pass code (MPU6050 only)
+#define DEFAULT_WINDOW_LENGTH_MS   1000
+#define DEFAULT_HOP_LENGTH_MS      0     // 0 = hop equals window (tumbling windows)
+
+// Acquisition mode selection
+#define ACQ_MODE_POLLING  0   // One sensor read per 1 ms scheduler tick
+#define ACQ_MODE_FIFO     1   // Sensor buffers samples in its FIFO, drained in bursts
+#define ACQ_MODE_DRDY     2   // Sensor data-ready interrupt wakes the sampling task per sample
+#define ACQUISITION_MODE  ACQ_MODE_POLLING
+
+// FIFO mode settings - drain well before the 32-sample FIFO fills (8 ms at 4 kHz ODR)
+#define FIFO_DRAIN_INTERVAL_MS  4
+#define FIFO_WATERMARK_SAMPLES  24   // FIFO_FULL flag threshold, in XYZ samples
+
+// DRDY mode settings
+#define DRDY_USE_INT1     false  // true: route DATA_RDY to INT1_PIN instead of the DRDY pin
+#define DRDY_TIMEOUT_MS   10     // Recover with a forced read if no edge arrives in time
+
+// Event capture settings
+#define EVENT_TRIGGER_PIN         14     // Rising edge freezes an event (external trigger input)
+#define EVENT_MAX_EVENTS          8      // Event slots in PSRAM (1 in internal RAM without PSRAM)
+#define EVENT_MAX_SAMPLES         4000   // Pre + post samples per channel and event
+#define DEFAULT_EVENT_PRE_MS      500
+#define DEFAULT_EVENT_POST_MS     500
+#define DEFAULT_EVENT_THRESHOLD_MG 0     // Per-axis deviation from the running mean, 0 = threshold trigger off
+
+// Sample filter defaults, per axis (see filter_chain.h)
+#define DEFAULT_FILTER_MODE         0      // Bitmask: 1 DC block, 2 high-pass, 4 low-pass, 8 band-pass
+#define DEFAULT_FILTER_HIGHPASS_HZ  10
+#define DEFAULT_FILTER_LOWPASS_HZ   250
+#define DEFAULT_FILTER_BANDPASS_HZ  100
+
+// Oversampling and decimation (see decimator.h). The sensor runs up to
+// 2^OVERSAMPLE_STAGES times the requested rate and is decimated back to it;
+// the trend stream is the acquisition rate divided by 2^TREND_DECIMATION_STAGES.
+#define OVERSAMPLE_STAGES         2      // x4: 1 kHz requested -> 4 kHz ODR
+#define OVERSAMPLE_MAX_RATE_HZ    4000   // ADXL355 top ODR
+#define MPU6050_MAX_RATE_HZ       1000   // Accelerometer output limit with the DLPF on
+#define TREND_DECIMATION_STAGES   2      // x4: 1 kHz -> 250 Hz
+#define TREND_HISTORY_SECONDS     600    // Trend history per channel at the default rate
+#define TREND_INTERNAL_SECONDS    32     // Trend history per channel without PSRAM (32 KB at 250 Hz)
+
+// Velocity severity defaults (see velocity.h)
+#define DEFAULT_ISO_MACHINE_CLASS     1    // ISO 10816-1 class II (15-75 kW)
+#define DEFAULT_VELOCITY_HIGHPASS_HZ  10   // Lower band edge; 2 for slow machines
+
+// Envelope demodulation band (see envelope.h); must sit below 0.45x the
+// acquisition rate and should bracket a structural resonance
+#define DEFAULT_ENVELOPE_BAND_LOW_HZ   200
+#define DEFAULT_ENVELOPE_BAND_HIGH_HZ  400
+
+// Tracked tones (see goertzel.h), Hz x 10, 0 = off: 1x and 2x of a
+// 4-pole motor on 50 Hz mains
+#define DEFAULT_TONE_FREQS_DHZ  { 250, 500, 0, 0 }
 
 #endif // CONFIG_H
@@ -2,70 +2,476 @@
 #define DATA_BUFFER_H
 
 #include <Arduino.h>
+#include "config.h"
+#include "fixed_point.h"
 
 // Buffer configuration
-#define SAMPLE_RATE_HZ 1000
-#define BUFFER_SIZE 1000  // 1 second worth of samples
+#define SAMPLE_RATE_HZ 1000  // Default rate; the active rate is set at runtime
+#define BUFFER_SIZE 1000  // Capacity: 1 second worth of samples at the default rate
 #define SAMPLING_INTERVAL_US (1000000 / SAMPLE_RATE_HZ)  // 1000 microseconds
+#define BUFFER_STORE_JITTER false  // Keep per-sample timing deviations (+2 bytes/sample)
+#define ACCEL_SAMPLE_BITS 20  // Widest raw sample (ADXL355); bounds the accumulator range
 
-// Sample data structure
-struct AccelSample {
-  int32_t x;
-  int32_t y;
-  int32_t z;
-  unsigned long timestamp_us;
-};
+#define STATS_FRAC_BITS 8  // Fractional bits of the fixed-point window statistics
+#define MOMENT_MAX_SAMPLES 2048  // Longest window whose moment sums convert to double exactly
+#define SHAPE_FRAC_BITS 16  // Fractional bits of the dimensionless shape statistics
+
+// Clip flags carried with each sample, one bit per axis
+#define CLIP_X 0x01
+#define CLIP_Y 0x02
+#define CLIP_Z 0x04
 
-// Buffer statistics
+// Buffer statistics, in raw sensor counts as signed Q.8 fixed point
+// (value / 2^STATS_FRAC_BITS counts). Units are converted to g only where
+// they leave the device, using counts_per_g. Shape statistics are plain
+// ratios in SHAPE_FRAC_BITS fixed point.
 struct BufferStats {
-  float avg_x;
-  float avg_y;
-  float avg_z;
-  float max_x;
-  float max_y;
-  float max_z;
-  float min_x;
-  float min_y;
-  float min_z;
-  float rms_x;
-  float rms_y;
-  float rms_z;
+  int32_t avg_x;
+  int32_t avg_y;
+  int32_t avg_z;
+  int32_t max_x;
+  int32_t max_y;
+  int32_t max_z;
+  int32_t min_x;
+  int32_t min_y;
+  int32_t min_z;
+  int32_t rms_x;
+  int32_t rms_y;
+  int32_t rms_z;
+  int32_t std_x;
+  int32_t std_y;
+  int32_t std_z;
+  int32_t p2p_x;         // Peak-to-peak
+  int32_t p2p_y;
+  int32_t p2p_z;
+  int32_t crest_x;       // Largest |v - mean| over std (Q.16)
+  int32_t crest_y;
+  int32_t crest_z;
+  int32_t skew_x;        // Skewness (Q.16)
+  int32_t skew_y;
+  int32_t skew_z;
+  int32_t kurt_x;        // Kurtosis, 3.0 for Gaussian noise (Q.16)
+  int32_t kurt_y;
+  int32_t kurt_z;
+  int32_t vector_rms;    // RMS of the vector magnitude with each axis' mean removed
+  uint16_t clipped_x;    // Samples taken with the sensor at its output limit
+  uint16_t clipped_y;
+  uint16_t clipped_z;
   uint16_t sample_count;
   unsigned long duration_us;
+  int32_t counts_per_g;  // Scale of the raw values in this window
+  uint8_t channel;       // Acquisition channel the window came from
+};
+
+void printBufferStats(const BufferStats& stats);
+
+// Exact sums of d^3 and d^4 for |d| < 2^21, kept in 64-bit pieces. With
+// p = d^2 = ph * 2^21 + pl:
+//   d^3 = d * ph * 2^21 + d * pl
+//   d^4 = ph^2 * 2^42 + ph * pl * 2^22 + pl^2
+// Every product is 32 x 32 bits and below 2^42, so over n samples a piece
+// stays below n * 2^42. The sums are exact in 64 bits for any window, and
+// samples can be removed again exactly; shape() converts them to double,
+// which is exact only up to 2^53, so windows are limited to
+// MOMENT_MAX_SAMPLES (2^11).
+struct MomentSums {
+  long long cube_hi;
+  long long cube_lo;
+  long long quad_hh;
+  long long quad_hl;
+  long long quad_ll;
+  
+  inline void clear() {
+    cube_hi = cube_lo = quad_hh = quad_hl = quad_ll = 0;
+  }
+  
+  inline void add(int32_t d) {
+    uint64_t p = (uint64_t)((long long)d * d);
+    int32_t ph = (int32_t)(p >> 21);
+    int32_t pl = (int32_t)(p & 0x1FFFFF);
+    cube_hi += (long long)d * ph;
+    cube_lo += (long long)d * pl;
+    quad_hh += (long long)ph * ph;
+    quad_hl += (long long)ph * pl;
+    quad_ll += (long long)pl * pl;
+  }
+  
+  inline void remove(int32_t d) {
+    uint64_t p = (uint64_t)((long long)d * d);
+    int32_t ph = (int32_t)(p >> 21);
+    int32_t pl = (int32_t)(p & 0x1FFFFF);
+    cube_hi -= (long long)d * ph;
+    cube_lo -= (long long)d * pl;
+    quad_hh -= (long long)ph * ph;
+    quad_hl -= (long long)ph * pl;
+    quad_ll -= (long long)pl * pl;
+  }
+  
+  // Skewness and kurtosis (SHAPE_FRAC_BITS) of n samples whose deviations
+  // from a common origin sum to 'sum' and 'sum_sq'; 0 for a flat window
+  void shape(uint16_t n, long long sum, long long sum_sq, int32_t& skew, int32_t& kurt) const;
+};
+
+// Largest excursion from the mean over the standard deviation
+// (SHAPE_FRAC_BITS); inputs in STATS_FRAC_BITS
+static inline int32_t crestFactor(int32_t min, int32_t max, int32_t mean, int32_t std) {
+  if (std <= 0) {
+    return 0;
+  }
+  int64_t peak = (int64_t)max - mean;
+  if ((int64_t)mean - min > peak) peak = (int64_t)mean - min;
+  uint64_t crest = fixedDiv((uint64_t)peak, (uint64_t)std, SHAPE_FRAC_BITS);
+  return crest > INT32_MAX ? INT32_MAX : (int32_t)crest;
+}
+
+// Streaming statistics of one axis, updated as each sample is stored so
+// closing a window is O(1). Values are centered on the window's first
+// sample: the integer sums stay small even with 1 g of gravity on an axis,
+// and the variance numerator n*S2 - S1^2 is formed exactly in integers
+// before the single division, so it cannot cancel the way rms^2 - avg^2 does.
+// This replaces the close-time stats scan with a compile-time trip count:
+// spreading the work over the samples beats unrolling a scan of all of them.
+struct AxisAccumulator {
+  int32_t origin;
+  int32_t min;
+  int32_t max;
+  long long sum;     // Sum of (v - origin)
+  long long sum_sq;  // Sum of (v - origin)^2
+  MomentSums higher; // Sums of (v - origin)^3 and (v - origin)^4
+  uint16_t clipped;
+  
+  inline void start(int32_t v, bool clip) {
+    origin = min = max = v;
+    sum = 0;
+    sum_sq = 0;
+    higher.clear();
+    clipped = clip ? 1 : 0;
+  }
+  
+  inline void add(int32_t v, bool clip) {
+    int32_t d = v - origin;
+    sum += d;
+    sum_sq += (long long)d * d;
+    higher.add(d);
+    if (v < min) min = v;
+    if (v > max) max = v;
+    if (clip) clipped++;
+  }
+  
+  // Results in STATS_FRAC_BITS fixed point, rounded
+  int32_t mean(uint16_t n) const {
+    return origin * (1 << STATS_FRAC_BITS) + (int32_t)divRound(sum * (1 << STATS_FRAC_BITS), n);
+  }
+  
+  int64_t variance(uint16_t n) const {  // 2 * STATS_FRAC_BITS fractional bits
+    long long m2n = (long long)n * sum_sq - sum * sum;  // n^2 * variance, exact
+    return m2n > 0 ? (int64_t)fixedDiv(m2n, (uint64_t)n * n, 2 * STATS_FRAC_BITS) : 0;
+  }
+  
+  int32_t std(uint16_t n) const {
+    return isqrt64(variance(n));
+  }
+  
+  int32_t rms(uint16_t n) const {
+    // Mean square of the raw values from the exact sums, as SlidingWindow does
+    long long raw_sq = sum_sq + 2 * (long long)origin * sum + (long long)n * origin * origin;
+    return isqrt64(fixedDiv(raw_sq, n, 2 * STATS_FRAC_BITS));
+  }
+  
+  void shape(uint16_t n, int32_t& skew, int32_t& kurt) const {
+    higher.shape(n, sum, sum_sq, skew, kurt);
+  }
+};
+
+// One window in structure-of-arrays layout. Each axis is contiguous so the
+// samples of one axis can be streamed straight into later stages. Timestamps are
+// not stored per sample: sample i was taken at start_us + i * interval, plus
+// jitter_us[i] when jitter storage is enabled and the window had any.
+template <uint16_t Capacity, typename SampleT>
+struct WindowStorage {
+  SampleT x[Capacity];
+  SampleT y[Capacity];
+  SampleT z[Capacity];
+#if BUFFER_STORE_JITTER
+  int16_t jitter_us[Capacity];  // Deviation from the nominal sample time
+#endif
+  AxisAccumulator acc[3];       // Running x/y/z statistics of this window
+  unsigned long start_us;       // Timestamp of the first sample
+  unsigned long end_us;         // Timestamp of the last sample
+  bool has_jitter;              // Any non-zero entry in jitter_us
 };
 
+// Windowed sample buffer holding one window. Statistics accumulate as the
+// samples arrive, so closing a window is O(1): the processing task, which
+// also fills the buffer, closes each window as soon as it completes and the
+// next sample starts a new one, with nothing lost at the boundary. Samples
+// offered while a completed window is still open are refused and counted.
+//
+// Storage is part of the object, sized at compile time by Capacity (samples
+// per window) and SampleT (raw axis type: int32_t for 20-bit sensors,
+// int16_t is enough for the MPU6050). Nothing is allocated at runtime; the
+// object goes wherever it is defined - static, internal, or DMA-capable
+// memory via DMA_ATTR or placement new into heap_caps_malloc'd storage.
+template <uint16_t Capacity, typename SampleT>
 class DataBuffer {
+  // n * sum((v - origin)^2) must fit in 63 bits with |v - origin| < 2^(bits + 1)
+  static_assert((unsigned long long)Capacity * Capacity <=
+                (1ULL << (63 - 2 * ((sizeof(SampleT) * 8 < ACCEL_SAMPLE_BITS ?
+                                     sizeof(SampleT) * 8 : ACCEL_SAMPLE_BITS) + 1))),
+                "DataBuffer capacity too large for exact variance accumulation");
+  static_assert(Capacity <= MOMENT_MAX_SAMPLES, "DataBuffer capacity too large for exact moment sums");
+  
 private:
-  AccelSample* buffer;
-  uint16_t write_index;
+  typedef WindowStorage<Capacity, SampleT> Window;
+  
+  Window window;
   uint16_t sample_count;
-  bool buffer_full;
+  bool window_ready;                   // Complete and waiting for calculateStats/releaseWindow
+  unsigned long window_overruns;       // Samples dropped because the window was not closed
   unsigned long last_sample_time;
   unsigned long buffer_start_time;
+  uint16_t window_length;
+  uint16_t sample_rate_hz;
+  unsigned long sampling_interval_us;
+  int32_t counts_per_g;
+  
+  const Window* readyWindow() const { return window_ready ? &window : nullptr; }
   
 public:
-  DataBuffer();
-  ~DataBuffer();
+  DataBuffer() : sample_count(0), window_ready(false),
+                 window_overruns(0), last_sample_time(0), buffer_start_time(0),
+                 window_length(Capacity), sample_rate_hz(SAMPLE_RATE_HZ),
+                 sampling_interval_us(SAMPLING_INTERVAL_US), counts_per_g((int32_t)ADXL355_SCALE_2G) {
+    window.start_us = 0;
+    window.end_us = 0;
+    window.has_jitter = false;
+  }
   
   // Buffer management
-  bool begin();
-  void reset();
+  bool begin() {
+    reset();
+    Serial.print("Data buffer initialized: ");
+    Serial.print(window_length);
+    Serial.print(" samples @ ");
+    Serial.print(sample_rate_hz);
+    Serial.print(" Hz, ");
+    Serial.print((unsigned long)sizeof(window));
+    Serial.println(" bytes");
+    
+    return true;
+  }
+  
+  void reset() {
+    // Any waiting window is dropped
+    sample_count = 0;
+    window_ready = false;
+    last_sample_time = 0;
+    buffer_start_time = micros();
+  }
+  
+  void configure(uint16_t window_samples, uint16_t sample_rate, int32_t scale_factor) {
+    if (window_samples == 0) window_samples = 1;
+    if (window_samples > Capacity) window_samples = Capacity;
+    if (sample_rate == 0) sample_rate = SAMPLE_RATE_HZ;
+    
+    window_length = window_samples;
+    sample_rate_hz = sample_rate;
+    sampling_interval_us = 1000000UL / sample_rate;
+    counts_per_g = scale_factor;
+    
+    // Samples taken under the old configuration are discarded
+    reset();
+    
+    #if ENABLE_DEBUG_OUTPUT
+    Serial.printf("[BUFFER] Window: %d samples @ %d Hz, scale %ld LSB/g\n", 
+                  window_length, sample_rate_hz, (long)counts_per_g);
+    #endif
+  }
   
   // Data collection
-  bool addSample(int32_t x, int32_t y, int32_t z);
-  bool shouldSample();
+  bool addSample(int32_t x, int32_t y, int32_t z) {
+    return addSample(x, y, z, micros());
+  }
+  
+  // 'clipped' is a mask of CLIP_X/CLIP_Y/CLIP_Z for the axes that hit the
+  // sensor's output limit
+  bool addSample(int32_t x, int32_t y, int32_t z, unsigned long timestamp_us, uint8_t clipped = 0) {
+    if (window_ready) {
+      // The completed window has not been closed yet
+      window_overruns++;
+      return false;
+    }
+    
+    unsigned long current_time = timestamp_us;
+    uint16_t index = sample_count;
+    
+    // Store sample
+    window.x[index] = (SampleT)x;
+    window.y[index] = (SampleT)y;
+    window.z[index] = (SampleT)z;
+    if (index == 0) {
+      window.start_us = current_time;
+      window.has_jitter = false;
+      window.acc[0].start(x, clipped & CLIP_X);
+      window.acc[1].start(y, clipped & CLIP_Y);
+      window.acc[2].start(z, clipped & CLIP_Z);
+    } else {
+      window.acc[0].add(x, clipped & CLIP_X);
+      window.acc[1].add(y, clipped & CLIP_Y);
+      window.acc[2].add(z, clipped & CLIP_Z);
+    }
+    window.end_us = current_time;
+    
+    #if BUFFER_STORE_JITTER
+    // Deviation from the nominal grid, saturated to the int16 range
+    long deviation = (long)(current_time - window.start_us) - (long)index * (long)sampling_interval_us;
+    if (deviation > INT16_MAX) deviation = INT16_MAX;
+    if (deviation < INT16_MIN) deviation = INT16_MIN;
+    window.jitter_us[index] = (int16_t)deviation;
+    if (deviation != 0) window.has_jitter = true;
+    #endif
+    
+    // Update indices
+    sample_count = index + 1;
+    last_sample_time = current_time;
+    
+    // Window complete: hold it until releaseWindow()
+    if (sample_count >= window_length) {
+      window_ready = true;
+    }
+    
+    return true;
+  }
+  
+  bool shouldSample() {
+    unsigned long current_time = micros();
+    
+    // Check if enough time has passed since last sample
+    if (last_sample_time == 0 || (current_time - last_sample_time) >= sampling_interval_us) {
+      return true;
+    }
+    
+    return false;
+  }
   
   // Buffer status
-  bool isFull() const { return buffer_full; }
-  uint16_t getSampleCount() const { return sample_count; }
-  uint16_t getCapacity() const { return BUFFER_SIZE; }
+  bool isFull() const { return window_ready; }  // Holds a completed, unprocessed window
+  bool hasReadyWindow() const { return window_ready; }
+  uint16_t getSampleCount() const { return window_ready ? 0 : sample_count; }
+  unsigned long getWindowOverruns() const { return window_overruns; }
+  uint16_t getCapacity() const { return Capacity; }
+  uint16_t getWindowLength() const { return window_length; }
+  uint16_t getSampleRate() const { return sample_rate_hz; }
+  unsigned long getSamplingInterval() const { return sampling_interval_us; }
   
-  // Data processing
-  void calculateStats(BufferStats& stats);
-  void printStats(const BufferStats& stats);
+  // Data processing - operates on the completed window, O(1)
+  void calculateStats(BufferStats& stats) {
+    const Window* w = readyWindow();
+    if (!w || sample_count == 0) {
+      memset(&stats, 0, sizeof(stats));
+      return;
+    }
+    
+    // Accumulated while the window filled; nothing to scan
+    const AxisAccumulator& ax = w->acc[0];
+    const AxisAccumulator& ay = w->acc[1];
+    const AxisAccumulator& az = w->acc[2];
+    
+    stats.min_x = ax.min * (1 << STATS_FRAC_BITS);
+    stats.max_x = ax.max * (1 << STATS_FRAC_BITS);
+    stats.min_y = ay.min * (1 << STATS_FRAC_BITS);
+    stats.max_y = ay.max * (1 << STATS_FRAC_BITS);
+    stats.min_z = az.min * (1 << STATS_FRAC_BITS);
+    stats.max_z = az.max * (1 << STATS_FRAC_BITS);
+    
+    stats.avg_x = ax.mean(sample_count);
+    stats.avg_y = ay.mean(sample_count);
+    stats.avg_z = az.mean(sample_count);
+    
+    stats.std_x = ax.std(sample_count);
+    stats.std_y = ay.std(sample_count);
+    stats.std_z = az.std(sample_count);
+    
+    stats.rms_x = ax.rms(sample_count);
+    stats.rms_y = ay.rms(sample_count);
+    stats.rms_z = az.rms(sample_count);
+    
+    // Shape and data-quality statistics from the same accumulators
+    stats.p2p_x = stats.max_x - stats.min_x;
+    stats.p2p_y = stats.max_y - stats.min_y;
+    stats.p2p_z = stats.max_z - stats.min_z;
+    
+    stats.crest_x = crestFactor(stats.min_x, stats.max_x, stats.avg_x, stats.std_x);
+    stats.crest_y = crestFactor(stats.min_y, stats.max_y, stats.avg_y, stats.std_y);
+    stats.crest_z = crestFactor(stats.min_z, stats.max_z, stats.avg_z, stats.std_z);
+    
+    ax.shape(sample_count, stats.skew_x, stats.kurt_x);
+    ay.shape(sample_count, stats.skew_y, stats.kurt_y);
+    az.shape(sample_count, stats.skew_z, stats.kurt_z);
+    
+    stats.vector_rms = isqrt64(ax.variance(sample_count) + ay.variance(sample_count) + az.variance(sample_count));
+    
+    stats.clipped_x = ax.clipped;
+    stats.clipped_y = ay.clipped;
+    stats.clipped_z = az.clipped;
+    
+    #if ENABLE_DEBUG_OUTPUT
+    static unsigned long last_buffer_debug = 0;
+    if (millis() - last_buffer_debug > 5000) {  // Debug every 5 seconds
+      Serial.printf("[BUFFER-CALC] Sample count: %d\n", sample_count);
+      Serial.printf("[BUFFER-CALC] Calculated averages (Q.8 counts): X=%ld, Y=%ld, Z=%ld\n", 
+                    (long)stats.avg_x, (long)stats.avg_y, (long)stats.avg_z);
+      Serial.printf("[BUFFER-CALC] Std (Q.8 counts): X=%ld, Y=%ld, Z=%ld\n", 
+                    (long)stats.std_x, (long)stats.std_y, (long)stats.std_z);
+      Serial.printf("[BUFFER-CALC] Min/Max (counts): X=[%ld,%ld], Y=[%ld,%ld], Z=[%ld,%ld]\n", 
+                    (long)ax.min, (long)ax.max, (long)ay.min, (long)ay.max, (long)az.min, (long)az.max);
+      last_buffer_debug = millis();
+    }
+    #endif
+    
+    // Other stats
+    stats.sample_count = sample_count;
+    stats.counts_per_g = counts_per_g;
+    stats.duration_us = w->end_us - w->start_us;
+  }
   
-  // Access samples
-  const AccelSample* getSamples() const { return buffer; }
+  void releaseWindow() {
+    if (!window_ready) {
+      return;
+    }
+    
+    // The next sample starts a new window
+    window_ready = false;
+    sample_count = 0;
+    buffer_start_time = micros();
+  }
+  
+  void printStats(const BufferStats& stats) { printBufferStats(stats); }
+  
+  // Access samples of the completed window
+  uint16_t getWindowSampleCount() const { return window_ready ? sample_count : 0; }
+  const SampleT* getWindowX() const { return window_ready ? window.x : nullptr; }
+  const SampleT* getWindowY() const { return window_ready ? window.y : nullptr; }
+  const SampleT* getWindowZ() const { return window_ready ? window.z : nullptr; }
+  unsigned long getWindowStartTime() const { return window_ready ? window.start_us : 0; }
+  
+  unsigned long getWindowSampleTime(uint16_t index) const {
+    const Window* w = readyWindow();
+    if (!w) {
+      return 0;
+    }
+    
+    unsigned long t = w->start_us + (unsigned long)index * sampling_interval_us;
+    #if BUFFER_STORE_JITTER
+    if (w->has_jitter) {
+      t += w->jitter_us[index];
+    }
+    #endif
+    return t;
+  }
 };
 
+// Buffer used by the acquisition channels
+typedef DataBuffer<BUFFER_SIZE, int32_t> ChannelBuffer;
+
 #endif // DATA_BUFFER_H
@@ -0,0 +1,113 @@
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "data_buffer.h"
+
+// Decimator configuration
+#define DECIMATOR_TAPS             47    // Half-band FIR length per stage
+#define DECIMATOR_SIDE_TAPS        12    // Non-zero taps on each side of the center
+#define DECIMATOR_COEFF_FRAC_BITS  24    // Coefficients are Q24, unity DC gain
+#define DECIMATOR_MAX_STAGES       2     // x2 per stage: up to x4 per decimator
+#define DECIMATOR_BUDGET_CYCLES    400   // CPU cycles allowed per input channel-sample (3 axes)
+
+#if OVERSAMPLE_STAGES > DECIMATOR_MAX_STAGES || TREND_DECIMATION_STAGES > DECIMATOR_MAX_STAGES
+  #error "Decimation stages exceed DECIMATOR_MAX_STAGES"
+#endif
+
+// Kaiser-windowed (beta 7) half-band low-pass, symmetric, every other tap
+// zero except the center. Flat within 0.01 dB up to 0.2 * fs_in, at least
+// 70 dB down from 0.3 * fs_in and 80 dB from 0.35 * fs_in, so after dropping
+// every other sample aliases into the band up to 0.4 * fs_out are 70 dB down.
+// Taps sum to exactly 2^24.
+#define DECIMATOR_CENTER_TAP  8388580
+static const int32_t decimator_side_taps[DECIMATOR_SIDE_TAPS] = {  // Outermost first
+  -1377, 6552, -17966, 39383, -75719, 133425,
+  -221540, 354625, -561396, 914908, -1684297, 5307720
+};
+
+// One x2 stage for the three axes of a channel. The delay lines are stored
+// twice so the newest DECIMATOR_TAPS samples are always contiguous, and the
+// filter is only evaluated for the samples that are kept.
+struct DecimatorStage {
+  int32_t delay[3][2 * DECIMATOR_TAPS];
+  uint8_t pos;       // Slot of the newest sample
+  bool odd;          // An output is due on the next input
+
+  void clear() {
+    memset(delay, 0, sizeof(delay));
+    pos = 0;
+    odd = false;
+  }
+
+  static inline int32_t output(const int32_t* w) {
+    int64_t acc = (int64_t)DECIMATOR_CENTER_TAP * w[DECIMATOR_TAPS / 2];
+    for (uint8_t j = 0; j < DECIMATOR_SIDE_TAPS; j++) {
+      acc += (int64_t)decimator_side_taps[j] * (w[2 * j] + w[DECIMATOR_TAPS - 1 - 2 * j]);
+    }
+    int32_t y = (int32_t)((acc + (1LL << (DECIMATOR_COEFF_FRAC_BITS - 1))) >> DECIMATOR_COEFF_FRAC_BITS);
+    // Passband ripple can overshoot a full-scale input by a few counts
+    const int32_t limit = (1L << (ACCEL_SAMPLE_BITS - 1)) - 1;
+    if (y > limit) y = limit;
+    if (y < -limit) y = -limit;
+    return y;
+  }
+
+  // Push one sample; true (and the filtered sample in place) every other call
+  inline bool push(int32_t& x, int32_t& y, int32_t& z) {
+    pos = (pos == 0) ? DECIMATOR_TAPS - 1 : pos - 1;
+    delay[0][pos] = delay[0][pos + DECIMATOR_TAPS] = x;
+    delay[1][pos] = delay[1][pos + DECIMATOR_TAPS] = y;
+    delay[2][pos] = delay[2][pos + DECIMATOR_TAPS] = z;
+    odd = !odd;
+    if (odd) {
+      return false;
+    }
+    x = output(&delay[0][pos]);
+    y = output(&delay[1][pos]);
+    z = output(&delay[2][pos]);
+    return true;
+  }
+};
+
+// Integer-ratio decimation by 2^stages with a cascade of half-band FIR
+// stages, per channel. One input stream feeds each instance; an instance is
+// owned by one task:
+//   oversampleDecimator - sampling core, sensor ODR -> acquisition rate
+//   trendDecimator      - processing core, acquisition rate -> trend rate
+class Decimator {
+private:
+  DecimatorStage stages[NUM_ACCEL_CHANNELS][DECIMATOR_MAX_STAGES];
+  uint8_t stage_count;
+
+public:
+  Decimator();
+
+  // Owning task: set the ratio to 2^count and clear the filter state
+  void configure(uint8_t count);
+  void reset();
+
+  bool isActive() const { return stage_count > 0; }
+  uint8_t getStages() const { return stage_count; }
+  uint16_t getFactor() const { return 1 << stage_count; }
+
+  // Group delay in input samples: an output describes the input this many
+  // samples before the one that completed it
+  uint16_t getDelaySamples() const { return (DECIMATOR_TAPS / 2) * ((1 << stage_count) - 1); }
+
+  // Feed one sample of a channel; true when a decimated sample is ready, in place
+  inline bool process(uint8_t channel, int32_t& x, int32_t& y, int32_t& z) {
+    for (uint8_t s = 0; s < stage_count; s++) {
+      if (!stages[channel][s].push(x, y, z)) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+extern Decimator oversampleDecimator;
+extern Decimator trendDecimator;
+
+#endif // DECIMATOR_H
@@ -0,0 +1,121 @@
+#ifndef ENVELOPE_H
+#define ENVELOPE_H
+
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "config.h"
+#include "filter_chain.h"
+#include "decimator.h"
+#include "spectrum.h"
+
+// Envelope configuration
+#define ENVELOPE_FFT_SIZE           512   // Envelope samples per spectrum (~2 s at 250 Hz)
+#define ENVELOPE_DECIMATION_STAGES  2     // x4: 1 kHz acquisition -> 250 Hz envelope
+#define ENVELOPE_NUM_PEAKS          3     // Strongest envelope peaks reported per axis
+#define ENVELOPE_BUDGET_CYCLES      1200  // CPU cycles allowed per channel-sample (3 axes), front end
+
+#if ENVELOPE_DECIMATION_STAGES > DECIMATOR_MAX_STAGES || ENVELOPE_NUM_PEAKS > SPECTRUM_NUM_PEAKS
+  #error "Envelope settings exceed the decimator or peak limits"
+#endif
+
+struct AxisEnvelope {
+  float rms_g;                              // Mean-removed envelope RMS (modulation level)
+  SpectrumPeak peaks[ENVELOPE_NUM_PEAKS];   // Strongest first
+};
+
+struct EnvelopeResult {
+  AxisEnvelope axis[3];
+  uint16_t sample_rate_hz;   // Envelope rate after decimation
+  float resolution_hz;
+  unsigned long compute_us;  // Time for the three axis spectra
+  uint32_t sequence;
+  bool valid;
+};
+
+// Envelope (demodulation) analysis for bearing faults, on the processing
+// task. Per sample, each axis is band-passed around a structural resonance
+// (two high-pass and two low-pass Butterworth sections), full-wave rectified,
+// then low-passed and decimated by the half-band decimator. Once a channel
+// has ENVELOPE_FFT_SIZE envelope samples the block is staged and its spectrum
+// is computed one axis per processing batch, so the work per batch stays
+// bounded: the front end is metered against ENVELOPE_BUDGET_CYCLES and each
+// axis spectrum is one 512-point real FFT.
+class EnvelopeAnalyzer {
+private:
+  static const uint16_t HALF = ENVELOPE_FFT_SIZE / 2;
+
+  AxisFilter bandpass[NUM_ACCEL_CHANNELS][3];
+  Decimator decimator;
+  bool primed[NUM_ACCEL_CHANNELS];
+  bool active;                     // Band usable at this rate
+  uint16_t sample_rate_hz;         // Acquisition rate
+  float counts_per_g;
+
+  // Envelope blocks being filled, and the one being analyzed
+  int32_t fill[NUM_ACCEL_CHANNELS][3][ENVELOPE_FFT_SIZE];
+  uint16_t fill_count[NUM_ACCEL_CHANNELS];
+  int32_t staged[3][ENVELOPE_FFT_SIZE];
+  uint8_t staged_channel;
+  uint8_t staged_axis;             // Next axis to analyze; 3 when idle
+  uint8_t next_channel;            // Round-robin start when several blocks are full
+  EnvelopeResult building;
+  uint32_t dropped;
+
+  // FFT working set
+  float work[ENVELOPE_FFT_SIZE];
+  float power[HALF + 1];
+  float window[ENVELOPE_FFT_SIZE];
+  float tw_cos[HALF];
+  float tw_sin[HALF];
+  float window_sum_sq;
+
+  // Band (Hz), requested by the Modbus task, picked up by the processing task
+  volatile uint16_t requested_low_hz;
+  volatile uint16_t requested_high_hz;
+  volatile bool settings_pending;
+  uint16_t band_low_hz;
+  uint16_t band_high_hz;
+
+  EnvelopeResult results[NUM_ACCEL_CHANNELS];
+  mutable portMUX_TYPE results_lock;
+
+  void applySettings();
+  bool stageNext();
+  void analyzeAxis(uint8_t axis);
+
+public:
+  EnvelopeAnalyzer();
+
+  bool begin();
+
+  // Sampling task, under buffer_mutex: acquisition rate or scale changed
+  void configure(uint16_t sample_rate, int32_t counts_per_g);
+
+  // Any task: demodulation band edges
+  void setBand(uint16_t low_hz, uint16_t high_hz);
+
+  // Processing task, once per batch under buffer_mutex: apply pending settings
+  inline void update() {
+    if (settings_pending) applySettings();
+  }
+
+  // Processing task: one sample of a channel, in counts
+  void processSample(uint8_t channel, int32_t x, int32_t y, int32_t z);
+
+  // Processing task, after each batch: stage a full block if idle, then
+  // analyze one axis of it
+  void service();
+
+  bool isActive() const { return active; }
+  uint16_t getEnvelopeRate() const { return sample_rate_hz >> ENVELOPE_DECIMATION_STAGES; }
+
+  // Any task: copy of the latest result for a channel
+  bool getResult(uint8_t channel, EnvelopeResult& out) const;
+  uint32_t getDropped() const { return dropped; }  // Envelope samples lost while a full block waited
+
+  void printInfo() const;
+};
+
+extern EnvelopeAnalyzer envelopeAnalyzer;
+
+#endif // ENVELOPE_H
@@ -0,0 +1,127 @@
+#ifndef EVENT_CAPTURE_H
+#define EVENT_CAPTURE_H
+
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "config.h"
+#include "packed_history.h"
+
+#define EVENT_BASELINE_SHIFT  10   // Running mean time constant: 2^10 samples (~1 s at 1 kHz)
+#define EVENT_BASELINE_FRAC   8    // Fractional bits of the running mean
+#define EVENT_NO_SLOT         0xFF
+
+// What froze an event
+enum EventSource : uint8_t {
+  EVENT_SOURCE_NONE = 0,
+  EVENT_SOURCE_THRESHOLD = 1,
+  EVENT_SOURCE_MODBUS = 2,
+  EVENT_SOURCE_GPIO = 3
+};
+
+// One frozen event: pre + post samples for every channel, packed as in
+// PackedHistory. Channel c's samples start at samples + c * sample_count.
+struct EventRecord {
+  uint32_t id;                   // Increments per captured event, 0 = slot empty
+  uint8_t source;                // EventSource
+  uint8_t trigger_channel;
+  uint16_t pre_samples;          // Samples before the trigger sample
+  uint16_t sample_count;         // Per channel, trigger sample included
+  uint16_t sample_rate_hz;
+  float counts_per_g;
+  unsigned long trigger_time_us;
+  unsigned long captured_ms;     // millis() when the post-trigger part completed
+  uint64_t* samples;
+};
+
+// Pre/post-trigger capture on top of the per-channel sample history.
+//
+// The rolling pre-trigger history is the PackedHistory the processing task
+// already writes, so nothing extra runs per sample except the threshold
+// compare. Both see the samples from before the sample filter, so a capture
+// holds what the sensor produced whatever filter the statistics use. The
+// threshold applies to each axis's deviation from its running mean, so
+// gravity and sensor offset do not count towards it. On a trigger the
+// capture counts post-trigger samples, then copies pre + post packed words
+// out of the history into an event slot. All of it runs on the processing
+// task; the sampling core is never involved.
+class EventCapture {
+private:
+  EventRecord events[EVENT_MAX_EVENTS];
+  uint8_t slot_count;            // Slots that got memory
+  uint8_t next_slot;             // Oldest slot, overwritten next
+  uint8_t stored_count;
+  uint32_t total_count;
+  uint32_t dropped_count;        // Captures lost because their slot was being read out
+  bool in_psram;
+
+  // A slot being dumped is pinned; a capture that would overwrite it is
+  // dropped instead. Slot choice and pinning happen under slot_lock.
+  mutable uint8_t pinned_slot;
+  mutable portMUX_TYPE slot_lock;
+
+  // Active settings, owned by the processing task
+  uint16_t pre_samples;
+  uint16_t post_samples;
+  int32_t threshold_counts;      // 0 = off
+  int32_t baseline[NUM_ACCEL_CHANNELS][3];  // Running mean per axis, counts << EVENT_BASELINE_FRAC
+  bool baseline_primed[NUM_ACCEL_CHANNELS];
+  uint16_t sample_rate_hz;
+  float counts_per_g;
+
+  // Requested settings (Modbus task), picked up between captures
+  volatile uint16_t requested_pre_ms;
+  volatile uint16_t requested_post_ms;
+  volatile uint16_t requested_threshold_mg;
+  volatile bool settings_pending;
+
+  // Trigger state
+  volatile uint8_t pending_source;   // Set from the Modbus task or the GPIO ISR
+  bool collecting;
+  uint16_t post_remaining;
+  uint8_t trigger_source;
+  uint8_t trigger_channel;
+  unsigned long trigger_time_us;
+
+  void applySettings();
+  void startCapture(uint8_t source, uint8_t channel, unsigned long timestamp_us);
+  void finishCapture(const PackedHistory* histories);
+  uint8_t slotOf(uint8_t index) const;
+  static uint32_t unpackRecord(const EventRecord& event, uint8_t channel, uint32_t offset, uint32_t n,
+                               int32_t* x, int32_t* y, int32_t* z);
+
+public:
+  EventCapture();
+  ~EventCapture();
+
+  bool begin();
+
+  // Any task: new pre/post length and threshold, applied when no capture is running
+  void configure(uint16_t pre_ms, uint16_t post_ms, uint16_t threshold_mg);
+
+  // Under buffer_mutex (acquisition reconfiguration): rate or scale changed
+  void setTiming(uint16_t sample_rate, float scale_factor);
+
+  // Any task or ISR: freeze an event at the next sample
+  void requestTrigger(uint8_t source) {
+    if (pending_source == EVENT_SOURCE_NONE) pending_source = source;
+  }
+
+  // Processing task: call after the sample was added to histories[channel]
+  void processSample(uint8_t channel, int32_t x, int32_t y, int32_t z, unsigned long timestamp_us,
+                     const PackedHistory* histories);
+
+  // Retrieval; index 0 is the newest stored event
+  uint8_t getStoredCount() const { return stored_count; }
+  uint32_t getTotalCount() const { return total_count; }
+  uint32_t getDroppedCount() const { return dropped_count; }
+  bool isCollecting() const { return collecting; }
+  const EventRecord* getEvent(uint8_t index) const;
+  uint32_t readEvent(uint8_t index, uint8_t channel, uint32_t offset, uint32_t n,
+                     int32_t* x, int32_t* y, int32_t* z) const;
+  void printEvent(uint8_t index) const;
+  void printInfo() const;
+};
+
+extern EventCapture eventCapture;
+
+#endif // EVENT_CAPTURE_H
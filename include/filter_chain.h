@@ -0,0 +1,135 @@
+#ifndef FILTER_CHAIN_H
+#define FILTER_CHAIN_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "data_buffer.h"
+
+// Filter chain configuration
+#define FILTER_COEFF_FRAC_BITS   28    // Biquad coefficients are Q3.28
+#define FILTER_MAX_SECTIONS      4     // One section per filter type
+#define FILTER_DC_BLOCK_HZ       0.5f  // DC-blocker corner
+#define FILTER_BANDPASS_Q        1.0f  // Band-pass quality factor (~1.4 octaves wide)
+#define FILTER_BUDGET_CYCLES     600   // CPU cycles allowed per channel-sample (3 axes)
+
+// Section types; a per-axis mode is a bitmask of (1 << type), applied in this order
+enum FilterType : uint8_t {
+  FILTER_DC_BLOCK = 0,
+  FILTER_HIGHPASS = 1,   // 2nd-order Butterworth
+  FILTER_LOWPASS = 2,    // 2nd-order Butterworth
+  FILTER_BANDPASS = 3    // 2nd-order, 0 dB at the center frequency
+};
+
+// Normalized (a0 = 1) biquad coefficients, Q3.28
+struct BiquadCoeffs {
+  int32_t b0, b1, b2;
+  int32_t a1, a2;
+};
+
+// Requested filtering for one axis
+struct AxisFilterConfig {
+  uint8_t mode;           // Bitmask of FilterType
+  uint16_t highpass_hz;
+  uint16_t lowpass_hz;
+  uint16_t bandpass_hz;   // Center frequency
+};
+
+// Cascade of fixed-point direct-form-I biquads for one axis. Products are
+// accumulated in 64 bits; the bits dropped when rounding back to counts are
+// fed into the next output (error feedback), so low corners near DC do not
+// build up a truncation offset.
+struct AxisFilter {
+  BiquadCoeffs coeffs[FILTER_MAX_SECTIONS];
+  int32_t x1[FILTER_MAX_SECTIONS], x2[FILTER_MAX_SECTIONS];
+  int32_t y1[FILTER_MAX_SECTIONS], y2[FILTER_MAX_SECTIONS];
+  int32_t err[FILTER_MAX_SECTIONS];
+  uint8_t sections;
+
+  void clearState() {
+    memset(x1, 0, sizeof(x1));
+    memset(x2, 0, sizeof(x2));
+    memset(y1, 0, sizeof(y1));
+    memset(y2, 0, sizeof(y2));
+    memset(err, 0, sizeof(err));
+  }
+
+  inline int32_t process(int32_t x) {
+    for (uint8_t s = 0; s < sections; s++) {
+      const BiquadCoeffs& c = coeffs[s];
+      int64_t acc = (int64_t)c.b0 * x + (int64_t)c.b1 * x1[s] + (int64_t)c.b2 * x2[s]
+                  - (int64_t)c.a1 * y1[s] - (int64_t)c.a2 * y2[s] + err[s];
+      int32_t y = (int32_t)(acc >> FILTER_COEFF_FRAC_BITS);
+      err[s] = (int32_t)(acc - (int64_t)y * (1L << FILTER_COEFF_FRAC_BITS));
+      x2[s] = x1[s];
+      x1[s] = x;
+      y2[s] = y1[s];
+      y1[s] = y;
+      x = y;
+    }
+    // Keep the output inside the sensor range the buffers are sized for
+    const int32_t limit = (1L << (ACCEL_SAMPLE_BITS - 1)) - 1;
+    if (x > limit) x = limit;
+    if (x < -limit) x = -limit;
+    return x;
+  }
+};
+
+// Per-axis filter chain on the sampling core, between the sensor read and
+// the hand-off to the processing core. The same per-axis settings apply to
+// every channel; each channel keeps its own filter state.
+//
+// Coefficients for the common sample rates and corners come from a table
+// built into flash, so the usual configurations never touch the FPU; other
+// combinations are designed once when the settings are applied.
+class SampleFilter {
+private:
+  AxisFilter filters[NUM_ACCEL_CHANNELS][3];
+  AxisFilterConfig active[3];
+  uint16_t sample_rate_hz;
+  bool any_active;
+  uint8_t rejected_sections;  // Sections dropped as invalid for the rate
+  uint8_t designed_sections;  // Sections not found in the table
+
+  // Requested settings (Modbus task), picked up by the sampling task
+  volatile uint8_t requested_mode[3];
+  volatile uint16_t requested_highpass_hz[3];
+  volatile uint16_t requested_lowpass_hz[3];
+  volatile uint16_t requested_bandpass_hz[3];
+  volatile bool settings_pending;
+
+  void applySettings();
+
+public:
+  SampleFilter();
+
+  // Any task: new settings for one axis (0 = X, 1 = Y, 2 = Z)
+  void configure(uint8_t axis, uint8_t mode, uint16_t highpass_hz, uint16_t lowpass_hz,
+                 uint16_t bandpass_hz);
+
+  // Sampling task: the sensor rate changed; redesigns and clears state
+  void setSampleRate(uint16_t sample_rate);
+
+  // Sampling task, once per wakeup: apply pending settings
+  inline void update() {
+    if (settings_pending) applySettings();
+  }
+
+  bool isActive() const { return any_active; }
+
+  // Sampling task: filter one sample of a channel in place
+  inline void process(uint8_t channel, int32_t& x, int32_t& y, int32_t& z) {
+    x = filters[channel][0].process(x);
+    y = filters[channel][1].process(y);
+    z = filters[channel][2].process(z);
+  }
+
+  // Coefficients for one section; false if the corner is not usable at this rate
+  static bool lookupCoeffs(uint8_t type, uint16_t sample_rate, uint16_t corner_hz, BiquadCoeffs& out);
+  static bool designCoeffs(uint8_t type, uint16_t sample_rate, uint16_t corner_hz, BiquadCoeffs& out);
+
+  void printInfo() const;
+};
+
+extern SampleFilter sampleFilter;
+
+#endif // FILTER_CHAIN_H
@@ -0,0 +1,49 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+
+// Integer helpers for the fixed-point statistics path. Everything here is
+// plain 64-bit integer arithmetic, so the ESP32 and a host build produce
+// bit-identical results (test/test_signal_processing checks this). Signed
+// values are scaled up by multiplying with (1 << bits), never by shifting:
+// a left shift of a negative value is undefined before C++20.
+
+// num / den rounded to nearest, halves away from zero; den > 0
+static inline int64_t divRound(int64_t num, int64_t den) {
+  return num >= 0 ? (num + den / 2) / den : -((-num + den / 2) / den);
+}
+
+// (num << frac_bits) / den rounded, without overflowing the shift;
+// requires den < 2^(63 - frac_bits)
+static inline uint64_t fixedDiv(uint64_t num, uint64_t den, uint8_t frac_bits) {
+  uint64_t q = num / den;
+  uint64_t r = num % den;
+  return (q << frac_bits) + ((r << frac_bits) + den / 2) / den;
+}
+
+// value * 2^-shift rounded to nearest
+static inline int64_t roundShift(int64_t value, uint8_t shift) {
+  return (value + ((int64_t)1 << (shift - 1))) >> shift;
+}
+
+// Square root rounded to nearest
+static inline uint32_t isqrt64(uint64_t x) {
+  uint64_t root = 0;
+  uint64_t bit = 1ULL << 62;
+  while (bit > x) bit >>= 2;
+  while (bit != 0) {
+    if (x >= root + bit) {
+      x -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  // x now holds the remainder x - root^2; round up past root + 0.5
+  if (x > root) root++;
+  return (uint32_t)root;
+}
+
+#endif // FIXED_POINT_H
@@ -0,0 +1,133 @@
+#ifndef GOERTZEL_H
+#define GOERTZEL_H
+
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "config.h"
+#include "data_buffer.h"
+
+// Tone tracking configuration
+#define GOERTZEL_NUM_TONES       4     // Target frequencies tracked per channel
+#define GOERTZEL_COEFF_FRAC_BITS 30    // 2 cos(w) is Q30
+#define GOERTZEL_BUDGET_CYCLES   400   // CPU cycles allowed per channel-sample (all tones, 3 axes)
+
+struct ToneResult {
+  uint16_t frequency_dhz[GOERTZEL_NUM_TONES];   // Target, Hz x 10 (0 = off)
+  float amplitude_g[GOERTZEL_NUM_TONES][3];     // Peak amplitude per axis
+  float phase_deg[GOERTZEL_NUM_TONES][3];       // Cosine phase at the first sample of the block, -180..180
+  uint16_t block_samples;
+  uint32_t sequence;                            // Increments per block
+  bool valid;
+};
+
+// Resonator state of one block, as latched at the block end; tones are
+// packed in active order, tone_slot maps them back to register slots
+struct ToneSnapshot {
+  int64_t s1[GOERTZEL_NUM_TONES][3];
+  int64_t s2[GOERTZEL_NUM_TONES][3];
+  int64_t sum[3];                               // Input sum, to take the mean out afterwards
+  int32_t coeff[GOERTZEL_NUM_TONES];
+  uint8_t tone_slot[GOERTZEL_NUM_TONES];
+  uint8_t num_tones;
+  uint16_t frequency_dhz[GOERTZEL_NUM_TONES];   // Per slot
+  uint16_t block_samples;
+  uint16_t sample_rate_hz;
+  int32_t counts_per_g;
+  uint32_t sequence;
+  bool valid;
+};
+
+// Goertzel filter bank on the sampling core: a handful of target
+// frequencies (running speed, harmonics, blade pass, gear mesh) tracked per
+// channel and axis over blocks of one analysis window, at a fraction of an
+// FFT's cost and memory.
+//
+// The resonators run in 64-bit integers with a Q30 coefficient; the product
+// is split into two 32x32 multiplies so it cannot overflow however long the
+// block or however close the tone is to DC. At the block end the sampling
+// task only latches the state; amplitude and phase (with the block mean
+// removed) are finished in double precision by the first task to read them
+// and cached until the next block.
+//
+// Blocks are rectangular-windowed: a tone half a bin (sample rate / block
+// samples / 2) off its target reads 3.9 dB low.
+class ToneBank {
+private:
+  int32_t coeff[GOERTZEL_NUM_TONES];            // 2 cos(w), Q30
+  int64_t s1[NUM_ACCEL_CHANNELS][GOERTZEL_NUM_TONES][3];
+  int64_t s2[NUM_ACCEL_CHANNELS][GOERTZEL_NUM_TONES][3];
+  int64_t sum[NUM_ACCEL_CHANNELS][3];
+  uint16_t count[NUM_ACCEL_CHANNELS];
+  uint16_t frequency_dhz[GOERTZEL_NUM_TONES];
+  uint8_t num_tones;                            // Active tones, packed first
+  uint8_t tone_slot[GOERTZEL_NUM_TONES];        // Register slot of each active tone
+  uint16_t block_samples;
+  uint16_t sample_rate_hz;
+  int32_t counts_per_g;
+
+  // Requested targets (Modbus task), picked up by the sampling task
+  volatile uint16_t requested_dhz[GOERTZEL_NUM_TONES];
+  volatile bool settings_pending;
+
+  ToneSnapshot snapshots[NUM_ACCEL_CHANNELS];
+  mutable ToneResult results[NUM_ACCEL_CHANNELS];  // Finished from the snapshot of the same sequence
+  mutable portMUX_TYPE results_lock;
+
+  void applySettings();
+  void clearState(uint8_t channel);
+  void finishBlock(uint8_t channel);
+
+  // (c * s) >> 30, rounded, without a 64x64 multiply
+  static inline int64_t mulCoeff(int32_t c, int64_t s) {
+    int32_t hi = (int32_t)(s >> 32);
+    uint32_t lo = (uint32_t)s;
+    return ((int64_t)c * hi * 4) +
+           (((int64_t)c * lo + (1LL << (GOERTZEL_COEFF_FRAC_BITS - 1))) >> GOERTZEL_COEFF_FRAC_BITS);
+  }
+
+public:
+  ToneBank();
+
+  // Sampling task: rate, scale or window length changed; clears state
+  void configure(uint16_t sample_rate, int32_t counts_per_g, uint16_t block_length);
+
+  // Any task: target frequencies in Hz x 10, GOERTZEL_NUM_TONES entries (0 = off)
+  void setFrequencies(const uint16_t* frequency_dhz);
+
+  // Sampling task, once per wakeup: apply pending settings
+  inline void update() {
+    if (settings_pending) applySettings();
+  }
+
+  bool isActive() const { return num_tones > 0 && block_samples > 0; }
+
+  // Sampling task: one filtered sample of a channel, in counts
+  inline void process(uint8_t channel, int32_t x, int32_t y, int32_t z) {
+    const int32_t in[3] = { x, y, z };
+    for (uint8_t a = 0; a < 3; a++) {
+      sum[channel][a] += in[a];
+    }
+    for (uint8_t t = 0; t < num_tones; t++) {
+      int64_t* p1 = s1[channel][t];
+      int64_t* p2 = s2[channel][t];
+      for (uint8_t a = 0; a < 3; a++) {
+        int64_t s = in[a] + mulCoeff(coeff[t], p1[a]) - p2[a];
+        p2[a] = p1[a];
+        p1[a] = s;
+      }
+    }
+    if (++count[channel] >= block_samples) {
+      finishBlock(channel);
+    }
+  }
+
+  // Any task: amplitude and phase of the latest block for a channel; the
+  // trigonometry runs once per block, later calls copy the cached result
+  bool getResult(uint8_t channel, ToneResult& out) const;
+
+  void printInfo() const;
+};
+
+extern ToneBank toneBank;
+
+#endif // GOERTZEL_H
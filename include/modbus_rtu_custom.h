@@ -2,7 +2,10 @@
 #define MODBUS_RTU_CUSTOM_H
 
 #include <Arduino.h>
+#include "config.h"
 #include "analytics.h"
+#include "spectrum.h"
+#include "goertzel.h"
 
 // Modbus RTU configuration
 #define MODBUS_SLAVE_ID         2     // Modbus slave address
@@ -38,9 +41,30 @@
 // Register Map - Holding Registers (Read/Write) starting at address 0
 #define REG_DEVICE_ID           0     // Device identification
 #define REG_FIRMWARE_VERSION    1     // Firmware version
-#define REG_SAMPLE_RATE         2     // Sample rate in Hz
+#define REG_SAMPLE_RATE         2     // Sample rate in Hz (write to retune sensor ODR)
 #define REG_WINDOW_COUNT_LOW    3     // Window count (lower 16 bits)
 #define REG_WINDOW_COUNT_HIGH   4     // Window count (upper 16 bits)
+#define REG_ACCEL_RANGE         5     // Full-scale range in g (2, 4, 8; 16 on MPU6050)
+#define REG_HPF_CORNER          6     // Sensor high-pass corner code (0 = off, 1-6)
+#define REG_WINDOW_LENGTH_MS    7     // Analysis window length in ms
+#define REG_HOP_LENGTH_MS       8     // Report interval in ms (0 or >= window = tumbling)
+#define REG_EVENT_THRESHOLD_MG  9     // Event trigger level, per-axis deviation from the running mean in mg (0 = off)
+#define REG_EVENT_PRE_MS        10    // Event history kept before the trigger, ms
+#define REG_EVENT_POST_MS       11    // Event samples captured after the trigger, ms
+#define REG_EVENT_TRIGGER       12    // Write 1 to capture an event now (reads back 0)
+#define REG_BAND_EDGE_BASE      13    // Spectrum band edges in Hz, SPECTRUM_NUM_BANDS + 1 registers (13-17)
+#define REG_FILTER_BASE         18    // Sample filter, one block per axis (X 18-21, Y 22-25, Z 26-29):
+#define REG_FILTER_AXIS_SIZE    4
+#define REG_FLT_MODE            0     // Axis offset: bitmask, 1 DC block, 2 high-pass, 4 low-pass, 8 band-pass
+#define REG_FLT_HIGHPASS_HZ     1     // Axis offset: high-pass corner (Hz)
+#define REG_FLT_LOWPASS_HZ      2     // Axis offset: low-pass corner (Hz)
+#define REG_FLT_BANDPASS_HZ     3     // Axis offset: band-pass center (Hz)
+#define REG_ISO_MACHINE_CLASS   30    // Velocity zone limits: 0-3 ISO 10816-1 class I-IV, 4-7 ISO 10816-3 (see velocity.h)
+#define REG_VELOCITY_HIGHPASS_HZ 31   // Velocity band lower edge in Hz (10 per ISO 10816, 2 for slow machines)
+#define REG_ENVELOPE_BAND_LOW_HZ  32  // Envelope demodulation band lower edge (Hz)
+#define REG_ENVELOPE_BAND_HIGH_HZ 33  // Envelope demodulation band upper edge (Hz, < 0.45x sample rate)
+#define REG_TONE_FREQ_BASE      34    // Tracked tone frequencies, Hz x 10, GOERTZEL_NUM_TONES registers (34-37, 0 = off)
+#define REG_SENSOR_LPF          38    // Sensor low-pass code: MPU6050 DLPF_CFG 0-6 (260..5 Hz); reads 0 on the ADXL355
 
 // Register Map - Input Registers (Read-Only) starting at address 0
 // Current window statistics
@@ -84,10 +108,100 @@
 #define REG_ANALYTICS_ERRORS    33    // Analytics error count
 #define REG_MISSED_SAMPLES      34    // Missed sample count
 #define REG_LAST_UPDATE_TIME    35    // Time since last analytics update (ms)
+#define REG_FIFO_OVERRUNS       36    // Sensor FIFO overrun count (FIFO acquisition mode)
+#define REG_DRDY_JITTER_US      37    // Max data-ready period deviation (us, DRDY acquisition mode)
+#define REG_EVENT_COUNT         38    // Events captured since startup (lower 16 bits)
+#define REG_EVENT_STORED        39    // Events currently held for retrieval
+#define REG_EVENT_LAST_SOURCE   40    // Source of the newest event (1 threshold, 2 Modbus, 3 GPIO)
+#define REG_EVENT_LAST_AGE_S    41    // Seconds since the newest event was captured
+#define REG_FILTER_CYCLES       42    // Sample filter CPU cycles per channel-sample (average)
+#define REG_FILTER_OVER_BUDGET  43    // Sampling wakeups where the filter exceeded its cycle budget
+#define REG_DECIMATION_CYCLES   44    // Oversampling decimator CPU cycles per sensor channel-sample (average)
+#define REG_SENSOR_RATE_HZ      45    // Sensor ODR before decimation (REG_SAMPLE_RATE is the output rate)
+#define REG_ENVELOPE_CYCLES     46    // Envelope front end CPU cycles per channel-sample (average)
+#define REG_ENVELOPE_OVER_BUDGET 47   // Processing batches where the envelope front end exceeded its cycle budget
+#define REG_TONE_CYCLES         48    // Tone bank CPU cycles per channel-sample (average)
+#define REG_TONE_OVER_BUDGET    49    // Sampling wakeups where the tone bank exceeded its cycle budget
+
+// Per-channel register banks. Registers 0-29 above always carry channel 0;
+// bank n starts at REG_CHANNEL_BANK_BASE + n * REG_CHANNEL_BANK_SIZE and repeats
+// the REG_CURRENT_AVG_X..REG_GLOBAL_MIN_Z offsets for that channel, followed by:
+#define REG_CHANNEL_BANK_BASE   64
+#define REG_CHANNEL_BANK_SIZE   32
+#define REG_CH_SENSOR_STATUS    30    // Bank offset: 1 = sensor active, 0 = not found
+#define REG_CH_WINDOW_COUNT     31    // Bank offset: window count (lower 16 bits)
+
+// Waveform shape and data-quality banks, one per channel at
+// REG_SHAPE_BASE + n * REG_SHAPE_BANK_SIZE (between the channel banks and the
+// spectrum banks). Three axis blocks (X, Y, Z) of REG_SHAPE_AXIS_SIZE
+// registers at offsets 0, 5 and 10, then the vector RMS.
+#define REG_SHAPE_BASE          192
+#define REG_SHAPE_BANK_SIZE     16
+#define REG_SHAPE_AXIS_SIZE     5
+#define REG_SHAPE_P2P           0     // Axis offset: peak-to-peak (mg)
+#define REG_SHAPE_CREST         1     // Axis offset: crest factor, peak |a - mean| / std (x1000)
+#define REG_SHAPE_SKEW          2     // Axis offset: skewness (x1000, signed)
+#define REG_SHAPE_KURT          3     // Axis offset: kurtosis (x1000, 3000 for Gaussian noise, clamps at 32767)
+#define REG_SHAPE_CLIPPED       4     // Axis offset: samples at the sensor output limit in the window
+#define REG_SHAPE_VECTOR_RMS    15    // Bank offset: RMS of the mean-removed vector magnitude (mg)
+
+// Spectrum register banks, one per channel at REG_SPECTRUM_BASE + n * REG_SPECTRUM_BANK_SIZE.
+// Each holds three axis blocks (X, Y, Z) of REG_SPEC_AXIS_SIZE registers at
+// offsets 0, 16 and 32, laid out as below, followed by the bank status.
+#define REG_SPECTRUM_BASE       256
+#define REG_SPECTRUM_BANK_SIZE  64
+#define REG_SPEC_AXIS_SIZE      16
+#define REG_SPEC_DOMINANT_FREQ  0     // Axis offset: dominant frequency (Hz x 10)
+#define REG_SPEC_DOMINANT_AMP   1     // Axis offset: dominant amplitude (mg)
+#define REG_SPEC_PEAK_BASE      2     // Axis offset: SPECTRUM_NUM_PEAKS x (frequency Hz x 10, amplitude mg)
+#define REG_SPEC_BAND_BASE      8     // Axis offset: SPECTRUM_NUM_BANDS x band RMS (mg)
+#define REG_SPEC_SEQUENCE       48    // Bank offset: spectra computed (lower 16 bits)
+#define REG_SPEC_RESOLUTION     49    // Bank offset: bin spacing (Hz x 1000)
+#define REG_SPEC_COMPUTE_US     50    // Bank offset: time for the last spectrum (us)
+
+// Velocity register banks, one per channel at REG_VELOCITY_BASE + n * REG_VELOCITY_BANK_SIZE
+// (after the spectrum banks for MAX_ACCEL_CHANNELS), updated once per window or hop
+#define REG_VELOCITY_BASE       512
+#define REG_VELOCITY_BANK_SIZE  8
+#define REG_VEL_RMS_X           0     // Bank offset: velocity RMS X (0.01 mm/s)
+#define REG_VEL_RMS_Y           1     // Bank offset: velocity RMS Y (0.01 mm/s)
+#define REG_VEL_RMS_Z           2     // Bank offset: velocity RMS Z (0.01 mm/s)
+#define REG_VEL_ZONE_X          3     // Bank offset: severity zone X (0 A, 1 B, 2 C, 3 D)
+#define REG_VEL_ZONE_Y          4     // Bank offset: severity zone Y
+#define REG_VEL_ZONE_Z          5     // Bank offset: severity zone Z
+#define REG_VEL_WORST_ZONE      6     // Bank offset: worst zone of the three axes
+#define REG_VEL_SEQUENCE        7     // Bank offset: blocks computed (lower 16 bits)
+
+// Envelope spectrum banks, one per channel at REG_ENVELOPE_BASE + n * REG_ENVELOPE_BANK_SIZE
+// (after the velocity banks for MAX_ACCEL_CHANNELS). Three axis blocks (X, Y, Z) of
+// REG_ENV_AXIS_SIZE registers at offsets 0, 8 and 16, followed by the bank status.
+#define REG_ENVELOPE_BASE       544
+#define REG_ENVELOPE_BANK_SIZE  32
+#define REG_ENV_AXIS_SIZE       8
+#define REG_ENV_RMS             0     // Axis offset: envelope RMS, mean removed (mg)
+#define REG_ENV_PEAK_BASE       1     // Axis offset: ENVELOPE_NUM_PEAKS x (frequency Hz x 10, amplitude mg)
+#define REG_ENV_SEQUENCE        24    // Bank offset: envelope spectra computed (lower 16 bits)
+#define REG_ENV_RESOLUTION      25    // Bank offset: bin spacing (Hz x 1000)
+#define REG_ENV_COMPUTE_US      26    // Bank offset: time for the last three axis spectra (us)
+
+// Tone banks, one per channel at REG_TONE_BANK_BASE + n * REG_TONE_BANK_SIZE (after the
+// envelope banks for MAX_ACCEL_CHANNELS), updated once per window. One block of
+// REG_TONE_BLOCK_SIZE registers per tone slot, in REG_TONE_FREQ_BASE order.
+// Blocks are not windowed: a tone within half a bin (sample rate / block
+// samples / 2) of its target reads low by up to 3.9 dB (x0.64); further off,
+// it falls into the sidelobes.
+#define REG_TONE_BANK_BASE      672
+#define REG_TONE_BANK_SIZE      32
+#define REG_TONE_BLOCK_SIZE     6
+#define REG_TONE_AMP_X          0     // Tone offset: amplitude X (mg), then phase X (deg x 10, signed)
+#define REG_TONE_AMP_Y          2     // Tone offset: amplitude Y (mg), then phase Y
+#define REG_TONE_AMP_Z          4     // Tone offset: amplitude Z (mg), then phase Z
+#define REG_TONE_SEQUENCE       24    // Bank offset: blocks computed (lower 16 bits)
+#define REG_TONE_BLOCK_SAMPLES  25    // Bank offset: samples per block
 
 // Configuration constants
-#define NUM_HOLDING_REGISTERS   5     // Number of holding registers
-#define NUM_INPUT_REGISTERS     36    // Number of input registers (updated for STD/RMS)
+#define NUM_HOLDING_REGISTERS   (REG_SENSOR_LPF + 1)    // Number of holding registers
+#define NUM_INPUT_REGISTERS     (REG_TONE_BANK_BASE + NUM_ACCEL_CHANNELS * REG_TONE_BANK_SIZE)
 #define MODBUS_SCALE_FACTOR     1000  // Scale factor for float values
 #define FIRMWARE_VERSION        100   // v1.00
 
@@ -141,6 +255,8 @@ private:
   // Statistics
   ModbusStats stats;
   unsigned long last_update_time;
+  unsigned long config_generation_seen;
+  unsigned long config_errors_seen;
   
   // Private methods
   void setTransmitMode();
@@ -165,7 +281,33 @@ private:
   
   // Register management
   void updateRegistersFromAnalytics();
+  void updateStatsRegisters(uint16_t base, const AnalyticsData& data);
+  void updateChannelBanks();
+  void updateShapeRegisters(uint16_t base, const AnalyticsData& data);
+  void updateSpectrumRegisters();
+  void updateVelocityRegisters();
+  void updateEnvelopeRegisters();
+  void updateToneRegisters();
+  void updateConfigRegisters();
+  void restoreConfigRegisters();
+  bool isValidHoldingWrite(uint16_t address, uint16_t value);
+  bool isConfigRegister(uint16_t address);
+  void applyConfigRegisters();
+  bool isEventRegister(uint16_t address);
+  void applyEventRegisters();
+  bool isSpectrumRegister(uint16_t address);
+  void applySpectrumRegisters();
+  bool isFilterRegister(uint16_t address);
+  void applyFilterRegisters();
+  bool isVelocityRegister(uint16_t address);
+  void applyVelocityRegisters();
+  bool isEnvelopeRegister(uint16_t address);
+  void applyEnvelopeRegisters();
+  bool isToneRegister(uint16_t address);
+  void applyToneRegisters();
   int16_t floatToScaledInt(float value);
+  int16_t countsToScaledInt(int32_t value, int32_t counts_per_g);
+  int16_t ratioToScaledInt(int32_t value);
   uint16_t getTaskStatusFlags();
   
   // Utility functions
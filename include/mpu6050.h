@@ -0,0 +1,64 @@
+#ifndef MPU6050_H
+#define MPU6050_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "config.h"
+
+// Register-level MPU6050 driver: accelerometer only, 400 kHz burst reads
+class MPU6050 {
+private:
+  bool initialized;
+  uint8_t address;
+  uint8_t range_g;
+  uint8_t dlpf_cfg;
+  uint8_t sample_rate_divider;
+  bool fifo_enabled;
+  unsigned long fifo_overruns;
+  
+public:
+  MPU6050(uint8_t i2c_address = MPU6050_I2C_ADDRESS);
+  
+  // Initialization
+  bool probe();
+  bool begin();
+  void end();
+  
+  // Low-level register access
+  void writeRegister(uint8_t reg, uint8_t value);
+  uint8_t readRegister(uint8_t reg);
+  bool readRegisters(uint8_t reg, uint8_t* data, uint8_t length);
+  
+  // Data reading
+  bool readXYZ(int32_t &x, int32_t &y, int32_t &z);
+  bool readAcceleration(float &x_g, float &y_g, float &z_g);
+  
+  // Measurement configuration
+  bool setRange(uint8_t range);
+  bool setDlpf(uint8_t cfg);
+  bool setSampleRateDivider(uint8_t divider);
+  bool setSampleRate(uint16_t rate_hz);
+  uint8_t getRange() const { return range_g; }
+  uint8_t getDlpf() const { return dlpf_cfg; }
+  uint8_t getSampleRateDivider() const { return sample_rate_divider; }
+  uint16_t getSampleRate() const;
+  
+  // FIFO burst acquisition
+  bool configureFifo();
+  uint16_t getFifoCount();
+  uint16_t readFifo(int32_t* xyz, uint16_t max_samples, bool* overrun = nullptr, uint16_t* waiting = nullptr);
+  unsigned long getFifoOverruns() const { return fifo_overruns; }
+  
+  // Data-ready interrupt on the INT pin
+  void enableDataReadyInterrupt(bool enable);
+  
+  // Device identification
+  bool checkDeviceID();
+  void printDeviceInfo();
+  
+  // Status
+  bool isInitialized() const { return initialized; }
+  float getScaleFactor() const;
+};
+
+#endif // MPU6050_H
@@ -0,0 +1,96 @@
+#ifndef PACKED_HISTORY_H
+#define PACKED_HISTORY_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// History configuration
+#define HISTORY_SECONDS        120     // Requested raw history per channel at the default rate
+#define HISTORY_INTERNAL_SECONDS 4     // Raw history per channel without PSRAM (covers EVENT_MAX_SAMPLES at 1 kHz)
+#define HISTORY_HEAP_RESERVE   32768   // Internal heap left free for tasks and drivers
+#define HISTORY_MIN_SAMPLES    1024    // Below this the history is not worth keeping
+#define HISTORY_UNPACK_BLOCK   256     // Samples per unpack call when streaming into kernels
+
+// Packed sample layout: three signed 20-bit axes in one 64-bit word
+//   bits  0-19  x
+//   bits 20-39  y
+//   bits 40-59  z
+//   bits 60-63  reserved (0)
+// 8 bytes per sample instead of 12 (SoA int32) or 16 (AccelSample), which
+// covers the ADXL355's native resolution and the MPU6050's 16-bit counts.
+#define PACKED_AXIS_BITS       20
+#define PACKED_AXIS_MASK       0xFFFFFULL
+#define PACKED_AXIS_MAX        ((1L << (PACKED_AXIS_BITS - 1)) - 1)
+#define PACKED_AXIS_MIN        (-(1L << (PACKED_AXIS_BITS - 1)))
+
+// Circular history of raw samples for post-event inspection. Written by the
+// processing task as samples leave the ring; the newest sample overwrites
+// the oldest once full. Sample times are implied by the sample interval and
+// the newest timestamp.
+class PackedHistory {
+private:
+  uint64_t* samples;
+  uint32_t capacity;
+  uint32_t head;           // Next slot to write
+  uint32_t count;
+  bool in_psram;
+  unsigned long newest_time_us;
+  unsigned long sampling_interval_us;
+
+  static inline int32_t clampAxis(int32_t v) {
+    if (v > PACKED_AXIS_MAX) return PACKED_AXIS_MAX;
+    if (v < PACKED_AXIS_MIN) return PACKED_AXIS_MIN;
+    return v;
+  }
+
+public:
+  // Sign-extend a 20-bit field
+  static inline int32_t unpackAxis(uint64_t word, uint8_t shift) {
+    return ((int32_t)((uint32_t)(word >> shift) << 12)) >> 12;
+  }
+
+  PackedHistory();
+  ~PackedHistory();
+
+  // Allocates max_samples in PSRAM when the module has it. Otherwise it
+  // takes at most internal_samples of internal RAM, a fixed budget so one
+  // history cannot starve the next, and less if the heap cannot spare it.
+  bool begin(uint32_t max_samples, uint32_t internal_samples);
+  void reset();
+  void setSamplingInterval(unsigned long interval_us) { sampling_interval_us = interval_us; }
+
+  static inline uint64_t pack(int32_t x, int32_t y, int32_t z) {
+    return ((uint64_t)((uint32_t)clampAxis(x)) & PACKED_AXIS_MASK) |
+           (((uint64_t)((uint32_t)clampAxis(y)) & PACKED_AXIS_MASK) << 20) |
+           (((uint64_t)((uint32_t)clampAxis(z)) & PACKED_AXIS_MASK) << 40);
+  }
+
+  void add(int32_t x, int32_t y, int32_t z, unsigned long timestamp_us) {
+    if (!samples) return;
+    samples[head] = pack(x, y, z);
+    head = (head + 1 == capacity) ? 0 : head + 1;
+    if (count < capacity) count++;
+    newest_time_us = timestamp_us;
+  }
+
+  // Unpack up to n samples starting at 'offset' (0 = oldest held) into
+  // separate axis arrays. Returns the number of samples written.
+  uint32_t unpack(uint32_t offset, uint32_t n, int32_t* x, int32_t* y, int32_t* z) const;
+
+  // Same, addressed back from the newest sample: the last n samples
+  uint32_t unpackRecent(uint32_t n, int32_t* x, int32_t* y, int32_t* z) const;
+
+  // Copy the last n samples out still packed (oldest first)
+  uint32_t copyRecent(uint32_t n, uint64_t* out) const;
+
+  // Status
+  uint32_t getCapacity() const { return capacity; }
+  uint32_t getCount() const { return count; }
+  bool isInPsram() const { return in_psram; }
+  unsigned long getNewestTime() const { return newest_time_us; }
+  unsigned long getOldestTime() const;
+  float getSpanSeconds() const;
+  uint32_t getMemoryBytes() const { return capacity * sizeof(uint64_t); }
+};
+
+#endif // PACKED_HISTORY_H
@@ -0,0 +1,124 @@
+#ifndef SENSOR_POLICY_H
+#define SENSOR_POLICY_H
+
+#include "accelerometer_config.h"
+#include "adxl355.h"
+#include "mpu6050.h"
+
+// Driver instances, owned by the per-sensor translation units
+extern ADXL355 adxl355_sensors[NUM_ACCEL_CHANNELS];
+extern ADXL355& adxl355_sensor;  // Channel 0
+extern MPU6050 mpu6050_sensor;
+
+// Sensor policies: the sampling pipeline takes one of these as a template
+// parameter, so the per-sample read is a direct inlined call into the driver
+// with no virtual or runtime dispatch. Both policies are always compiled in;
+// accel_init() picks one at boot. Channels present are reported as a bitmask;
+// single-sensor policies only ever report channel 0.
+//
+// The FIFO drain splits each burst: queueBurstRaw starts the transfer and
+// collectBurstRaw waits for it and unpacks, so work done in between overlaps
+// the bus. Sensors without a background transfer do the whole read in
+// collectBurstRaw.
+
+struct Adxl355Policy {
+    static const AccelSensorType type = ACCEL_SENSOR_ADXL355;
+    static uint8_t channel_mask;
+    
+    static inline uint8_t channelMask() { return channel_mask; }
+    
+    static inline bool readRaw(uint8_t channel, AccelRawData& data) {
+        adxl355_sensors[channel].readXYZ(data.x, data.y, data.z);
+        data.valid = true;
+        return true;
+    }
+    
+    static bool probe();
+    static bool init();
+    static void deinit();
+    static bool read(AccelData& data);
+    static bool fifoBegin(uint8_t watermark_samples);
+    static uint16_t readBurstRaw(uint8_t channel, AccelRawData* samples, uint16_t max_samples, AccelBurstInfo& info);
+    static void queueBurstRaw(uint8_t channel, uint16_t max_samples);
+    static uint16_t collectBurstRaw(uint8_t channel, AccelRawData* samples, uint16_t max_samples, AccelBurstInfo& info);
+    static bool dataReadyBegin(bool use_int1);
+    static bool configure(const AccelConfig& config);
+    static float getScaleFactor();
+    static AccelScale getScale();
+    static uint16_t getSampleRate();
+    static AccelCapabilities capabilities();
+    static const char* name() { return "ADXL355"; }
+    static void printInfo();
+};
+
+struct Mpu6050Policy {
+    static const AccelSensorType type = ACCEL_SENSOR_MPU6050;
+    
+    static inline uint8_t channelMask() { return 0x01; }
+    
+    static inline bool readRaw(uint8_t channel, AccelRawData& data) {
+        (void)channel;
+        data.valid = mpu6050_sensor.readXYZ(data.x, data.y, data.z);
+        return data.valid;
+    }
+    
+    static bool probe();
+    static bool init();
+    static void deinit();
+    static bool read(AccelData& data);
+    static bool fifoBegin(uint8_t watermark_samples);
+    static uint16_t readBurstRaw(uint8_t channel, AccelRawData* samples, uint16_t max_samples, AccelBurstInfo& info);
+    
+    // I2C FIFO reads block, so the whole read happens in collectBurstRaw
+    static inline void queueBurstRaw(uint8_t channel, uint16_t max_samples) {
+        (void)channel;
+        (void)max_samples;
+    }
+    
+    static inline uint16_t collectBurstRaw(uint8_t channel, AccelRawData* samples, uint16_t max_samples, AccelBurstInfo& info) {
+        return readBurstRaw(channel, samples, max_samples, info);
+    }
+    
+    static bool dataReadyBegin(bool use_int1);
+    static bool configure(const AccelConfig& config);
+    static float getScaleFactor();
+    static AccelScale getScale();
+    static uint16_t getSampleRate();
+    static AccelCapabilities capabilities();
+    static const char* name() { return "MPU6050"; }
+    static void printInfo();
+};
+
+// Placeholder used when no sensor was found: every read fails, so the
+// pipeline keeps running and counts errors (Modbus stays reachable)
+struct NoSensorPolicy {
+    static const AccelSensorType type = ACCEL_SENSOR_NONE;
+    
+    static inline uint8_t channelMask() { return 0x01; }
+    
+    static inline bool readRaw(uint8_t channel, AccelRawData& data) {
+        (void)channel;
+        data.valid = false;
+        return false;
+    }
+    
+    static inline uint16_t readBurstRaw(uint8_t channel, AccelRawData* samples, uint16_t max_samples, AccelBurstInfo& info) {
+        (void)channel;
+        (void)samples;
+        (void)max_samples;
+        info.fifo_entries = 0;
+        info.overrun = false;
+        return 0;
+    }
+    
+    static inline void queueBurstRaw(uint8_t channel, uint16_t max_samples) {
+        (void)channel;
+        (void)max_samples;
+    }
+    
+    static inline uint16_t collectBurstRaw(uint8_t channel, AccelRawData* samples, uint16_t max_samples, AccelBurstInfo& info) {
+        return readBurstRaw(channel, samples, max_samples, info);
+    }
+};
+
+#endif // SENSOR_POLICY_H
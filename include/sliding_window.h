@@ -0,0 +1,72 @@
+#ifndef SLIDING_WINDOW_H
+#define SLIDING_WINDOW_H
+
+#include <Arduino.h>
+#include "data_buffer.h"
+
+// Monotonic deque of ring positions. Front holds the position of the current
+// extreme; entries behind it can only become the extreme once it expires.
+struct MonoDeque {
+  uint16_t* pos;
+  uint16_t head;
+  uint16_t count;
+  uint16_t capacity;
+};
+
+// Overlapping analysis window: the last window_length samples, reported every
+// hop_length samples. Sums and sums of squares are updated as samples enter
+// and leave, min/max come from monotonic deques, so a hop costs O(hop)
+// instead of a rescan of the whole window. Integer sums keep it drift-free.
+//
+// In sliding mode this replaces the DataBuffer as the window source: the
+// processing task feeds only the SlidingWindow, and each hop's report goes
+// to the analytics task like a tumbling window would, so window counts and
+// running statistics advance once per hop. The ring and deques (about 36 KB
+// per channel at BUFFER_SIZE) are only allocated the first time a hop
+// shorter than the window is configured.
+class SlidingWindow {
+private:
+  int32_t* axis[3];          // Ring of the last window_length samples per axis
+  uint8_t* clip_flags;       // Ring of the samples' CLIP_* masks
+  uint16_t write_pos;        // Next ring position to write (= oldest when full)
+  uint16_t count;
+  uint16_t window_length;
+  uint16_t hop_length;
+  uint16_t since_hop;        // Samples since the last reported window
+  unsigned long newest_time_us;
+  unsigned long sampling_interval_us;
+  int32_t counts_per_g;
+
+  long long sum[3];
+  long long sum_sq[3];
+  int32_t origin[3];         // First sample after a reset; centers the higher moments
+  MomentSums higher[3];
+  uint16_t clipped[3];
+  MonoDeque max_q[3];
+  MonoDeque min_q[3];
+
+  void pushBack(MonoDeque& q, const int32_t* values, uint16_t position, bool is_max);
+  bool allocate();
+
+public:
+  SlidingWindow();
+  ~SlidingWindow();
+
+  bool begin();
+  void reset();
+  // False if overlapping windows were asked for and the memory is not there
+  bool configure(uint16_t window_samples, uint16_t hop_samples, uint16_t sample_rate, int32_t scale_factor);
+  bool isAllocated() const { return axis[0] != nullptr; }
+
+  // Returns true when a hop completes and a full window is ready to report
+  bool addSample(int32_t x, int32_t y, int32_t z, unsigned long timestamp_us, uint8_t clipped = 0);
+
+  // O(1): statistics of the current window
+  void calculateStats(BufferStats& stats) const;
+
+  uint16_t getWindowLength() const { return window_length; }
+  uint16_t getHopLength() const { return hop_length; }
+  uint16_t getSampleCount() const { return count; }
+};
+
+#endif // SLIDING_WINDOW_H
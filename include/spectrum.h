@@ -0,0 +1,112 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "config.h"
+#include "packed_history.h"
+
+// Spectrum configuration
+#define SPECTRUM_FFT_SIZE        1024  // Points per axis (power of two), ~1 s at 1 kHz
+#define SPECTRUM_NUM_PEAKS       3     // Strongest spectral peaks reported per axis
+#define SPECTRUM_NUM_BANDS       4     // Band energies reported per axis
+#define SPECTRUM_DEFAULT_BAND_EDGES_HZ  { 2, 10, 100, 250, 500 }  // SPECTRUM_NUM_BANDS + 1 edges
+
+struct SpectrumPeak {
+  float frequency_hz;   // Interpolated between bins
+  float amplitude_g;    // Peak amplitude of the sinusoid
+};
+
+struct AxisSpectrum {
+  float dominant_hz;                        // Strongest peak (0 if none)
+  float dominant_g;
+  SpectrumPeak peaks[SPECTRUM_NUM_PEAKS];   // Strongest first
+  float band_rms_g[SPECTRUM_NUM_BANDS];     // RMS of the signal content in each band
+};
+
+struct SpectrumResult {
+  AxisSpectrum axis[3];
+  uint16_t sample_rate_hz;
+  float resolution_hz;       // Bin spacing
+  unsigned long compute_us;  // Time for all three axes
+  uint32_t sequence;         // Increments per computed spectrum
+  bool valid;
+};
+
+// Hann-windowed real FFT of the newest SPECTRUM_FFT_SIZE samples of each
+// axis. The processing task stages samples from the channel history when a
+// window closes; the spectrum task does the FFT on core 0 at low priority,
+// so a slow spectrum only ever skips windows, never samples. The history is
+// the unfiltered stream, so the sample filter does not shape the spectrum.
+//
+// The real FFT is computed as an N/2-point complex radix-2 FFT plus a split
+// step, in single-precision float on the ESP32 FPU, with twiddles and the
+// window precomputed at boot.
+class SpectrumAnalyzer {
+private:
+  static const uint16_t HALF = SPECTRUM_FFT_SIZE / 2;
+
+  // Staging area, written by the processing task while 'busy' is false
+  int32_t staged[3][SPECTRUM_FFT_SIZE];
+  uint8_t due_mask;                // Channels with a closed window awaiting a spectrum
+  uint8_t next_channel;            // Round-robin start when several are due
+  uint8_t staged_channel;
+  uint16_t staged_rate_hz;
+  float staged_counts_per_g;
+  volatile bool busy;
+  uint32_t skipped;
+
+  // FFT working set
+  float work[SPECTRUM_FFT_SIZE];   // HALF complex values, interleaved re/im
+  float power[HALF + 1];           // |X[k]|^2, k = 0..N/2
+  float window[SPECTRUM_FFT_SIZE];
+  float tw_cos[HALF];
+  float tw_sin[HALF];
+  float window_sum_sq;             // Noise power gain * N
+
+  // Bands (Hz), updated from the Modbus task, applied before each spectrum
+  volatile uint16_t requested_edges_hz[SPECTRUM_NUM_BANDS + 1];
+  uint16_t band_edges_hz[SPECTRUM_NUM_BANDS + 1];
+
+  SpectrumResult results[NUM_ACCEL_CHANNELS];
+  mutable portMUX_TYPE results_lock;
+
+  void realFft(const int32_t* samples, float mean, float scale);
+  void analyzeAxis(const int32_t* samples, AxisSpectrum& out);
+
+public:
+  SpectrumAnalyzer();
+
+  bool begin();
+  void setBandEdges(const uint16_t* edges_hz);
+
+  // Processing task: a window closed on this channel
+  void markDue(uint8_t channel);
+
+  // Processing task: copy the newest FFT_SIZE samples of the next due
+  // channel for the spectrum task. Returns false if nothing is due, the
+  // previous spectrum is still running or the history is too short.
+  bool stage(const PackedHistory* histories, uint16_t sample_rate, float counts_per_g);
+
+  // Spectrum task: compute the staged spectrum
+  void process();
+
+  // Any task: copy of the latest result for a channel
+  bool getResult(uint8_t channel, SpectrumResult& out) const;
+  uint32_t getSkipped() const { return skipped; }  // Windows that got no spectrum
+};
+
+extern SpectrumAnalyzer spectrumAnalyzer;
+
+// Shared with the envelope analyzer. A 2n-point real FFT packed as n complex
+// points (even samples real, odd imaginary), transformed in place; leaves
+// |X[k]|^2 for k = 0..n in power. tw_cos/tw_sin hold cos/sin(2 pi k / 2n), k < n.
+void fftRealPower(float* data, uint16_t n, const float* tw_cos, const float* tw_sin, float* power);
+
+// Up to max_peaks (<= SPECTRUM_NUM_PEAKS) strongest local maxima of a
+// Hann-windowed power spectrum with n + 1 bins, strongest first; returns the
+// number found. power_scale converts a bin to mean square.
+uint8_t findSpectralPeaks(const float* power, uint16_t n, float resolution, float power_scale,
+                          SpectrumPeak* peaks, uint8_t max_peaks);
+
+#endif // SPECTRUM_H
@@ -0,0 +1,75 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// Cache line size used to keep the producer and consumer indices apart.
+// The ESP32 flash/PSRAM cache uses 32-byte lines.
+#define SPSC_CACHE_LINE 32
+
+// Lock-free single-producer / single-consumer ring buffer.
+//
+// Exactly one task may call push() and exactly one other task may call
+// pop()/popBatch(); they may run on different cores. The producer only writes
+// 'head' and the consumer only writes 'tail'. Each index is published with a
+// release store and read with an acquire load, so a slot is always fully
+// written before the other side can see it. Neither side ever blocks.
+//
+// Capacity must be a power of two. All slots are usable: the indices run
+// freely and are masked on access.
+template <typename T, uint32_t Capacity>
+class SpscRing {
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                "SpscRing capacity must be a power of two");
+
+private:
+  static const uint32_t MASK = Capacity - 1;
+
+  alignas(SPSC_CACHE_LINE) std::atomic<uint32_t> head;  // Next slot to write (producer)
+  alignas(SPSC_CACHE_LINE) std::atomic<uint32_t> tail;  // Next slot to read (consumer)
+  alignas(SPSC_CACHE_LINE) T slots[Capacity];
+
+public:
+  SpscRing() : head(0), tail(0) {}
+
+  // Producer side: returns false (and drops the item) when the ring is full
+  bool push(const T& item) {
+    const uint32_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) >= Capacity) {
+      return false;
+    }
+    slots[h & MASK] = item;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side: copy up to max_items out in one go, oldest first
+  uint32_t popBatch(T* out, uint32_t max_items) {
+    const uint32_t t = tail.load(std::memory_order_relaxed);
+    uint32_t available = head.load(std::memory_order_acquire) - t;
+    if (available > max_items) {
+      available = max_items;
+    }
+    for (uint32_t i = 0; i < available; i++) {
+      out[i] = slots[(t + i) & MASK];
+    }
+    tail.store(t + available, std::memory_order_release);
+    return available;
+  }
+
+  bool pop(T& item) {
+    return popBatch(&item, 1) == 1;
+  }
+
+  // Approximate when called from the side that does not own the index
+  uint32_t size() const {
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+  }
+
+  bool empty() const { return size() == 0; }
+  uint32_t capacity() const { return Capacity; }
+};
+
+#endif // SPSC_RING_H
@@ -0,0 +1,57 @@
+#ifndef STATS_KERNELS_H
+#define STATS_KERNELS_H
+
+#include <stdint.h>
+
+// Reduction kernels (sum, sum of squares, min/max, dot product) over
+// contiguous int32/float arrays: one axis of a window, a staged FFT block, a
+// power spectrum. The backend is chosen at compile time:
+//   - ESP32 with esp-dsp (shipped with the Arduino core): the float sum, dot
+//     product and sum of squares run on the esp-dsp assembly dot products,
+//     which keep the FPU's MADD.S pipeline full. The int32 kernels use the
+//     Xtensa loops below.
+//   - ESP32 without esp-dsp: the Xtensa loops for everything. They are written
+//     so the compiler emits the LX6 MIN/MAX and MULL/MULSH instructions with
+//     no branches in the loop body.
+//   - x86 host with SSE4.1 (-msse4.1 or -march=native): 128-bit SIMD.
+//   - Anything else: the same unrolled loops as on Xtensa.
+//
+// Integer sums and products are accumulated in 64 bits and are exact for
+// sensor counts (|v| < 2^24) over any window this firmware uses. Float
+// results may differ from a naive loop in the last bits because of the
+// summation order.
+
+#if defined(ARDUINO_ARCH_ESP32) || defined(ESP_PLATFORM)
+  #define STATS_KERNELS_XTENSA 1
+  #if defined(__has_include)
+    #if __has_include("esp_dsp.h")
+      #define STATS_KERNELS_ESP_DSP 1
+    #endif
+  #endif
+#elif defined(__SSE4_1__)
+  #define STATS_KERNELS_SSE41 1
+#endif
+
+// Everything a window scan needs from one axis, in a single pass
+struct KernelAxisStats {
+  int64_t sum;
+  int64_t sum_sq;
+  int32_t min;
+  int32_t max;
+};
+
+int64_t statsSumI32(const int32_t* v, uint32_t n);
+int64_t statsSumSqI32(const int32_t* v, uint32_t n);
+int64_t statsDotI32(const int32_t* a, const int32_t* b, uint32_t n);
+void statsMinMaxI32(const int32_t* v, uint32_t n, int32_t* min_out, int32_t* max_out);  // n > 0
+void statsScanI32(const int32_t* v, uint32_t n, KernelAxisStats* out);  // n > 0
+
+float statsSumF32(const float* v, uint32_t n);
+float statsSumSqF32(const float* v, uint32_t n);
+float statsDotF32(const float* a, const float* b, uint32_t n);
+void statsMinMaxF32(const float* v, uint32_t n, float* min_out, float* max_out);  // n > 0
+
+// Backend name for diagnostics ("esp-dsp", "xtensa", "sse4.1", "portable")
+const char* statsKernelBackend();
+
+#endif // STATS_KERNELS_H
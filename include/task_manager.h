@@ -7,50 +7,118 @@
 #include "freertos/semphr.h"
 #include "freertos/queue.h"
 #include "adxl355.h"
+#include "accelerometer_config.h"
 #include "data_buffer.h"
 #include "analytics.h"
+#include "spsc_ring.h"
+#include "packed_history.h"
+#include "sliding_window.h"
+#include "event_capture.h"
+#include "spectrum.h"
+#include "filter_chain.h"
+#include "decimator.h"
+#include "velocity.h"
+#include "envelope.h"
+#include "goertzel.h"
 
 // Task configuration
 #define SAMPLING_TASK_STACK_SIZE    4096
 #define PROCESSING_TASK_STACK_SIZE  4096
 #define ANALYTICS_TASK_STACK_SIZE   4096
 #define MODBUS_TASK_STACK_SIZE      4096
+#define SPECTRUM_TASK_STACK_SIZE    4096
 #define SAMPLING_TASK_PRIORITY      3  // High priority for precise timing
 #define PROCESSING_TASK_PRIORITY    2  // Lower priority for data processing
 #define ANALYTICS_TASK_PRIORITY     1  // Lowest priority for analytics
 #define MODBUS_TASK_PRIORITY        1  // Same as analytics priority
+#define SPECTRUM_TASK_PRIORITY      1  // Background: skips windows rather than delay processing
 #define SAMPLING_TASK_CORE          1  // Core 1 for sampling
 #define PROCESSING_TASK_CORE        0  // Core 0 for processing
 #define ANALYTICS_TASK_CORE         0  // Core 0 for analytics
 #define MODBUS_TASK_CORE            0  // Core 0 for modbus
+#define SPECTRUM_TASK_CORE          0  // Core 0 for spectra
+
+// Sampling -> processing hand-off
+#define SAMPLE_RING_SIZE            1024  // Samples in flight (256 ms at 4 kHz, power of two)
+#define RING_BATCH_SAMPLES          64    // Processing wakes and drains in batches of this size
+#define RING_DRAIN_TIMEOUT_MS       10    // ...or after this long, whichever comes first
 
 // Task handles
 extern TaskHandle_t sampling_task_handle;
 extern TaskHandle_t processing_task_handle;
 extern TaskHandle_t analytics_task_handle;
 extern TaskHandle_t modbus_task_handle;
+extern TaskHandle_t spectrum_task_handle;
 
 // Global objects (defined in main)
 extern ADXL355 sensor;
-extern DataBuffer dataBuffer;
-extern Analytics analytics;
+extern ChannelBuffer dataBuffers[NUM_ACCEL_CHANNELS];
+extern ChannelBuffer& dataBuffer;  // Channel 0
+extern Analytics analyticsChannels[NUM_ACCEL_CHANNELS];
+extern Analytics& analytics;    // Channel 0
+extern SlidingWindow slidingWindows[NUM_ACCEL_CHANNELS];  // Used when hop < window
+extern PackedHistory sampleHistory[NUM_ACCEL_CHANNELS];  // Raw (unfiltered) history, written by the processing task
+extern PackedHistory trendHistory[NUM_ACCEL_CHANNELS];   // Decimated raw trend stream, written by the processing task
+
+// Sample handed from the sampling core to the processing core. x/y/z have
+// been through the sample filter and feed the statistics, velocity and
+// envelope stages; raw_x/raw_y/raw_z are the same sample before the filter
+// (after oversampling decimation) and feed the histories and event captures.
+struct RingSample {
+  int32_t x;
+  int32_t y;
+  int32_t z;
+  int32_t raw_x;
+  int32_t raw_y;
+  int32_t raw_z;
+  uint32_t timestamp_us;
+  uint8_t channel;
+  uint8_t clipped;  // CLIP_* axes that hit the sensor limit since the previous sample
+  uint8_t generation;  // Configuration the sample was taken under
+};
+
+// Lock-free hand-off; the sampling task is the only producer and the
+// processing task the only consumer
+extern SpscRing<RingSample, SAMPLE_RING_SIZE> sample_ring;
 
 // Synchronization primitives
-extern SemaphoreHandle_t buffer_mutex;
+extern SemaphoreHandle_t buffer_mutex;  // Guards the DataBuffers (processing task vs. reconfiguration)
 extern SemaphoreHandle_t buffer_ready_semaphore;
 extern QueueHandle_t analytics_queue;
 
+// Runtime acquisition configuration (requested via Modbus, applied by the sampling task)
+struct AcquisitionConfig {
+  AccelConfig sensor;
+  uint16_t window_length_ms;
+  uint16_t hop_length_ms;  // 0 or >= window: tumbling windows
+};
+
+extern QueueHandle_t config_queue;
+extern AcquisitionConfig active_acquisition_config;
+
+bool requestAcquisitionConfig(const AcquisitionConfig& config);
+
 // Task functions
 void samplingTask(void* parameter);
 void processingTask(void* parameter);
 void analyticsTask(void* parameter);
 void modbusTask(void* parameter);
+void spectrumTask(void* parameter);
 
 // Task management functions
 bool startTasks();
 void stopTasks();
 void printTaskInfo();
 
+// CPU cost of a per-sample processing stage, in cycles per channel-sample
+struct StageCost {
+  uint16_t cycles_avg = 0;        // Last 1000 samples
+  uint16_t cycles_peak = 0;       // Worst batch average since boot
+  unsigned long over_budget = 0;  // Batches above the stage's cycle budget
+  uint32_t window_cycles = 0;
+  uint16_t window_samples = 0;
+};
+
 // Task status monitoring
 struct TaskManagerStatus {
   unsigned long sampling_loop_count = 0;
@@ -69,8 +137,25 @@ struct TaskManagerStatus {
   bool processing_task_running = false;
   bool analytics_task_running = false;
   bool modbus_task_running = false;
+  bool spectrum_task_running = false;
   unsigned long missed_samples = 0;
+  uint16_t ring_peak_level = 0;
   float actual_sample_rate = 0.0;
+  uint8_t acquisition_mode = ACQ_MODE_POLLING;
+  unsigned long fifo_drains = 0;
+  unsigned long fifo_overruns = 0;
+  uint8_t fifo_peak_level = 0;
+  unsigned long drdy_jitter_max_us = 0;
+  unsigned long drdy_timeouts = 0;
+  unsigned long config_generation = 0;
+  unsigned long config_errors = 0;
+  StageCost filter_cost;                // Sample filter, sampling core
+  StageCost decimator_cost;             // Oversampling decimator, sampling core (per sensor sample)
+  StageCost trend_cost;                 // Trend decimator, processing core
+  StageCost velocity_cost;              // Velocity integration, processing core
+  StageCost envelope_cost;              // Envelope band-pass, rectify and decimate, processing core
+  StageCost tone_cost;                  // Goertzel tone bank, sampling core
+  uint16_t sensor_rate_hz = SAMPLE_RATE_HZ;  // Sensor ODR before decimation
 };
 
 extern TaskManagerStatus task_status;
@@ -0,0 +1,112 @@
+#ifndef VELOCITY_H
+#define VELOCITY_H
+
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "config.h"
+#include "filter_chain.h"
+
+// Velocity configuration
+#define VELOCITY_SCALE_FRAC_BITS  24    // Integral-to-um/s scale is Q24
+#define VELOCITY_LEAK_RATIO       10    // Integrator leak corner at least this far below the high-pass corner
+#define VELOCITY_BUDGET_CYCLES    400   // CPU cycles allowed per channel-sample (3 axes)
+#define VELOCITY_MAX_UM_S         10000000L  // Per-sample clamp (10 m/s) so a block's sum of squares cannot overflow
+#define ISO_NUM_MACHINE_CLASSES   8
+
+// Severity zones, ISO 10816 / 20816 naming
+enum IsoZone : uint8_t {
+  ISO_ZONE_A = 0,   // Newly commissioned
+  ISO_ZONE_B = 1,   // Unrestricted long-term operation
+  ISO_ZONE_C = 2,   // Restricted operation
+  ISO_ZONE_D = 3    // Damage likely
+};
+
+struct VelocityResult {
+  uint32_t rms_um_s[3];   // Velocity RMS per axis over the last block (um/s)
+  uint8_t zone[3];        // IsoZone per axis
+  uint8_t worst_zone;
+  uint32_t sequence;      // Increments per block
+  bool valid;
+};
+
+// Per-axis state: a high-pass section that sets the lower band edge, then a
+// leaky integrator. The integrator weights the newest and previous samples
+// 7:1 (Al-Alaoui) rather than 1:1 (trapezoid), which holds its gain within
+// 2% of 1/w up to a fifth of the sample rate, where the trapezoid is 14% low.
+// The leak keeps sensor offset and high-pass rounding from walking the
+// integral away without a second filter; its corner follows the high-pass
+// corner, VELOCITY_LEAK_RATIO below it, so it does not eat into the band.
+struct AxisVelocity {
+  AxisFilter highpass;
+  int32_t prev;           // Previous high-pass output
+  int64_t integral;       // Sum of (7 x[n] + x[n-1]), counts * 8 * fs * seconds
+  uint64_t sum_sq;        // Sum of v^2 over the block, (um/s)^2
+};
+
+// Band-limited velocity for every channel, computed per sample on the
+// processing task ahead of the window buffers. The lower band edge is the
+// high-pass corner (10 Hz per ISO 10816 by default); the upper edge is the
+// acquisition rate's anti-alias band. Each block of samples (one window in
+// tumbling mode, one hop in sliding mode) yields a velocity RMS per axis and
+// its severity zone for the selected machine class. All integer, so results
+// match bit for bit between boards.
+class VelocityMeter {
+private:
+  AxisVelocity axes[NUM_ACCEL_CHANNELS][3];
+  bool primed[NUM_ACCEL_CHANNELS];
+  uint16_t block_count[NUM_ACCEL_CHANNELS];
+  uint16_t block_samples;
+  uint16_t sample_rate_hz;
+  int32_t counts_per_g;
+  int64_t scale_q24;          // um/s per integral unit, Q24
+  uint8_t leak_shift;
+  uint8_t machine_class;
+  uint16_t highpass_hz;
+  bool highpass_active;       // False if the corner is not usable at this rate
+
+  // Requested settings (Modbus task), picked up by the processing task
+  volatile uint8_t requested_class;
+  volatile uint16_t requested_highpass_hz;
+  volatile bool settings_pending;
+
+  VelocityResult results[NUM_ACCEL_CHANNELS];
+  mutable portMUX_TYPE results_lock;
+
+  void applySettings();
+  void finishBlock(uint8_t channel);
+
+public:
+  VelocityMeter();
+
+  // Sampling task, under buffer_mutex: rate, scale or block length changed;
+  // redesigns and clears state
+  void configure(uint16_t sample_rate, int32_t counts_per_g, uint16_t block_length);
+
+  // Any task: machine class (0-7, see zoneFor) and high-pass corner
+  void setSettings(uint8_t machine_class, uint16_t highpass_hz);
+
+  // Processing task, once per batch under buffer_mutex: apply pending settings
+  inline void update() {
+    if (settings_pending) applySettings();
+  }
+
+  // Processing task: one sample of a channel, in counts
+  void processSample(uint8_t channel, int32_t x, int32_t y, int32_t z);
+
+  // Any task: copy of the latest result for a channel
+  bool getResult(uint8_t channel, VelocityResult& out) const;
+
+  uint8_t getMachineClass() const { return machine_class; }
+  uint16_t getHighpassHz() const { return highpass_hz; }
+
+  // Zone for an RMS velocity. Classes 0-3 are ISO 10816-1 classes I-IV;
+  // 4-7 are ISO 10816-3 group 1 rigid, group 1 flexible, group 2 rigid and
+  // group 2 flexible foundations.
+  static uint8_t zoneFor(uint32_t rms_um_s, uint8_t machine_class);
+
+  void printInfo() const;
+};
+
+extern VelocityMeter velocityMeter;
+
+#endif // VELOCITY_H
@@ -1,30 +1,48 @@
-#include "accelerometer_config.h"
-
-#ifdef USE_ADXL355
+#include "sensor_policy.h"
 
 #include <Arduino.h>
 #include <SPI.h>
 #include "adxl355.h"
 
-// Global ADXL355 instance
-static ADXL355 adxl355_sensor;
+// One ADXL355 per channel on the shared SPI bus; channel 0 is the reference
+ADXL355 adxl355_sensors[NUM_ACCEL_CHANNELS];
+ADXL355& adxl355_sensor = adxl355_sensors[0];
+uint8_t Adxl355Policy::channel_mask = 0;
+
+static const uint8_t channel_cs_pins[MAX_ACCEL_CHANNELS] = ADXL355_CS_PINS;
+
+bool Adxl355Policy::probe() {
+    return adxl355_sensor.probe(channel_cs_pins[0]);
+}
 
-bool accel_init() {
+bool Adxl355Policy::init() {
     Serial.println("Initializing ADXL355...");
     
-    if (!adxl355_sensor.begin()) {
+    channel_mask = 0;
+    for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+        Serial.printf("ADXL355 channel %d (CS GPIO %d)\n", ch, channel_cs_pins[ch]);
+        if (adxl355_sensors[ch].begin(channel_cs_pins[ch])) {
+            channel_mask |= (1 << ch);
+        } else {
+            Serial.printf("Failed to initialize ADXL355 channel %d!\n", ch);
+        }
+    }
+    
+    // Channel 0 paces acquisition; without it there is nothing to sample against
+    if (!(channel_mask & 0x01)) {
+        for (uint8_t ch = 1; ch < NUM_ACCEL_CHANNELS; ch++) {
+            adxl355_sensors[ch].end();
+        }
+        channel_mask = 0;
         Serial.println("Failed to initialize ADXL355!");
         return false;
     }
     
-    // Print device information
-    adxl355_sensor.printDeviceInfo();
-    
-    Serial.println("ADXL355 initialized successfully");
+    Serial.printf("ADXL355 initialized successfully (channel mask 0x%02X)\n", channel_mask);
     return true;
 }
 
-bool accel_read(AccelData& data) {
+bool Adxl355Policy::read(AccelData& data) {
     if (!adxl355_sensor.isInitialized()) {
         data.valid = false;
         return false;
@@ -37,23 +55,149 @@ bool accel_read(AccelData& data) {
     return true;
 }
 
-void accel_deinit() {
-    Serial.println("Deinitializing ADXL355...");
-    adxl355_sensor.end();
+bool Adxl355Policy::fifoBegin(uint8_t watermark_samples) {
+    if (!adxl355_sensor.isInitialized()) {
+        return false;
+    }
+    
+    // Started back-to-back so every channel's FIFO begins at the same sample
+    bool success = true;
+    for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+        if (channel_mask & (1 << ch)) {
+            success &= adxl355_sensors[ch].configureFifo(watermark_samples);
+        }
+    }
+    return success;
 }
 
-const char* accel_get_name() {
-    return "ADXL355";
+uint16_t Adxl355Policy::readBurstRaw(uint8_t channel, AccelRawData* samples, uint16_t max_samples, AccelBurstInfo& info) {
+    queueBurstRaw(channel, max_samples);
+    return collectBurstRaw(channel, samples, max_samples, info);
 }
 
-void accel_print_info() {
+void Adxl355Policy::queueBurstRaw(uint8_t channel, uint16_t max_samples) {
+    if (channel >= NUM_ACCEL_CHANNELS || !adxl355_sensors[channel].isInitialized()) {
+        return;
+    }
+    
+    if (max_samples > ADXL355_FIFO_MAX_SAMPLES) max_samples = ADXL355_FIFO_MAX_SAMPLES;
+    adxl355_sensors[channel].queueFifoRead(max_samples);
+}
+
+uint16_t Adxl355Policy::collectBurstRaw(uint8_t channel, AccelRawData* samples, uint16_t max_samples, AccelBurstInfo& info) {
+    info.fifo_entries = 0;
+    info.overrun = false;
+    
+    if (channel >= NUM_ACCEL_CHANNELS || !adxl355_sensors[channel].isInitialized()) {
+        return 0;
+    }
+    
+    // The queued drain was already capped to max_samples
+    (void)max_samples;
+    int32_t raw[ADXL355_FIFO_MAX_SAMPLES * 3];
+    uint16_t waiting = 0;
+    uint16_t count = adxl355_sensors[channel].collectFifoRead(raw, &info.overrun, &waiting);
+    info.fifo_entries = waiting > 0xFF ? 0xFF : waiting;
+    
+    for (uint16_t i = 0; i < count; i++) {
+        samples[i].x = raw[i * 3 + 0];
+        samples[i].y = raw[i * 3 + 1];
+        samples[i].z = raw[i * 3 + 2];
+        samples[i].valid = true;
+    }
+    
+    return count;
+}
+
+bool Adxl355Policy::dataReadyBegin(bool use_int1) {
+    if (!adxl355_sensor.isInitialized()) {
+        return false;
+    }
+    
+    // Only channel 0 is wired to the interrupt pin; the other channels are
+    // read in the same pass, right behind it
+    if (use_int1) {
+        // Route DATA_RDY to INT1, active high so both sources use a rising edge
+        adxl355_sensor.mapInterrupt1(INT_MAP_RDY_EN1, true);
+    } else {
+        adxl355_sensor.enableDataReadyPin(true);
+    }
+    
+    return true;
+}
+
+bool Adxl355Policy::configure(const AccelConfig& config) {
+    if (!adxl355_sensor.isInitialized()) {
+        return false;
+    }
+    
+    // Identical settings on every channel keep the ODRs and filter delays matched
+    for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+        if (!(channel_mask & (1 << ch))) {
+            continue;
+        }
+        ADXL355& sensor = adxl355_sensors[ch];
+        
+        if (!sensor.setRange(config.range_g)) {
+            Serial.printf("ADXL355: unsupported range %dg\n", config.range_g);
+            return false;
+        }
+        if (!sensor.setOutputDataRate(config.sample_rate_hz)) {
+            Serial.printf("ADXL355: unsupported sample rate %d Hz\n", config.sample_rate_hz);
+            return false;
+        }
+        if (!sensor.setHighPassCorner(config.hpf_corner)) {
+            Serial.printf("ADXL355: unsupported HPF corner %d\n", config.hpf_corner);
+            return false;
+        }
+    }
+    
+    Serial.printf("ADXL355 configured: ODR %d Hz, range ±%dg, HPF corner %d\n",
+                  adxl355_sensor.getOutputDataRate(), adxl355_sensor.getRange(),
+                  adxl355_sensor.getHighPassCorner());
+    return true;
+}
+
+float Adxl355Policy::getScaleFactor() {
+    return adxl355_sensor.getScaleFactor();
+}
+
+AccelScale Adxl355Policy::getScale() {
+    AccelScale scale;
+    scale.counts_per_g = (int32_t)adxl355_sensor.getScaleFactor();  // 256000 / 128000 / 64000
+    scale.resolution_bits = 20;
+    scale.range_g = adxl355_sensor.getRange();
+    return scale;
+}
+
+uint16_t Adxl355Policy::getSampleRate() {
+    return adxl355_sensor.getOutputDataRate();
+}
+
+AccelCapabilities Adxl355Policy::capabilities() {
+    // ODRs run from 3.906 Hz to 4 kHz; setOutputDataRate rounds up to the next one
+    AccelCapabilities caps = { OVERSAMPLE_MAX_RATE_HZ, 2 | 4 | 8, ADXL355_MAX_HPF_CORNER, 0 };
+    return caps;
+}
+
+void Adxl355Policy::deinit() {
+    Serial.println("Deinitializing ADXL355...");
+    for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+        adxl355_sensors[ch].end();
+    }
+    channel_mask = 0;
+}
+
+void Adxl355Policy::printInfo() {
     Serial.println("=== ADXL355 Information ===");
     Serial.println("Interface: SPI");
     Serial.println("Resolution: 20-bit");
-    Serial.println("Range: ±2g/±4g/±8g");
+    Serial.printf("Range: ±%dg (±2g/±4g/±8g supported)\n", adxl355_sensor.getRange());
     Serial.println("Noise: Ultra-low");
-    Serial.printf("Scale Factor: %.6f g/LSB\n", adxl355_sensor.getScaleFactor());
+    Serial.printf("Scale Factor: %.1f LSB/g\n", adxl355_sensor.getScaleFactor());
+    for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+        Serial.printf("Channel %d: CS GPIO %d, %s\n", ch, channel_cs_pins[ch],
+                      (channel_mask & (1 << ch)) ? "active" : "not found");
+    }
     Serial.println("============================");
 }
-
-#endif // USE_ADXL355
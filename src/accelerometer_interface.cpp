@@ -52,6 +52,83 @@ bool AccelerometerInterface::readData(AccelData& data) {
     return success;
 }
 
+bool AccelerometerInterface::readRaw(AccelRawData& data) {
+    if (!is_initialized) {
+        data.valid = false;
+        return false;
+    }
+    
+    // Hot path: no float conversion and no last_reading bookkeeping
+    return accel_read_raw(data);
+}
+
+bool AccelerometerInterface::beginFifo(uint8_t watermark_samples) {
+    if (!is_initialized) {
+        return false;
+    }
+    
+    return accel_fifo_begin(watermark_samples);
+}
+
+bool AccelerometerInterface::beginDataReady(bool use_int1) {
+    if (!is_initialized) {
+        return false;
+    }
+    
+    return accel_data_ready_begin(use_int1);
+}
+
+bool AccelerometerInterface::configure(const AccelConfig& config) {
+    if (!is_initialized) {
+        return false;
+    }
+    
+    return accel_configure(config);
+}
+
+float AccelerometerInterface::getScaleFactor() const {
+    return accel_get_scale_factor();
+}
+
+AccelScale AccelerometerInterface::getScale() const {
+    return accel_get_scale();
+}
+
+uint16_t AccelerometerInterface::getSampleRate() const {
+    return accel_get_sample_rate();
+}
+
+AccelCapabilities AccelerometerInterface::getCapabilities() const {
+    return accel_get_capabilities();
+}
+
+uint16_t AccelerometerInterface::readBurst(AccelData* samples, uint16_t max_samples, AccelBurstInfo& info) {
+    if (!is_initialized) {
+        info.fifo_entries = 0;
+        info.overrun = false;
+        return 0;
+    }
+    
+    uint16_t count = accel_read_burst(samples, max_samples, info);
+    
+    if (count > 0) {
+        last_reading = samples[count - 1];
+        last_read_time = millis();
+    }
+    
+    return count;
+}
+
+uint16_t AccelerometerInterface::readBurstRaw(AccelRawData* samples, uint16_t max_samples, AccelBurstInfo& info) {
+    if (!is_initialized) {
+        info.fifo_entries = 0;
+        info.overrun = false;
+        return 0;
+    }
+    
+    return accel_read_burst_raw(samples, max_samples, info);
+}
+
 const char* AccelerometerInterface::getSensorName() const {
     return accel_get_name();
 }
@@ -63,16 +140,12 @@ void AccelerometerInterface::printSensorInfo() const {
 void AccelerometerInterface::printBuildInfo() const {
     Serial.println("=== Build Configuration ===");
     
-    #ifdef USE_ADXL355
-        Serial.println("Accelerometer: ADXL355 (SPI)");
-        Serial.println("Precision: High (20-bit)");
-        Serial.println("Power: Ultra-low noise");
-    #endif
-    
-    #ifdef USE_MPU6050
-        Serial.println("Accelerometer: MPU6050 (I2C)");
-        Serial.println("Precision: Standard (16-bit)");
-        Serial.println("Features: 6-axis (accel + gyro)");
+    #if defined(USE_ADXL355)
+        Serial.println("Accelerometer: ADXL355 (SPI, forced)");
+    #elif defined(USE_MPU6050)
+        Serial.println("Accelerometer: MPU6050 (I2C, forced)");
+    #else
+        Serial.println("Accelerometer: autodetect (ADXL355 SPI, MPU6050 I2C)");
     #endif
     
     Serial.printf("Compiled: %s %s\n", __DATE__, __TIME__);
@@ -1,22 +1,22 @@
-#include "accelerometer_config.h"
-
-#ifdef USE_MPU6050
+#include "sensor_policy.h"
 
 #include <Arduino.h>
 #include <Wire.h>
-#include <Adafruit_MPU6050.h>
-#include <Adafruit_Sensor.h>
+#include "mpu6050.h"
 
 // Global MPU6050 instance
-static Adafruit_MPU6050 mpu6050_sensor;
-static bool initialized = false;
+MPU6050 mpu6050_sensor;
+
+bool Mpu6050Policy::probe() {
+    return mpu6050_sensor.probe();
+}
 
-bool accel_init() {
+bool Mpu6050Policy::init() {
     Serial.println("Initializing MPU6050...");
     
     // Initialize I2C with explicit pins (SDA=21, SCL=22 are ESP32 defaults)
     Serial.println("Attempting I2C initialization on default pins (SDA=21, SCL=22)...");
-    if (!Wire.begin(21, 22)) {  // SDA=21, SCL=22
+    if (!Wire.begin(MPU6050_SDA_PIN, MPU6050_SCL_PIN, MPU6050_I2C_FREQUENCY)) {
         Serial.println("Failed to initialize I2C!");
         return false;
     }
@@ -53,57 +53,132 @@ bool accel_init() {
         return false;
     }
     
-    // Configure MPU6050 settings
-    mpu6050_sensor.setAccelerometerRange(MPU6050_RANGE_2_G);      // ±2g range (same as ADXL355 default)
-    mpu6050_sensor.setGyroRange(MPU6050_RANGE_250_DEG);           // ±250°/s (not used for accelerometer)
-    mpu6050_sensor.setFilterBandwidth(MPU6050_BAND_21_HZ);        // 21 Hz low-pass filter
-    
-    initialized = true;
-    Serial.println("MPU6050 initialized successfully");
+    // Register-level driver: ±2g, DLPF 21 Hz, gyro in standby
     return true;
 }
 
-bool accel_read(AccelData& data) {
-    if (!initialized) {
+bool Mpu6050Policy::read(AccelData& data) {
+    if (!mpu6050_sensor.isInitialized()) {
         data.valid = false;
         return false;
     }
     
-    sensors_event_t accel, gyro, temp;
-    
-    if (!mpu6050_sensor.getEvent(&accel, &gyro, &temp)) {
+    // Single 6-byte accel burst instead of the 14-byte accel/temp/gyro event
+    if (!mpu6050_sensor.readAcceleration(data.x, data.y, data.z)) {
         data.valid = false;
         return false;
     }
     
-    // Convert from m/s² to g-force (1g = 9.80665 m/s²)
-    data.x = accel.acceleration.x / 9.80665f;
-    data.y = accel.acceleration.y / 9.80665f;
-    data.z = accel.acceleration.z / 9.80665f;
     data.valid = true;
+    return true;
+}
+
+bool Mpu6050Policy::fifoBegin(uint8_t watermark_samples) {
+    // The MPU6050 FIFO has no usable watermark; the sampler drains it on a timer
+    (void)watermark_samples;
+    if (!mpu6050_sensor.isInitialized()) {
+        return false;
+    }
+    return mpu6050_sensor.configureFifo();
+}
+
+uint16_t Mpu6050Policy::readBurstRaw(uint8_t channel, AccelRawData* samples, uint16_t max_samples, AccelBurstInfo& info) {
+    info.fifo_entries = 0;
+    info.overrun = false;
     
+    if (channel != 0 || !mpu6050_sensor.isInitialized()) {
+        return 0;
+    }
+    
+    int32_t raw[ACCEL_MAX_BURST_SAMPLES * 3];
+    if (max_samples > ACCEL_MAX_BURST_SAMPLES) max_samples = ACCEL_MAX_BURST_SAMPLES;
+    
+    uint16_t waiting = 0;
+    uint16_t count = mpu6050_sensor.readFifo(raw, max_samples, &info.overrun, &waiting);
+    info.fifo_entries = waiting > 0xFF ? 0xFF : waiting;
+    
+    for (uint16_t i = 0; i < count; i++) {
+        samples[i].x = raw[i * 3 + 0];
+        samples[i].y = raw[i * 3 + 1];
+        samples[i].z = raw[i * 3 + 2];
+        samples[i].valid = true;
+    }
+    
+    return count;
+}
+
+bool Mpu6050Policy::dataReadyBegin(bool use_int1) {
+    // The MPU6050 has a single INT output, wired to DRDY_PIN
+    if (!mpu6050_sensor.isInitialized() || use_int1) {
+        return false;
+    }
+    
+    mpu6050_sensor.enableDataReadyInterrupt(true);
     return true;
 }
 
-void accel_deinit() {
-    Serial.println("Deinitializing MPU6050...");
-    initialized = false;
-    // MPU6050 doesn't need explicit cleanup, but we can put it in sleep mode
-    // This would require direct register access if needed
+bool Mpu6050Policy::configure(const AccelConfig& config) {
+    if (!mpu6050_sensor.isInitialized()) {
+        return false;
+    }
+    
+    if (!mpu6050_sensor.setRange(config.range_g)) {
+        Serial.printf("MPU6050: unsupported range %dg\n", config.range_g);
+        return false;
+    }
+    
+    // The DLPF sets the internal rate the divider works from, so it goes first
+    if (!mpu6050_sensor.setDlpf(config.lpf_code)) {
+        Serial.printf("MPU6050: unsupported DLPF setting %d\n", config.lpf_code);
+        return false;
+    }
+    
+    // With the DLPF enabled the internal rate is 1 kHz: rate = 1000 / (1 + divider)
+    if (!mpu6050_sensor.setSampleRate(config.sample_rate_hz)) {
+        Serial.printf("MPU6050: unsupported sample rate %d Hz\n", config.sample_rate_hz);
+        return false;
+    }
+    
+    // The accelerometer path has no high-pass filter; hpf_corner is ignored
+    Serial.printf("MPU6050 configured: rate %d Hz, range ±%dg, DLPF %d\n",
+                  mpu6050_sensor.getSampleRate(), mpu6050_sensor.getRange(), mpu6050_sensor.getDlpf());
+    return true;
+}
+
+float Mpu6050Policy::getScaleFactor() {
+    return mpu6050_sensor.getScaleFactor();
 }
 
-const char* accel_get_name() {
-    return "MPU6050";
+AccelScale Mpu6050Policy::getScale() {
+    AccelScale scale;
+    scale.counts_per_g = (int32_t)mpu6050_sensor.getScaleFactor();  // 16384 / 8192 / 4096 / 2048
+    scale.resolution_bits = 16;
+    scale.range_g = mpu6050_sensor.getRange();
+    return scale;
 }
 
-void accel_print_info() {
+uint16_t Mpu6050Policy::getSampleRate() {
+    return mpu6050_sensor.getSampleRate();
+}
+
+AccelCapabilities Mpu6050Policy::capabilities() {
+    // No high-pass filter on the accelerometer path; DLPF_CFG 7 is reserved
+    AccelCapabilities caps = { MPU6050_MAX_RATE_HZ, 2 | 4 | 8 | 16, 0, 6 };
+    return caps;
+}
+
+void Mpu6050Policy::deinit() {
+    Serial.println("Deinitializing MPU6050...");
+    mpu6050_sensor.end();
+}
+
+void Mpu6050Policy::printInfo() {
     Serial.println("=== MPU6050 Information ===");
     Serial.println("Interface: I2C");
     Serial.println("Resolution: 16-bit");
-    Serial.println("Range: ±2g (configured)");
-    Serial.println("Features: 6-axis (accel + gyro)");
-    Serial.println("Scale Factor: 16384 LSB/g");
+    Serial.printf("Range: ±%dg (configured)\n", mpu6050_sensor.getRange());
+    Serial.printf("DLPF: %d, Sample Rate: %d Hz\n", mpu6050_sensor.getDlpf(), mpu6050_sensor.getSampleRate());
+    Serial.println("Features: accelerometer only (gyro in standby), FIFO, data-ready");
+    Serial.printf("Scale Factor: %.0f LSB/g\n", getScaleFactor());
     Serial.println("============================");
 }
-
-#endif // USE_MPU6050
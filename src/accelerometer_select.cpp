@@ -0,0 +1,183 @@
+#include "sensor_policy.h"
+#include <Arduino.h>
+
+// Runtime front end for the sensor policies. Only setup, configuration and
+// diagnostics go through here; the sampling task calls the policy directly.
+
+static AccelSensorType active_sensor = ACCEL_SENSOR_NONE;
+
+static AccelSensorType detectSensor() {
+    #if defined(USE_ADXL355)
+    return ACCEL_SENSOR_ADXL355;
+    #elif defined(USE_MPU6050)
+    return ACCEL_SENSOR_MPU6050;
+    #else
+    Serial.println("Probing for accelerometer...");
+    if (Adxl355Policy::probe()) {
+        Serial.println("ADXL355 found on SPI");
+        return ACCEL_SENSOR_ADXL355;
+    }
+    if (Mpu6050Policy::probe()) {
+        Serial.println("MPU6050 found on I2C");
+        return ACCEL_SENSOR_MPU6050;
+    }
+    Serial.println("No supported accelerometer found");
+    return ACCEL_SENSOR_NONE;
+    #endif
+}
+
+bool accel_init() {
+    AccelSensorType detected = detectSensor();
+    bool success = false;
+    
+    switch (detected) {
+        case ACCEL_SENSOR_ADXL355: success = Adxl355Policy::init(); break;
+        case ACCEL_SENSOR_MPU6050: success = Mpu6050Policy::init(); break;
+        default: break;
+    }
+    
+    active_sensor = success ? detected : ACCEL_SENSOR_NONE;
+    return success;
+}
+
+AccelSensorType accel_get_type() {
+    return active_sensor;
+}
+
+uint8_t accel_get_channel_mask() {
+    switch (active_sensor) {
+        case ACCEL_SENSOR_ADXL355: return Adxl355Policy::channelMask();
+        case ACCEL_SENSOR_MPU6050: return Mpu6050Policy::channelMask();
+        default: return 0;
+    }
+}
+
+bool accel_read(AccelData& data) {
+    switch (active_sensor) {
+        case ACCEL_SENSOR_ADXL355: return Adxl355Policy::read(data);
+        case ACCEL_SENSOR_MPU6050: return Mpu6050Policy::read(data);
+        default:
+            data.valid = false;
+            return false;
+    }
+}
+
+bool accel_read_raw(AccelRawData& data) {
+    switch (active_sensor) {
+        case ACCEL_SENSOR_ADXL355: return Adxl355Policy::readRaw(0, data);
+        case ACCEL_SENSOR_MPU6050: return Mpu6050Policy::readRaw(0, data);
+        default: return NoSensorPolicy::readRaw(0, data);
+    }
+}
+
+bool accel_fifo_begin(uint8_t watermark_samples) {
+    switch (active_sensor) {
+        case ACCEL_SENSOR_ADXL355: return Adxl355Policy::fifoBegin(watermark_samples);
+        case ACCEL_SENSOR_MPU6050: return Mpu6050Policy::fifoBegin(watermark_samples);
+        default: return false;
+    }
+}
+
+uint16_t accel_read_burst_raw(AccelRawData* samples, uint16_t max_samples, AccelBurstInfo& info) {
+    switch (active_sensor) {
+        case ACCEL_SENSOR_ADXL355: return Adxl355Policy::readBurstRaw(0, samples, max_samples, info);
+        case ACCEL_SENSOR_MPU6050: return Mpu6050Policy::readBurstRaw(0, samples, max_samples, info);
+        default: return NoSensorPolicy::readBurstRaw(0, samples, max_samples, info);
+    }
+}
+
+uint16_t accel_read_burst(AccelData* samples, uint16_t max_samples, AccelBurstInfo& info) {
+    AccelRawData raw[ACCEL_MAX_BURST_SAMPLES];
+    if (max_samples > ACCEL_MAX_BURST_SAMPLES) max_samples = ACCEL_MAX_BURST_SAMPLES;
+    
+    uint16_t count = accel_read_burst_raw(raw, max_samples, info);
+    
+    const float scale_factor = accel_get_scale_factor();
+    for (uint16_t i = 0; i < count; i++) {
+        samples[i].x = (float)raw[i].x / scale_factor;
+        samples[i].y = (float)raw[i].y / scale_factor;
+        samples[i].z = (float)raw[i].z / scale_factor;
+        samples[i].valid = true;
+    }
+    
+    return count;
+}
+
+bool accel_data_ready_begin(bool use_int1) {
+    switch (active_sensor) {
+        case ACCEL_SENSOR_ADXL355: return Adxl355Policy::dataReadyBegin(use_int1);
+        case ACCEL_SENSOR_MPU6050: return Mpu6050Policy::dataReadyBegin(use_int1);
+        default: return false;
+    }
+}
+
+bool accel_configure(const AccelConfig& config) {
+    switch (active_sensor) {
+        case ACCEL_SENSOR_ADXL355: return Adxl355Policy::configure(config);
+        case ACCEL_SENSOR_MPU6050: return Mpu6050Policy::configure(config);
+        default: return false;
+    }
+}
+
+float accel_get_scale_factor() {
+    switch (active_sensor) {
+        case ACCEL_SENSOR_ADXL355: return Adxl355Policy::getScaleFactor();
+        case ACCEL_SENSOR_MPU6050: return Mpu6050Policy::getScaleFactor();
+        default: return ADXL355_SCALE_2G;
+    }
+}
+
+AccelScale accel_get_scale() {
+    switch (active_sensor) {
+        case ACCEL_SENSOR_ADXL355: return Adxl355Policy::getScale();
+        case ACCEL_SENSOR_MPU6050: return Mpu6050Policy::getScale();
+        default: {
+            AccelScale scale = { (int32_t)ADXL355_SCALE_2G, 20, 2 };
+            return scale;
+        }
+    }
+}
+
+uint16_t accel_get_sample_rate() {
+    switch (active_sensor) {
+        case ACCEL_SENSOR_ADXL355: return Adxl355Policy::getSampleRate();
+        case ACCEL_SENSOR_MPU6050: return Mpu6050Policy::getSampleRate();
+        default: return 0;
+    }
+}
+
+AccelCapabilities accel_get_capabilities() {
+    switch (active_sensor) {
+        case ACCEL_SENSOR_ADXL355: return Adxl355Policy::capabilities();
+        case ACCEL_SENSOR_MPU6050: return Mpu6050Policy::capabilities();
+        default: {
+            AccelCapabilities none = { 0, 0, 0, 0 };
+            return none;
+        }
+    }
+}
+
+void accel_deinit() {
+    switch (active_sensor) {
+        case ACCEL_SENSOR_ADXL355: Adxl355Policy::deinit(); break;
+        case ACCEL_SENSOR_MPU6050: Mpu6050Policy::deinit(); break;
+        default: break;
+    }
+    active_sensor = ACCEL_SENSOR_NONE;
+}
+
+const char* accel_get_name() {
+    switch (active_sensor) {
+        case ACCEL_SENSOR_ADXL355: return Adxl355Policy::name();
+        case ACCEL_SENSOR_MPU6050: return Mpu6050Policy::name();
+        default: return "none";
+    }
+}
+
+void accel_print_info() {
+    switch (active_sensor) {
+        case ACCEL_SENSOR_ADXL355: Adxl355Policy::printInfo(); break;
+        case ACCEL_SENSOR_MPU6050: Mpu6050Policy::printInfo(); break;
+        default: Serial.println("No accelerometer active"); break;
+    }
+}
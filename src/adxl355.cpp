@@ -1,30 +1,104 @@
 #include "adxl355.h"
 
-ADXL355::ADXL355() : initialized(false) {
+// ODR_LPF codes 0..10 in mHz (4000 Hz down to 3.906 Hz)
+static const uint32_t odr_table_mhz[] = {
+  4000000, 2000000, 1000000, 500000, 250000, 125000,
+  62500, 31250, 15625, 7813, 3906
+};
+static const uint8_t odr_table_size = sizeof(odr_table_mhz) / sizeof(odr_table_mhz[0]);
+
+// VDD is shared by every channel: power-cycle once, not once per sensor
+bool ADXL355::power_sequenced = false;
+
+#if ADXL355_SPI_TRANSPORT != SPI_TRANSPORT_IDF_DMA
+// Channels sharing the Arduino SPI instance
+static uint8_t spi_users = 0;
+#endif
+
+ADXL355::ADXL355() : initialized(false), cs_pin(CS_PIN), power_ctl(POWER_CTL_STANDBY), range_g(2),
+                     odr_code(0), hpf_corner(0), fifo_overruns(0), fifo_realignments(0), fifo_overrun_pending(false),
+                     fifo_waiting(0), fifo_queued(0), fifo_carry_entries(0) {
+  #if ADXL355_SPI_TRANSPORT != SPI_TRANSPORT_IDF_DMA
+  fifo_bytes = 0;
+  #endif
 }
 
-bool ADXL355::begin() {
+bool ADXL355::startBus() {
   // Set MOSI low initially
   pinMode(MOSI_PIN, OUTPUT);
   digitalWrite(MOSI_PIN, LOW);
 
   // Power sequencing
-  pinMode(POWER_EN, OUTPUT);
-  digitalWrite(POWER_EN, LOW);
-  delay(100);
-  digitalWrite(POWER_EN, HIGH);
-  delay(100);
+  if (!power_sequenced) {
+    pinMode(POWER_EN, OUTPUT);
+    digitalWrite(POWER_EN, LOW);
+    delay(100);
+    digitalWrite(POWER_EN, HIGH);
+    delay(100);
+    power_sequenced = true;
+  }
 
   // Initialize SPI
-  pinMode(CS_PIN, OUTPUT);
-  digitalWrite(CS_PIN, HIGH);
-  SPI.begin(SCLK_PIN, MISO_PIN, MOSI_PIN, CS_PIN);
-  SPI.beginTransaction(SPISettings(SPI_FREQUENCY, MSBFIRST, SPI_MODE));
+  #if ADXL355_SPI_TRANSPORT == SPI_TRANSPORT_IDF_DMA
+  if (!transport.begin(ADXL355_SPI_HOST, cs_pin, SPI_DMA_FREQUENCY)) {
+    return false;
+  }
+  #else
+  pinMode(cs_pin, OUTPUT);
+  digitalWrite(cs_pin, HIGH);
+  if (spi_users++ == 0) {
+    SPI.begin(SCLK_PIN, MISO_PIN, MOSI_PIN, -1);  // CS is driven per channel
+    SPI.beginTransaction(SPISettings(SPI_FREQUENCY, MSBFIRST, SPI_MODE));
+  }
+  #endif
+  
+  return true;
+}
+
+void ADXL355::stopBus() {
+  #if ADXL355_SPI_TRANSPORT == SPI_TRANSPORT_IDF_DMA
+  transport.end();
+  #else
+  if (spi_users > 0 && --spi_users == 0) {
+    SPI.end();
+  }
+  #endif
+}
+
+bool ADXL355::probe(uint8_t cs) {
+  // ID registers only; the bus is released again so another sensor can be tried
+  cs_pin = cs;
+  if (!startBus()) {
+    return false;
+  }
+  bool found = checkDeviceID();
+  stopBus();
+  return found;
+}
+
+bool ADXL355::begin(uint8_t cs) {
+  cs_pin = cs;
+  if (!startBus()) {
+    Serial.println("ADXL355 initialization failed - SPI transport");
+    return false;
+  }
 
   // Initialize ADXL355
   writeRegister(POWER_CTL, 0x00);  // Reset
   delay(50);
-  writeRegister(POWER_CTL, 0x06);  // Enable measurement mode
+  
+  // Pick up the power-on FILTER/RANGE defaults so the scale factor matches
+  uint8_t filter = readRegister(FILTER);
+  odr_code = filter & FILTER_ODR_MASK;
+  if (odr_code >= odr_table_size) odr_code = 0;
+  hpf_corner = (filter & FILTER_HPF_MASK) >> FILTER_HPF_SHIFT;
+  switch (readRegister(RANGE) & RANGE_MASK) {
+    case 0x02: range_g = 4; break;
+    case 0x03: range_g = 8; break;
+    default:   range_g = 2; break;
+  }
+  power_ctl = POWER_CTL_TEMP_OFF | POWER_CTL_DRDY_OFF;
+  writeRegister(POWER_CTL, power_ctl);  // Enable measurement mode
   delay(50);
 
   // Verify device ID
@@ -36,6 +110,7 @@ bool ADXL355::begin() {
     return true;
   } else {
     Serial.println("ADXL355 initialization failed - wrong device ID");
+    stopBus();
     return false;
   }
 }
@@ -43,36 +118,56 @@ bool ADXL355::begin() {
 void ADXL355::end() {
   if (initialized) {
     writeRegister(POWER_CTL, 0x01);  // Standby mode
-    SPI.end();
+    stopBus();
     initialized = false;
   }
 }
 
 void ADXL355::writeRegister(uint8_t reg, uint8_t value) {
-  digitalWrite(CS_PIN, LOW);
+  #if ADXL355_SPI_TRANSPORT == SPI_TRANSPORT_IDF_DMA
+  transport.writeRegister(reg, value);
+  #else
+  digitalWrite(cs_pin, LOW);
   SPI.transfer((reg << 1) | 0x00);  // Write command
   SPI.transfer(value);
-  digitalWrite(CS_PIN, HIGH);
+  digitalWrite(cs_pin, HIGH);
+  #endif
 }
 
 uint8_t ADXL355::readRegister(uint8_t reg) {
-  digitalWrite(CS_PIN, LOW);
+  #if ADXL355_SPI_TRANSPORT == SPI_TRANSPORT_IDF_DMA
+  return transport.readRegister(reg);
+  #else
+  digitalWrite(cs_pin, LOW);
   SPI.transfer((reg << 1) | 0x01);  // Read command
   uint8_t value = SPI.transfer(0x00);
-  digitalWrite(CS_PIN, HIGH);
+  digitalWrite(cs_pin, HIGH);
   return value;
+  #endif
 }
 
 void ADXL355::readXYZ(int32_t &x, int32_t &y, int32_t &z) {
   uint8_t buffer[9];
   
   // Read all 9 bytes (3 axes * 3 bytes each) in one transaction
-  digitalWrite(CS_PIN, LOW);
+  #if ADXL355_SPI_TRANSPORT == SPI_TRANSPORT_IDF_DMA
+  // Start at FIFO_ENTRIES so the block is three words: FIFO_ENTRIES and
+  // TEMP2/TEMP1 read without side effects, while padding past ZDATA1 would
+  // pop FIFO_DATA
+  uint8_t block[12];
+  if (transport.readRegisters(FIFO_ENTRIES, block, sizeof(block))) {
+    memcpy(buffer, &block[XDATA3 - FIFO_ENTRIES], sizeof(buffer));
+  } else {
+    memset(buffer, 0, sizeof(buffer));
+  }
+  #else
+  digitalWrite(cs_pin, LOW);
   SPI.transfer((XDATA3 << 1) | 0x01);  // Read command for XDATA3
   for (int i = 0; i < 9; i++) {
     buffer[i] = SPI.transfer(0x00);
   }
-  digitalWrite(CS_PIN, HIGH);
+  digitalWrite(cs_pin, HIGH);
+  #endif
 
   #if ENABLE_VERBOSE_DEBUG
   static unsigned long last_spi_debug = 0;
@@ -124,9 +219,8 @@ void ADXL355::readAcceleration(float &x_g, float &y_g, float &z_g) {
   int32_t x_raw, y_raw, z_raw;
   readXYZ(x_raw, y_raw, z_raw);
   
-  // ADXL355 ±2g range: Corrected scale factor based on observed values
-  // Values were ~250,000x too large, so use much larger scale factor
-  static const float scale_factor = 256000.0f;  // Corrected scale factor (was 65536000.0f)
+  // Scale factor follows the configured range (256000 LSB/g at ±2g)
+  const float scale_factor = getScaleFactor();
   
   x_g = (float)x_raw / scale_factor;
   y_g = (float)y_raw / scale_factor;
@@ -152,6 +246,186 @@ void ADXL355::readAcceleration(float &x_g, float &y_g, float &z_g) {
   #endif
 }
 
+int32_t ADXL355::convertSample(const uint8_t* bytes) {
+  // 20-bit left-justified value: DATA3[7:0] DATA2[7:0] DATA1[7:4]
+  int32_t value = ((int32_t)bytes[0] << 12) | ((int32_t)bytes[1] << 4) | (bytes[2] >> 4);
+  if (value & 0x80000) value |= 0xFFF00000;
+  return value;
+}
+
+bool ADXL355::configureFifo(uint8_t watermark_samples) {
+  if (watermark_samples == 0 || watermark_samples > ADXL355_FIFO_MAX_SAMPLES) {
+    return false;
+  }
+  
+  // Watermark is expressed in FIFO entries (one entry per axis)
+  writeRegister(FIFO_SAMPLES, watermark_samples * 3);
+  
+  // Flush stale entries so the first drain starts on an X-axis boundary
+  int32_t discard[ADXL355_FIFO_MAX_SAMPLES * 3];
+  readFifo(discard, ADXL355_FIFO_MAX_SAMPLES);
+  fifo_carry_entries = 0;
+  readStatus();  // Clears a latched FIFO_OVR from before configuration
+  fifo_overruns = 0;
+  fifo_realignments = 0;
+  
+  #if ENABLE_DEBUG_OUTPUT
+  Serial.printf("[ADXL355] FIFO configured: watermark %d samples\n", watermark_samples);
+  #endif
+  
+  return true;
+}
+
+uint8_t ADXL355::readStatus() {
+  return readRegister(STATUS);
+}
+
+uint8_t ADXL355::getFifoEntries() {
+  return readRegister(FIFO_ENTRIES) & 0x7F;
+}
+
+uint16_t ADXL355::readFifo(int32_t* xyz, uint16_t max_samples, bool* overrun, uint16_t* waiting) {
+  // With nothing queued the collect only reports the status
+  queueFifoRead(max_samples);
+  return collectFifoRead(xyz, overrun, waiting);
+}
+
+bool ADXL355::queueFifoRead(uint16_t max_samples) {
+  fifo_queued = 0;
+  
+  uint8_t status = readStatus();
+  if (status & STATUS_FIFO_OVR) {
+    fifo_overruns++;
+    fifo_overrun_pending = true;
+  }
+  
+  // Only drain complete XYZ sets; partial sets stay in the FIFO for next time.
+  // Entries carried over from the last drain count towards the first set.
+  // The fill level is kept before capping so callers see how full it got
+  uint16_t available = getFifoEntries() + fifo_carry_entries;
+  uint16_t samples = available / 3;
+  fifo_waiting = samples;
+  if (samples > max_samples) samples = max_samples;
+  if (samples > ADXL355_FIFO_MAX_SAMPLES) samples = ADXL355_FIFO_MAX_SAMPLES;
+  if (samples == 0) {
+    return false;
+  }
+  
+  uint16_t entries = samples * 3 - fifo_carry_entries;
+  
+  // FIFO_DATA does not auto-increment, so one burst pulls successive entries
+  #if ADXL355_SPI_TRANSPORT == SPI_TRANSPORT_IDF_DMA
+  // Whole entries only, rounded up to a DMA word boundary (4 entries = 3
+  // words). The extra entries are the start of the next sample, or empty
+  // markers if it has not arrived; collectFifoRead keeps the former.
+  entries = (entries + ADXL355_SPI_DMA_ALIGN - 1) & ~(uint16_t)(ADXL355_SPI_DMA_ALIGN - 1);
+  if (entries > ADXL355_FIFO_DEPTH) entries = ADXL355_FIFO_DEPTH;
+  if (!transport.queueBurstRead(FIFO_DATA, entries * 3)) {
+    return false;
+  }
+  #else
+  uint16_t bytes = entries * 3;
+  digitalWrite(cs_pin, LOW);
+  SPI.transfer((FIFO_DATA << 1) | 0x01);  // Read command for FIFO_DATA
+  for (uint16_t i = 0; i < bytes; i++) {
+    fifo_buffer[i] = SPI.transfer(0x00);
+  }
+  digitalWrite(cs_pin, HIGH);
+  fifo_bytes = bytes;
+  #endif
+  
+  fifo_queued = samples;
+  return true;
+}
+
+const uint8_t* ADXL355::fifoEntry(const uint8_t* buffer, uint16_t entry) const {
+  // Carried entries come before the ones just read
+  if (entry < fifo_carry_entries) {
+    return &fifo_carry[entry * 3];
+  }
+  return &buffer[(entry - fifo_carry_entries) * 3];
+}
+
+uint16_t ADXL355::collectFifoRead(int32_t* xyz, bool* overrun, uint16_t* waiting) {
+  if (overrun) *overrun = fifo_overrun_pending;
+  if (waiting) *waiting = fifo_waiting;
+  fifo_overrun_pending = false;
+  
+  uint16_t bytes = 0;
+  #if ADXL355_SPI_TRANSPORT == SPI_TRANSPORT_IDF_DMA
+  const uint8_t* buffer = transport.collectBurstRead(bytes);
+  #else
+  const uint8_t* buffer = fifo_buffer;
+  bytes = fifo_bytes;
+  fifo_bytes = 0;
+  #endif
+  if (!buffer || bytes == 0) {
+    return 0;
+  }
+  
+  // Walk entries, resynchronising on the X-axis marker if the stream slipped
+  uint16_t entries = fifo_carry_entries + bytes / 3;
+  uint16_t count = 0;
+  uint16_t entry = 0;
+  while (entry + 3 <= entries && count < fifo_queued) {
+    const uint8_t* e = fifoEntry(buffer, entry);
+    if (e[2] & FIFO_EMPTY_MARKER) {
+      entry++;  // Padding read while the FIFO was dry
+      continue;
+    }
+    if (!(e[2] & FIFO_X_MARKER)) {
+      fifo_realignments++;
+      entry++;
+      continue;
+    }
+    
+    xyz[count * 3 + 0] = convertSample(e);
+    xyz[count * 3 + 1] = convertSample(fifoEntry(buffer, entry + 1));
+    xyz[count * 3 + 2] = convertSample(fifoEntry(buffer, entry + 2));
+    count++;
+    entry += 3;
+  }
+  
+  // Entries read past the last whole sample are no longer in the FIFO; keep
+  // them for the next drain. Data can land mid-burst, so skip empty markers
+  // rather than stopping at the first one
+  uint8_t carry[sizeof(fifo_carry)];
+  uint8_t kept = 0;
+  while (entry < entries && kept < 3) {
+    const uint8_t* e = fifoEntry(buffer, entry++);
+    if (!(e[2] & FIFO_EMPTY_MARKER)) {
+      memcpy(&carry[kept * 3], e, 3);
+      kept++;
+    }
+  }
+  memcpy(fifo_carry, carry, kept * 3);
+  fifo_carry_entries = kept;
+  fifo_queued = 0;
+  
+  return count;
+}
+
+void ADXL355::enableDataReadyPin(bool enable) {
+  // DRDY_OFF is set at boot; clearing it drives the DRDY pin high on each new sample
+  if (enable) {
+    power_ctl &= ~POWER_CTL_DRDY_OFF;
+  } else {
+    power_ctl |= POWER_CTL_DRDY_OFF;
+  }
+  writeRegister(POWER_CTL, power_ctl);
+}
+
+void ADXL355::mapInterrupt1(uint8_t int_map, bool active_high) {
+  uint8_t range = readRegister(RANGE);
+  if (active_high) {
+    range |= RANGE_INT_POL;
+  } else {
+    range &= ~RANGE_INT_POL;
+  }
+  writeRegister(RANGE, range);
+  writeRegister(INT_MAP, int_map);
+}
+
 bool ADXL355::checkDeviceID() {
   uint8_t devid_ad = readRegister(DEVID_AD);
   uint8_t partid = readRegister(PARTID);
@@ -170,6 +444,67 @@ void ADXL355::printDeviceInfo() {
 }
 
 float ADXL355::getScaleFactor() const {
-  // Return the same scale factor used in readAcceleration
-  return 256000.0f;  // Corrected scale factor (was 65536000.0f)
+  // 20-bit output: 256000 LSB/g at ±2g, 128000 at ±4g, 64000 at ±8g
+  return ADXL355_SCALE_2G / (range_g / 2);
+}
+
+bool ADXL355::setRange(uint8_t range) {
+  uint8_t code;
+  switch (range) {
+    case 2: code = 0x01; break;
+    case 4: code = 0x02; break;
+    case 8: code = 0x03; break;
+    default: return false;
+  }
+  
+  // Range changes are only applied reliably in standby
+  writeRegister(POWER_CTL, power_ctl | POWER_CTL_STANDBY);
+  uint8_t value = readRegister(RANGE);
+  writeRegister(RANGE, (value & ~RANGE_MASK) | code);
+  writeRegister(POWER_CTL, power_ctl);
+  
+  range_g = range;
+  return true;
+}
+
+bool ADXL355::setOutputDataRate(uint16_t rate_hz) {
+  if (rate_hz == 0) {
+    return false;
+  }
+  
+  // Pick the slowest ODR that still meets the requested rate
+  uint32_t requested_mhz = (uint32_t)rate_hz * 1000;
+  if (requested_mhz > odr_table_mhz[0]) {
+    return false;
+  }
+  uint8_t code = 0;
+  for (uint8_t i = 0; i < odr_table_size; i++) {
+    if (odr_table_mhz[i] >= requested_mhz) {
+      code = i;
+    }
+  }
+  
+  writeRegister(POWER_CTL, power_ctl | POWER_CTL_STANDBY);
+  writeRegister(FILTER, (hpf_corner << FILTER_HPF_SHIFT) | code);
+  writeRegister(POWER_CTL, power_ctl);
+  
+  odr_code = code;
+  return true;
+}
+
+bool ADXL355::setHighPassCorner(uint8_t corner) {
+  if (corner > ADXL355_MAX_HPF_CORNER) {
+    return false;
+  }
+  
+  writeRegister(POWER_CTL, power_ctl | POWER_CTL_STANDBY);
+  writeRegister(FILTER, (corner << FILTER_HPF_SHIFT) | odr_code);
+  writeRegister(POWER_CTL, power_ctl);
+  
+  hpf_corner = corner;
+  return true;
+}
+
+uint16_t ADXL355::getOutputDataRate() const {
+  return (uint16_t)((odr_table_mhz[odr_code] + 500) / 1000);
 }
@@ -0,0 +1,184 @@
+#include "adxl355_spi.h"
+#include "esp_heap_caps.h"
+
+uint8_t ADXL355SpiTransport::bus_users[3] = {0, 0, 0};
+
+ADXL355SpiTransport::ADXL355SpiTransport() : device(nullptr), host(SPI3_HOST), initialized(false),
+                                             burst_buffer(nullptr), burst_length(0), burst_pending(false) {
+  memset(&burst_transaction, 0, sizeof(burst_transaction));
+}
+
+ADXL355SpiTransport::~ADXL355SpiTransport() {
+  end();
+}
+
+bool ADXL355SpiTransport::begin(spi_host_device_t spi_host, int8_t cs_pin, uint32_t clock_hz) {
+  if (initialized) {
+    return true;
+  }
+  
+  host = spi_host;
+  
+  // The bus is shared: only the first device initialises it
+  if (bus_users[host] == 0) {
+    spi_bus_config_t bus_config;
+    memset(&bus_config, 0, sizeof(bus_config));
+    bus_config.mosi_io_num = MOSI_PIN;
+    bus_config.miso_io_num = MISO_PIN;
+    bus_config.sclk_io_num = SCLK_PIN;
+    bus_config.quadwp_io_num = -1;
+    bus_config.quadhd_io_num = -1;
+    bus_config.max_transfer_sz = ADXL355_SPI_MAX_BURST + 4;
+    
+    esp_err_t err = spi_bus_initialize(host, &bus_config, SPI_DMA_CH_AUTO);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+      Serial.printf("[ADXL355-DMA] SPI bus init failed: %d\n", err);
+      return false;
+    }
+  }
+  
+  // One address byte ((reg << 1) | R/W) followed by the data phase;
+  // chip select is driven by the SPI peripheral
+  spi_device_interface_config_t dev_config;
+  memset(&dev_config, 0, sizeof(dev_config));
+  dev_config.address_bits = 8;
+  dev_config.mode = SPI_MODE;
+  dev_config.clock_speed_hz = clock_hz;
+  dev_config.spics_io_num = cs_pin;
+  dev_config.queue_size = 2;
+  
+  esp_err_t err = spi_bus_add_device(host, &dev_config, &device);
+  if (err != ESP_OK) {
+    Serial.printf("[ADXL355-DMA] Failed to add SPI device: %d\n", err);
+    if (bus_users[host] == 0) spi_bus_free(host);
+    return false;
+  }
+  bus_users[host]++;
+  
+  burst_buffer = (uint8_t*)heap_caps_malloc(ADXL355_SPI_MAX_BURST, MALLOC_CAP_DMA);
+  if (!burst_buffer) {
+    Serial.println("[ADXL355-DMA] Failed to allocate DMA buffer!");
+    end();
+    return false;
+  }
+  
+  initialized = true;
+  
+  #if ENABLE_DEBUG_OUTPUT
+  Serial.printf("[ADXL355-DMA] SPI device ready: CS %d @ %lu Hz\n", cs_pin, clock_hz);
+  #endif
+  
+  return true;
+}
+
+void ADXL355SpiTransport::end() {
+  if (burst_pending) {
+    uint16_t discarded;
+    collectBurstRead(discarded);
+  }
+  
+  if (device) {
+    spi_bus_remove_device(device);
+    device = nullptr;
+    if (bus_users[host] > 0 && --bus_users[host] == 0) {
+      spi_bus_free(host);
+    }
+  }
+  
+  if (burst_buffer) {
+    heap_caps_free(burst_buffer);
+    burst_buffer = nullptr;
+  }
+  
+  initialized = false;
+}
+
+void ADXL355SpiTransport::writeRegister(uint8_t reg, uint8_t value) {
+  // A polled transaction cannot start while a queued one is in flight
+  if (burst_pending) {
+    return;
+  }
+  
+  spi_transaction_t t;
+  memset(&t, 0, sizeof(t));
+  t.flags = SPI_TRANS_USE_TXDATA;
+  t.addr = (reg << 1) | 0x00;  // Write command
+  t.length = 8;
+  t.tx_data[0] = value;
+  spi_device_polling_transmit(device, &t);
+}
+
+uint8_t ADXL355SpiTransport::readRegister(uint8_t reg) {
+  if (burst_pending) {
+    return 0;
+  }
+  
+  spi_transaction_t t;
+  memset(&t, 0, sizeof(t));
+  t.flags = SPI_TRANS_USE_RXDATA;
+  t.addr = (reg << 1) | 0x01;  // Read command
+  t.length = 8;
+  t.rxlength = 8;
+  spi_device_polling_transmit(device, &t);
+  return t.rx_data[0];
+}
+
+bool ADXL355SpiTransport::readRegisters(uint8_t reg, uint8_t* data, uint16_t length) {
+  uint16_t padded = paddedLength(length);
+  if (length == 0 || padded > ADXL355_SPI_MAX_BURST || burst_pending) {
+    return false;
+  }
+  
+  spi_transaction_t t;
+  memset(&t, 0, sizeof(t));
+  t.addr = (reg << 1) | 0x01;  // Read command
+  t.length = padded * 8;
+  t.rxlength = padded * 8;
+  t.rx_buffer = burst_buffer;
+  
+  // Polled transmit avoids the interrupt round trip on short reads
+  if (spi_device_polling_transmit(device, &t) != ESP_OK) {
+    return false;
+  }
+  
+  memcpy(data, burst_buffer, length);
+  return true;
+}
+
+bool ADXL355SpiTransport::queueBurstRead(uint8_t reg, uint16_t length) {
+  uint16_t padded = paddedLength(length);
+  if (length == 0 || padded > ADXL355_SPI_MAX_BURST || burst_pending) {
+    return false;
+  }
+  
+  memset(&burst_transaction, 0, sizeof(burst_transaction));
+  burst_transaction.addr = (reg << 1) | 0x01;  // Read command
+  burst_transaction.length = padded * 8;
+  burst_transaction.rxlength = padded * 8;
+  burst_transaction.rx_buffer = burst_buffer;
+  
+  // DMA runs the whole burst; collectBurstRead waits for it
+  if (spi_device_queue_trans(device, &burst_transaction, 0) != ESP_OK) {
+    return false;
+  }
+  
+  burst_length = length;  // Padding bytes are never handed out
+  burst_pending = true;
+  return true;
+}
+
+const uint8_t* ADXL355SpiTransport::collectBurstRead(uint16_t& length, TickType_t timeout) {
+  length = 0;
+  if (!burst_pending) {
+    return nullptr;
+  }
+  
+  spi_transaction_t* done = nullptr;
+  if (spi_device_get_trans_result(device, &done, timeout) != ESP_OK) {
+    return nullptr;
+  }
+  
+  burst_pending = false;
+  length = burst_length;
+  return burst_buffer;
+}
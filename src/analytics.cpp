@@ -1,4 +1,10 @@
 #include "analytics.h"
+#include "config.h"
+
+// running + alpha * (current - running), rounded
+static inline int32_t ema(int32_t running, int32_t current) {
+  return running + (int32_t)roundShift((int64_t)(current - running) * ANALYTICS_EMA_ALPHA_Q16, 16);
+}
 
 Analytics::Analytics() : initialized(false) {
   analytics_data = AnalyticsData();
@@ -22,89 +28,93 @@ void Analytics::processBufferStats(const BufferStats& stats) {
     return;
   }
 
-  // IMPORTANT: Convert raw ADXL355 values to g-values before processing
-  const float ADXL355_SCALE_FACTOR = 256000.0f;
-  
-  float current_avg_x_g = stats.avg_x / ADXL355_SCALE_FACTOR;
-  float current_avg_y_g = stats.avg_y / ADXL355_SCALE_FACTOR;
-  float current_avg_z_g = stats.avg_z / ADXL355_SCALE_FACTOR;
-  float current_max_x_g = stats.max_x / ADXL355_SCALE_FACTOR;
-  float current_max_y_g = stats.max_y / ADXL355_SCALE_FACTOR;
-  float current_max_z_g = stats.max_z / ADXL355_SCALE_FACTOR;
-  float current_min_x_g = stats.min_x / ADXL355_SCALE_FACTOR;
-  float current_min_y_g = stats.min_y / ADXL355_SCALE_FACTOR;
-  float current_min_z_g = stats.min_z / ADXL355_SCALE_FACTOR;
-  float current_rms_x_g = stats.rms_x / ADXL355_SCALE_FACTOR;
-  float current_rms_y_g = stats.rms_y / ADXL355_SCALE_FACTOR;
-  float current_rms_z_g = stats.rms_z / ADXL355_SCALE_FACTOR;
-  
-  // Calculate standard deviation from RMS and average
-  // std = sqrt(RMS^2 - avg^2)
-  float current_std_x_g = sqrt(fmax(0.0f, (current_rms_x_g * current_rms_x_g) - (current_avg_x_g * current_avg_x_g)));
-  float current_std_y_g = sqrt(fmax(0.0f, (current_rms_y_g * current_rms_y_g) - (current_avg_y_g * current_avg_y_g)));
-  float current_std_z_g = sqrt(fmax(0.0f, (current_rms_z_g * current_rms_z_g) - (current_avg_z_g * current_avg_z_g)));
+  // Windows keep their own scale; a range change rescales the running values
+  // so they stay comparable with the new windows
+  const int32_t scale_factor = stats.counts_per_g > 0 ? stats.counts_per_g : (int32_t)ADXL355_SCALE_2G;
+  if (scale_factor != analytics_data.counts_per_g) {
+    rescale(scale_factor);
+  }
 
   #if ENABLE_DEBUG_OUTPUT
   static unsigned long last_debug = 0;
   if (millis() - last_debug > 4000) {
-    Serial.printf("[ANALYTICS] Raw: X=%.1f, Y=%.1f, Z=%.1f -> G: X=%.6f, Y=%.6f, Z=%.6f\n", 
-                  stats.avg_x, stats.avg_y, stats.avg_z, current_avg_x_g, current_avg_y_g, current_avg_z_g);
+    Serial.printf("[ANALYTICS] Raw (Q.8): X=%ld, Y=%ld, Z=%ld -> G: X=%.6f, Y=%.6f, Z=%.6f\n", 
+                  (long)stats.avg_x, (long)stats.avg_y, (long)stats.avg_z, countsToG(stats.avg_x, scale_factor),
+                  countsToG(stats.avg_y, scale_factor), countsToG(stats.avg_z, scale_factor));
     Serial.printf("[ANALYTICS] STD: X=%.6f, Y=%.6f, Z=%.6f | RMS: X=%.6f, Y=%.6f, Z=%.6f\n",
-                  current_std_x_g, current_std_y_g, current_std_z_g, current_rms_x_g, current_rms_y_g, current_rms_z_g);
+                  countsToG(stats.std_x, scale_factor), countsToG(stats.std_y, scale_factor),
+                  countsToG(stats.std_z, scale_factor), countsToG(stats.rms_x, scale_factor),
+                  countsToG(stats.rms_y, scale_factor), countsToG(stats.rms_z, scale_factor));
     last_debug = millis();
   }
   #endif
 
-  analytics_data.current_avg_x = current_avg_x_g;
-  analytics_data.current_avg_y = current_avg_y_g;
-  analytics_data.current_avg_z = current_avg_z_g;
-  analytics_data.current_max_x = current_max_x_g;
-  analytics_data.current_max_y = current_max_y_g;
-  analytics_data.current_max_z = current_max_z_g;
-  analytics_data.current_min_x = current_min_x_g;
-  analytics_data.current_min_y = current_min_y_g;
-  analytics_data.current_min_z = current_min_z_g;
-  analytics_data.current_std_x = current_std_x_g;
-  analytics_data.current_std_y = current_std_y_g;
-  analytics_data.current_std_z = current_std_z_g;
-  analytics_data.current_rms_x = current_rms_x_g;
-  analytics_data.current_rms_y = current_rms_y_g;
-  analytics_data.current_rms_z = current_rms_z_g;
-  
-  const float alpha = 0.1f;
+  analytics_data.current_avg_x = stats.avg_x;
+  analytics_data.current_avg_y = stats.avg_y;
+  analytics_data.current_avg_z = stats.avg_z;
+  analytics_data.current_max_x = stats.max_x;
+  analytics_data.current_max_y = stats.max_y;
+  analytics_data.current_max_z = stats.max_z;
+  analytics_data.current_min_x = stats.min_x;
+  analytics_data.current_min_y = stats.min_y;
+  analytics_data.current_min_z = stats.min_z;
+  analytics_data.current_std_x = stats.std_x;
+  analytics_data.current_std_y = stats.std_y;
+  analytics_data.current_std_z = stats.std_z;
+  analytics_data.current_rms_x = stats.rms_x;
+  analytics_data.current_rms_y = stats.rms_y;
+  analytics_data.current_rms_z = stats.rms_z;
+  analytics_data.current_p2p_x = stats.p2p_x;
+  analytics_data.current_p2p_y = stats.p2p_y;
+  analytics_data.current_p2p_z = stats.p2p_z;
+  analytics_data.current_crest_x = stats.crest_x;
+  analytics_data.current_crest_y = stats.crest_y;
+  analytics_data.current_crest_z = stats.crest_z;
+  analytics_data.current_skew_x = stats.skew_x;
+  analytics_data.current_skew_y = stats.skew_y;
+  analytics_data.current_skew_z = stats.skew_z;
+  analytics_data.current_kurt_x = stats.kurt_x;
+  analytics_data.current_kurt_y = stats.kurt_y;
+  analytics_data.current_kurt_z = stats.kurt_z;
+  analytics_data.current_vector_rms = stats.vector_rms;
+  analytics_data.current_clipped_x = stats.clipped_x;
+  analytics_data.current_clipped_y = stats.clipped_y;
+  analytics_data.current_clipped_z = stats.clipped_z;
+  analytics_data.clipped_total += stats.clipped_x + stats.clipped_y + stats.clipped_z;
+  
   if (analytics_data.window_count == 0) {
-    analytics_data.running_avg_x = current_avg_x_g;
-    analytics_data.running_avg_y = current_avg_y_g;
-    analytics_data.running_avg_z = current_avg_z_g;
-    analytics_data.running_std_x = current_std_x_g;
-    analytics_data.running_std_y = current_std_y_g;
-    analytics_data.running_std_z = current_std_z_g;
-    analytics_data.running_rms_x = current_rms_x_g;
-    analytics_data.running_rms_y = current_rms_y_g;
-    analytics_data.running_rms_z = current_rms_z_g;
-    analytics_data.global_max_x = current_max_x_g;
-    analytics_data.global_max_y = current_max_y_g;
-    analytics_data.global_max_z = current_max_z_g;
-    analytics_data.global_min_x = current_min_x_g;
-    analytics_data.global_min_y = current_min_y_g;
-    analytics_data.global_min_z = current_min_z_g;
+    analytics_data.running_avg_x = stats.avg_x;
+    analytics_data.running_avg_y = stats.avg_y;
+    analytics_data.running_avg_z = stats.avg_z;
+    analytics_data.running_std_x = stats.std_x;
+    analytics_data.running_std_y = stats.std_y;
+    analytics_data.running_std_z = stats.std_z;
+    analytics_data.running_rms_x = stats.rms_x;
+    analytics_data.running_rms_y = stats.rms_y;
+    analytics_data.running_rms_z = stats.rms_z;
+    analytics_data.global_max_x = stats.max_x;
+    analytics_data.global_max_y = stats.max_y;
+    analytics_data.global_max_z = stats.max_z;
+    analytics_data.global_min_x = stats.min_x;
+    analytics_data.global_min_y = stats.min_y;
+    analytics_data.global_min_z = stats.min_z;
   } else {
-    analytics_data.running_avg_x = (alpha * current_avg_x_g) + ((1.0f - alpha) * analytics_data.running_avg_x);
-    analytics_data.running_avg_y = (alpha * current_avg_y_g) + ((1.0f - alpha) * analytics_data.running_avg_y);
-    analytics_data.running_avg_z = (alpha * current_avg_z_g) + ((1.0f - alpha) * analytics_data.running_avg_z);
-    analytics_data.running_std_x = (alpha * current_std_x_g) + ((1.0f - alpha) * analytics_data.running_std_x);
-    analytics_data.running_std_y = (alpha * current_std_y_g) + ((1.0f - alpha) * analytics_data.running_std_y);
-    analytics_data.running_std_z = (alpha * current_std_z_g) + ((1.0f - alpha) * analytics_data.running_std_z);
-    analytics_data.running_rms_x = (alpha * current_rms_x_g) + ((1.0f - alpha) * analytics_data.running_rms_x);
-    analytics_data.running_rms_y = (alpha * current_rms_y_g) + ((1.0f - alpha) * analytics_data.running_rms_y);
-    analytics_data.running_rms_z = (alpha * current_rms_z_g) + ((1.0f - alpha) * analytics_data.running_rms_z);
+    analytics_data.running_avg_x = ema(analytics_data.running_avg_x, stats.avg_x);
+    analytics_data.running_avg_y = ema(analytics_data.running_avg_y, stats.avg_y);
+    analytics_data.running_avg_z = ema(analytics_data.running_avg_z, stats.avg_z);
+    analytics_data.running_std_x = ema(analytics_data.running_std_x, stats.std_x);
+    analytics_data.running_std_y = ema(analytics_data.running_std_y, stats.std_y);
+    analytics_data.running_std_z = ema(analytics_data.running_std_z, stats.std_z);
+    analytics_data.running_rms_x = ema(analytics_data.running_rms_x, stats.rms_x);
+    analytics_data.running_rms_y = ema(analytics_data.running_rms_y, stats.rms_y);
+    analytics_data.running_rms_z = ema(analytics_data.running_rms_z, stats.rms_z);
     
-    if (current_max_x_g > analytics_data.global_max_x) analytics_data.global_max_x = current_max_x_g;
-    if (current_max_y_g > analytics_data.global_max_y) analytics_data.global_max_y = current_max_y_g;
-    if (current_max_z_g > analytics_data.global_max_z) analytics_data.global_max_z = current_max_z_g;
-    if (current_min_x_g < analytics_data.global_min_x) analytics_data.global_min_x = current_min_x_g;
-    if (current_min_y_g < analytics_data.global_min_y) analytics_data.global_min_y = current_min_y_g;
-    if (current_min_z_g < analytics_data.global_min_z) analytics_data.global_min_z = current_min_z_g;
+    if (stats.max_x > analytics_data.global_max_x) analytics_data.global_max_x = stats.max_x;
+    if (stats.max_y > analytics_data.global_max_y) analytics_data.global_max_y = stats.max_y;
+    if (stats.max_z > analytics_data.global_max_z) analytics_data.global_max_z = stats.max_z;
+    if (stats.min_x < analytics_data.global_min_x) analytics_data.global_min_x = stats.min_x;
+    if (stats.min_y < analytics_data.global_min_y) analytics_data.global_min_y = stats.min_y;
+    if (stats.min_z < analytics_data.global_min_z) analytics_data.global_min_z = stats.min_z;
   }
   
   analytics_data.window_count++;
@@ -117,22 +127,42 @@ void Analytics::processBufferStats(const BufferStats& stats) {
   #endif
 }
 
+void Analytics::rescale(int32_t counts_per_g) {
+  const int32_t old_counts_per_g = analytics_data.counts_per_g;
+  analytics_data.counts_per_g = counts_per_g;
+  if (analytics_data.window_count == 0 || old_counts_per_g <= 0) {
+    return;
+  }
+
+  // Ranges differ by powers of two, so this is exact for every sensor here
+  int32_t* values[] = {
+    &analytics_data.running_avg_x, &analytics_data.running_avg_y, &analytics_data.running_avg_z,
+    &analytics_data.running_std_x, &analytics_data.running_std_y, &analytics_data.running_std_z,
+    &analytics_data.running_rms_x, &analytics_data.running_rms_y, &analytics_data.running_rms_z,
+    &analytics_data.global_max_x, &analytics_data.global_max_y, &analytics_data.global_max_z,
+    &analytics_data.global_min_x, &analytics_data.global_min_y, &analytics_data.global_min_z
+  };
+  for (uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+    *values[i] = (int32_t)divRound((int64_t)*values[i] * counts_per_g, old_counts_per_g);
+  }
+}
+
 void Analytics::resetRunningStats() {
-  analytics_data.running_avg_x = 0.0;
-  analytics_data.running_avg_y = 0.0;
-  analytics_data.running_avg_z = 0.0;
-  analytics_data.running_std_x = 0.0;
-  analytics_data.running_std_y = 0.0;
-  analytics_data.running_std_z = 0.0;
-  analytics_data.running_rms_x = 0.0;
-  analytics_data.running_rms_y = 0.0;
-  analytics_data.running_rms_z = 0.0;
-  analytics_data.global_max_x = 0.0;
-  analytics_data.global_max_y = 0.0;
-  analytics_data.global_max_z = 0.0;
-  analytics_data.global_min_x = 0.0;
-  analytics_data.global_min_y = 0.0;
-  analytics_data.global_min_z = 0.0;
+  analytics_data.running_avg_x = 0;
+  analytics_data.running_avg_y = 0;
+  analytics_data.running_avg_z = 0;
+  analytics_data.running_std_x = 0;
+  analytics_data.running_std_y = 0;
+  analytics_data.running_std_z = 0;
+  analytics_data.running_rms_x = 0;
+  analytics_data.running_rms_y = 0;
+  analytics_data.running_rms_z = 0;
+  analytics_data.global_max_x = 0;
+  analytics_data.global_max_y = 0;
+  analytics_data.global_max_z = 0;
+  analytics_data.global_min_x = 0;
+  analytics_data.global_min_y = 0;
+  analytics_data.global_min_z = 0;
   analytics_data.window_count = 0;
   analytics_data.last_update_time = 0;
   analytics_data.data_valid = false;
@@ -154,21 +184,21 @@ void Analytics::printAnalytics() const {
   
   Serial.println("Current Averages (g):");
   Serial.printf("  X: %8.4f  Y: %8.4f  Z: %8.4f\n", 
-    analytics_data.current_avg_x, 
-    analytics_data.current_avg_y, 
-    analytics_data.current_avg_z);
+    countsToG(analytics_data.current_avg_x, analytics_data.counts_per_g), 
+    countsToG(analytics_data.current_avg_y, analytics_data.counts_per_g), 
+    countsToG(analytics_data.current_avg_z, analytics_data.counts_per_g));
   
   Serial.println("Current Maximums (g):");
   Serial.printf("  X: %8.4f  Y: %8.4f  Z: %8.4f\n", 
-    analytics_data.current_max_x, 
-    analytics_data.current_max_y, 
-    analytics_data.current_max_z);
+    countsToG(analytics_data.current_max_x, analytics_data.counts_per_g), 
+    countsToG(analytics_data.current_max_y, analytics_data.counts_per_g), 
+    countsToG(analytics_data.current_max_z, analytics_data.counts_per_g));
   
   Serial.println("Current Minimums (g):");
   Serial.printf("  X: %8.4f  Y: %8.4f  Z: %8.4f\n", 
-    analytics_data.current_min_x, 
-    analytics_data.current_min_y, 
-    analytics_data.current_min_z);
+    countsToG(analytics_data.current_min_x, analytics_data.counts_per_g), 
+    countsToG(analytics_data.current_min_y, analytics_data.counts_per_g), 
+    countsToG(analytics_data.current_min_z, analytics_data.counts_per_g));
   
   Serial.println("===============================");
   #endif
@@ -187,21 +217,30 @@ void Analytics::printRunningStats() const {
   
   Serial.println("Running Averages (g):");
   Serial.printf("  X: %8.4f  Y: %8.4f  Z: %8.4f\n", 
-    analytics_data.running_avg_x, 
-    analytics_data.running_avg_y, 
-    analytics_data.running_avg_z);
+    countsToG(analytics_data.running_avg_x, analytics_data.counts_per_g), 
+    countsToG(analytics_data.running_avg_y, analytics_data.counts_per_g), 
+    countsToG(analytics_data.running_avg_z, analytics_data.counts_per_g));
   
   Serial.println("Global Maximums (g):");
   Serial.printf("  X: %8.4f  Y: %8.4f  Z: %8.4f\n", 
-    analytics_data.global_max_x, 
-    analytics_data.global_max_y, 
-    analytics_data.global_max_z);
+    countsToG(analytics_data.global_max_x, analytics_data.counts_per_g), 
+    countsToG(analytics_data.global_max_y, analytics_data.counts_per_g), 
+    countsToG(analytics_data.global_max_z, analytics_data.counts_per_g));
   
   Serial.println("Global Minimums (g):");
   Serial.printf("  X: %8.4f  Y: %8.4f  Z: %8.4f\n", 
-    analytics_data.global_min_x, 
-    analytics_data.global_min_y, 
-    analytics_data.global_min_z);
+    countsToG(analytics_data.global_min_x, analytics_data.counts_per_g), 
+    countsToG(analytics_data.global_min_y, analytics_data.counts_per_g), 
+    countsToG(analytics_data.global_min_z, analytics_data.counts_per_g));
+  
+  const float r = 1.0f / (1L << SHAPE_FRAC_BITS);
+  Serial.println("Current Crest / Kurtosis:");
+  Serial.printf("  X: %5.2f / %5.2f  Y: %5.2f / %5.2f  Z: %5.2f / %5.2f\n",
+    analytics_data.current_crest_x * r, analytics_data.current_kurt_x * r,
+    analytics_data.current_crest_y * r, analytics_data.current_kurt_y * r,
+    analytics_data.current_crest_z * r, analytics_data.current_kurt_z * r);
+  Serial.printf("Vector RMS: %.4f g, clipped samples since start: %lu\n",
+    countsToG(analytics_data.current_vector_rms, analytics_data.counts_per_g), analytics_data.clipped_total);
   
   Serial.println("========================");
   #endif
@@ -1,152 +1,43 @@
 #include "data_buffer.h"
 #include <math.h>
 
-DataBuffer::DataBuffer() : buffer(nullptr), write_index(0), sample_count(0), 
-                          buffer_full(false), last_sample_time(0), buffer_start_time(0) {
-}
-
-DataBuffer::~DataBuffer() {
-  if (buffer) {
-    delete[] buffer;
-  }
-}
-
-bool DataBuffer::begin() {
-  // Allocate buffer memory
-  buffer = new AccelSample[BUFFER_SIZE];
-  if (!buffer) {
-    Serial.println("Failed to allocate buffer memory!");
-    return false;
-  }
-  
-  reset();
-  Serial.print("Data buffer initialized: ");
-  Serial.print(BUFFER_SIZE);
-  Serial.print(" samples @ ");
-  Serial.print(SAMPLE_RATE_HZ);
-  Serial.println(" Hz");
-  
-  return true;
-}
-
-void DataBuffer::reset() {
-  write_index = 0;
-  sample_count = 0;
-  buffer_full = false;
-  last_sample_time = 0;
-  buffer_start_time = micros();
-}
-
-bool DataBuffer::shouldSample() {
-  unsigned long current_time = micros();
-  
-  // Check if enough time has passed since last sample
-  if (last_sample_time == 0 || (current_time - last_sample_time) >= SAMPLING_INTERVAL_US) {
-    return true;
-  }
-  
-  return false;
-}
-
-bool DataBuffer::addSample(int32_t x, int32_t y, int32_t z) {
-  if (!buffer || buffer_full) {
-    return false;
-  }
-  
-  unsigned long current_time = micros();
-  
-  // Store sample
-  buffer[write_index].x = x;
-  buffer[write_index].y = y;
-  buffer[write_index].z = z;
-  buffer[write_index].timestamp_us = current_time;
-  
-  // Update indices
-  write_index++;
-  sample_count++;
-  last_sample_time = current_time;
-  
-  // Check if buffer is full
-  if (write_index >= BUFFER_SIZE) {
-    buffer_full = true;
-    write_index = 0;  // Reset for next buffer cycle
-  }
-  
-  return true;
-}
-
-void DataBuffer::calculateStats(BufferStats& stats) {
-  if (!buffer || sample_count == 0) {
-    memset(&stats, 0, sizeof(stats));
+void MomentSums::shape(uint16_t n, long long sum, long long sum_sq, int32_t& skew, int32_t& kurt) const {
+  skew = 0;
+  kurt = 0;
+  if (n < 2) {
     return;
   }
   
-  // Initialize min/max values
-  stats.min_x = stats.max_x = buffer[0].x;
-  stats.min_y = stats.max_y = buffer[0].y;
-  stats.min_z = stats.max_z = buffer[0].z;
-  
-  // Calculate sums for averages
-  long long sum_x = 0, sum_y = 0, sum_z = 0;
-  long long sum_sq_x = 0, sum_sq_y = 0, sum_sq_z = 0;
-  
-  for (uint16_t i = 0; i < sample_count; i++) {
-    int32_t x = buffer[i].x;
-    int32_t y = buffer[i].y;
-    int32_t z = buffer[i].z;
-    
-    // Sum for averages
-    sum_x += x;
-    sum_y += y;
-    sum_z += z;
-    
-    // Sum of squares for RMS
-    sum_sq_x += (long long)x * x;
-    sum_sq_y += (long long)y * y;
-    sum_sq_z += (long long)z * z;
-    
-    // Min/max
-    if (x < stats.min_x) stats.min_x = x;
-    if (x > stats.max_x) stats.max_x = x;
-    if (y < stats.min_y) stats.min_y = y;
-    if (y > stats.max_y) stats.max_y = y;
-    if (z < stats.min_z) stats.min_z = z;
-    if (z > stats.max_z) stats.max_z = z;
-  }
-  
-  // Calculate averages
-  stats.avg_x = (float)sum_x / sample_count;
-  stats.avg_y = (float)sum_y / sample_count;
-  stats.avg_z = (float)sum_z / sample_count;
-
-  #if ENABLE_DEBUG_OUTPUT
-  static unsigned long last_buffer_debug = 0;
-  if (millis() - last_buffer_debug > 5000) {  // Debug every 5 seconds
-    Serial.printf("[BUFFER-CALC] Sample count: %d\n", sample_count);
-    Serial.printf("[BUFFER-CALC] Sum values: X=%lld, Y=%lld, Z=%lld\n", sum_x, sum_y, sum_z);
-    Serial.printf("[BUFFER-CALC] Calculated averages: X=%.3f, Y=%.3f, Z=%.3f\n", 
-                  stats.avg_x, stats.avg_y, stats.avg_z);
-    Serial.printf("[BUFFER-CALC] Min/Max: X=[%.1f,%.1f], Y=[%.1f,%.1f], Z=[%.1f,%.1f]\n", 
-                  stats.min_x, stats.max_x, stats.min_y, stats.max_y, stats.min_z, stats.max_z);
-    last_buffer_debug = millis();
-  }
-  #endif
-  
-  // Calculate RMS
-  stats.rms_x = sqrt((float)sum_sq_x / sample_count);
-  stats.rms_y = sqrt((float)sum_sq_y / sample_count);
-  stats.rms_z = sqrt((float)sum_sq_z / sample_count);
-  
-  // Other stats
-  stats.sample_count = sample_count;
-  if (sample_count > 0) {
-    stats.duration_us = buffer[sample_count-1].timestamp_us - buffer[0].timestamp_us;
-  } else {
-    stats.duration_us = 0;
+  // Once per window, so double precision is affordable here; the sums are
+  // exact and centered near the data, and 53 bits keep the cancellation in
+  // the central moments well below the Q.16 resolution.
+  const double inv_n = 1.0 / n;
+  const double mu = sum * inv_n;
+  const double s2 = sum_sq * inv_n;
+  const double s3 = (ldexp((double)cube_hi, 21) + (double)cube_lo) * inv_n;
+  const double s4 = (ldexp((double)quad_hh, 42) + ldexp((double)quad_hl, 22) + (double)quad_ll) * inv_n;
+  
+  const double m2 = (double)((long long)n * sum_sq - sum * sum) * inv_n * inv_n;  // Exact numerator
+  if (m2 <= 0.0) {
+    return;
   }
+  const double m3 = s3 - 3.0 * mu * s2 + 2.0 * mu * mu * mu;
+  const double m4 = s4 - 4.0 * mu * s3 + 6.0 * mu * mu * s2 - 3.0 * mu * mu * mu * mu;
+  
+  const double scale = (double)(1L << SHAPE_FRAC_BITS);
+  double sk = m3 / (m2 * sqrt(m2)) * scale;
+  double ku = m4 / (m2 * m2) * scale;
+  if (sk > INT32_MAX) sk = INT32_MAX;
+  if (sk < -INT32_MAX) sk = -INT32_MAX;
+  if (ku > INT32_MAX) ku = INT32_MAX;
+  if (ku < 0.0) ku = 0.0;
+  skew = (int32_t)lround(sk);
+  kurt = (int32_t)lround(ku);
 }
 
-void DataBuffer::printStats(const BufferStats& stats) {
+void printBufferStats(const BufferStats& stats) {
+  const float q = 1.0f / (1 << STATS_FRAC_BITS);
+
   Serial.println("\n=== Buffer Statistics ===");
   Serial.print("Samples: "); Serial.print(stats.sample_count);
   Serial.print(" / Duration: "); Serial.print(stats.duration_us / 1000.0, 1); Serial.println(" ms");
@@ -155,24 +46,32 @@ void DataBuffer::printStats(const BufferStats& stats) {
   Serial.print("Actual sample rate: "); Serial.print(actual_rate, 1); Serial.println(" Hz");
   
   Serial.println("--- Averages ---");
-  Serial.print("X: "); Serial.print(stats.avg_x, 1);
-  Serial.print("\tY: "); Serial.print(stats.avg_y, 1);
-  Serial.print("\tZ: "); Serial.println(stats.avg_z, 1);
+  Serial.print("X: "); Serial.print(stats.avg_x * q, 1);
+  Serial.print("\tY: "); Serial.print(stats.avg_y * q, 1);
+  Serial.print("\tZ: "); Serial.println(stats.avg_z * q, 1);
   
   Serial.println("--- Min Values ---");
-  Serial.print("X: "); Serial.print(stats.min_x);
-  Serial.print("\tY: "); Serial.print(stats.min_y);
-  Serial.print("\tZ: "); Serial.println(stats.min_z);
+  Serial.print("X: "); Serial.print(stats.min_x >> STATS_FRAC_BITS);
+  Serial.print("\tY: "); Serial.print(stats.min_y >> STATS_FRAC_BITS);
+  Serial.print("\tZ: "); Serial.println(stats.min_z >> STATS_FRAC_BITS);
   
   Serial.println("--- Max Values ---");
-  Serial.print("X: "); Serial.print(stats.max_x);
-  Serial.print("\tY: "); Serial.print(stats.max_y);
-  Serial.print("\tZ: "); Serial.println(stats.max_z);
+  Serial.print("X: "); Serial.print(stats.max_x >> STATS_FRAC_BITS);
+  Serial.print("\tY: "); Serial.print(stats.max_y >> STATS_FRAC_BITS);
+  Serial.print("\tZ: "); Serial.println(stats.max_z >> STATS_FRAC_BITS);
   
   Serial.println("--- RMS Values ---");
-  Serial.print("X: "); Serial.print(stats.rms_x, 1);
-  Serial.print("\tY: "); Serial.print(stats.rms_y, 1);
-  Serial.print("\tZ: "); Serial.println(stats.rms_z, 1);
+  Serial.print("X: "); Serial.print(stats.rms_x * q, 1);
+  Serial.print("\tY: "); Serial.print(stats.rms_y * q, 1);
+  Serial.print("\tZ: "); Serial.println(stats.rms_z * q, 1);
+  
+  const float r = 1.0f / (1L << SHAPE_FRAC_BITS);
+  Serial.println("--- Shape ---");
+  Serial.printf("Crest:    X: %.2f\tY: %.2f\tZ: %.2f\n", stats.crest_x * r, stats.crest_y * r, stats.crest_z * r);
+  Serial.printf("Skewness: X: %.2f\tY: %.2f\tZ: %.2f\n", stats.skew_x * r, stats.skew_y * r, stats.skew_z * r);
+  Serial.printf("Kurtosis: X: %.2f\tY: %.2f\tZ: %.2f\n", stats.kurt_x * r, stats.kurt_y * r, stats.kurt_z * r);
+  Serial.printf("Vector RMS: %.1f, clipped: X %u Y %u Z %u\n", stats.vector_rms * q,
+                stats.clipped_x, stats.clipped_y, stats.clipped_z);
   
   Serial.println("========================\n");
 }
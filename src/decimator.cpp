@@ -0,0 +1,21 @@
+#include "decimator.h"
+
+Decimator oversampleDecimator;
+Decimator trendDecimator;
+
+Decimator::Decimator() : stage_count(0) {
+  reset();
+}
+
+void Decimator::configure(uint8_t count) {
+  stage_count = count > DECIMATOR_MAX_STAGES ? DECIMATOR_MAX_STAGES : count;
+  reset();
+}
+
+void Decimator::reset() {
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    for (uint8_t s = 0; s < DECIMATOR_MAX_STAGES; s++) {
+      stages[ch][s].clear();
+    }
+  }
+}
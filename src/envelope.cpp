@@ -0,0 +1,203 @@
+#include "envelope.h"
+#include "stats_kernels.h"
+#include <math.h>
+
+EnvelopeAnalyzer envelopeAnalyzer;
+
+EnvelopeAnalyzer::EnvelopeAnalyzer() : active(false), sample_rate_hz(SAMPLE_RATE_HZ), counts_per_g(1.0f),
+                                       staged_channel(0), staged_axis(3), next_channel(0), dropped(0),
+                                       window_sum_sq(0),
+                                       requested_low_hz(DEFAULT_ENVELOPE_BAND_LOW_HZ),
+                                       requested_high_hz(DEFAULT_ENVELOPE_BAND_HIGH_HZ), settings_pending(false),
+                                       band_low_hz(DEFAULT_ENVELOPE_BAND_LOW_HZ),
+                                       band_high_hz(DEFAULT_ENVELOPE_BAND_HIGH_HZ) {
+  memset(bandpass, 0, sizeof(bandpass));
+  memset(primed, 0, sizeof(primed));
+  memset(fill_count, 0, sizeof(fill_count));
+  memset(&building, 0, sizeof(building));
+  memset(results, 0, sizeof(results));
+  results_lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+bool EnvelopeAnalyzer::begin() {
+  for (uint16_t i = 0; i < ENVELOPE_FFT_SIZE; i++) {
+    window[i] = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * i / ENVELOPE_FFT_SIZE);
+  }
+  window_sum_sq = statsSumSqF32(window, ENVELOPE_FFT_SIZE);
+  for (uint16_t k = 0; k < HALF; k++) {
+    tw_cos[k] = cosf(2.0f * (float)M_PI * k / ENVELOPE_FFT_SIZE);
+    tw_sin[k] = sinf(2.0f * (float)M_PI * k / ENVELOPE_FFT_SIZE);
+  }
+
+  #if ENABLE_DEBUG_OUTPUT
+  Serial.printf("[ENVELOPE] %d-point spectrum, x%d decimation, %d peaks\n",
+                ENVELOPE_FFT_SIZE, 1 << ENVELOPE_DECIMATION_STAGES, ENVELOPE_NUM_PEAKS);
+  #endif
+
+  return true;
+}
+
+void EnvelopeAnalyzer::configure(uint16_t sample_rate, int32_t counts_per_g) {
+  sample_rate_hz = sample_rate ? sample_rate : SAMPLE_RATE_HZ;
+  this->counts_per_g = counts_per_g > 0 ? (float)counts_per_g : 1.0f;
+  decimator.configure(ENVELOPE_DECIMATION_STAGES);
+  applySettings();
+}
+
+void EnvelopeAnalyzer::setBand(uint16_t low_hz, uint16_t high_hz) {
+  requested_low_hz = low_hz;
+  requested_high_hz = high_hz;
+  settings_pending = true;
+}
+
+void EnvelopeAnalyzer::applySettings() {
+  settings_pending = false;
+  band_low_hz = requested_low_hz;
+  band_high_hz = requested_high_hz;
+
+  // Two sections per edge for a steeper skirt; table first, then design
+  BiquadCoeffs highpass = { 0, 0, 0, 0, 0 };
+  BiquadCoeffs lowpass = { 0, 0, 0, 0, 0 };
+  active = band_low_hz < band_high_hz &&
+           (SampleFilter::lookupCoeffs(FILTER_HIGHPASS, sample_rate_hz, band_low_hz, highpass) ||
+            SampleFilter::designCoeffs(FILTER_HIGHPASS, sample_rate_hz, band_low_hz, highpass)) &&
+           (SampleFilter::lookupCoeffs(FILTER_LOWPASS, sample_rate_hz, band_high_hz, lowpass) ||
+            SampleFilter::designCoeffs(FILTER_LOWPASS, sample_rate_hz, band_high_hz, lowpass));
+
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    for (uint8_t a = 0; a < 3; a++) {
+      AxisFilter& filter = bandpass[ch][a];
+      filter.coeffs[0] = filter.coeffs[1] = highpass;
+      filter.coeffs[2] = filter.coeffs[3] = lowpass;
+      filter.sections = active ? 4 : 0;
+      filter.clearState();
+    }
+    primed[ch] = false;
+    fill_count[ch] = 0;
+  }
+  decimator.reset();
+  staged_axis = 3;  // A block in flight belongs to the old band
+
+  #if ENABLE_DEBUG_OUTPUT
+  Serial.printf("[ENVELOPE] Band %d-%d Hz @ %d Hz%s\n", band_low_hz, band_high_hz, sample_rate_hz,
+                active ? "" : " (unusable, envelope off)");
+  #endif
+}
+
+void EnvelopeAnalyzer::processSample(uint8_t channel, int32_t x, int32_t y, int32_t z) {
+  if (!active) {
+    return;
+  }
+  const int32_t in[3] = { x, y, z };
+
+  // Start the high-pass at rest on the first sample so gravity does not
+  // ring through the band
+  if (!primed[channel]) {
+    for (uint8_t a = 0; a < 3; a++) {
+      bandpass[channel][a].x1[0] = bandpass[channel][a].x2[0] = in[a];
+    }
+    primed[channel] = true;
+  }
+
+  // Band-pass and full-wave rectify; the decimator's half-band stages are
+  // the envelope low-pass
+  int32_t e[3];
+  for (uint8_t a = 0; a < 3; a++) {
+    int32_t v = bandpass[channel][a].process(in[a]);
+    e[a] = v < 0 ? -v : v;
+  }
+  if (!decimator.process(channel, e[0], e[1], e[2])) {
+    return;
+  }
+
+  // A full block waits for the analyzer; the filters keep running so the
+  // next block starts without a transient
+  uint16_t n = fill_count[channel];
+  if (n >= ENVELOPE_FFT_SIZE) {
+    dropped++;
+    return;
+  }
+  fill[channel][0][n] = e[0];
+  fill[channel][1][n] = e[1];
+  fill[channel][2][n] = e[2];
+  fill_count[channel] = n + 1;
+}
+
+bool EnvelopeAnalyzer::stageNext() {
+  // Full blocks in turn so channel 0 cannot starve the others
+  for (uint8_t i = 0; i < NUM_ACCEL_CHANNELS; i++) {
+    uint8_t channel = (next_channel + i) % NUM_ACCEL_CHANNELS;
+    if (fill_count[channel] < ENVELOPE_FFT_SIZE) {
+      continue;
+    }
+    memcpy(staged, fill[channel], sizeof(staged));
+    fill_count[channel] = 0;
+    staged_channel = channel;
+    staged_axis = 0;
+    building.compute_us = 0;
+    next_channel = (channel + 1) % NUM_ACCEL_CHANNELS;
+    return true;
+  }
+  return false;
+}
+
+void EnvelopeAnalyzer::analyzeAxis(uint8_t axis) {
+  AxisEnvelope& out = building.axis[axis];
+  memset(&out, 0, sizeof(out));
+
+  const int32_t* samples = staged[axis];
+  const float mean = (float)statsSumI32(samples, ENVELOPE_FFT_SIZE) / ENVELOPE_FFT_SIZE;
+  const float scale = 1.0f / counts_per_g;
+  for (uint16_t n = 0; n < ENVELOPE_FFT_SIZE; n++) {
+    work[n] = ((float)samples[n] - mean) * scale * window[n];
+  }
+  fftRealPower(work, HALF, tw_cos, tw_sin, power);
+
+  const float resolution = (float)getEnvelopeRate() / ENVELOPE_FFT_SIZE;
+  const float power_scale = 2.0f / (ENVELOPE_FFT_SIZE * window_sum_sq);  // Mean square per bin
+  out.rms_g = sqrtf(statsSumF32(&power[1], HALF) * power_scale);
+  findSpectralPeaks(power, HALF, resolution, power_scale, out.peaks, ENVELOPE_NUM_PEAKS);
+}
+
+void EnvelopeAnalyzer::service() {
+  if (staged_axis >= 3 && !stageNext()) {
+    return;
+  }
+
+  unsigned long start = micros();
+  analyzeAxis(staged_axis);
+  building.compute_us += micros() - start;
+  if (++staged_axis < 3) {
+    return;
+  }
+
+  building.sample_rate_hz = getEnvelopeRate();
+  building.resolution_hz = (float)building.sample_rate_hz / ENVELOPE_FFT_SIZE;
+  building.valid = true;
+
+  portENTER_CRITICAL(&results_lock);
+  building.sequence = results[staged_channel].sequence + 1;
+  results[staged_channel] = building;
+  portEXIT_CRITICAL(&results_lock);
+}
+
+bool EnvelopeAnalyzer::getResult(uint8_t channel, EnvelopeResult& out) const {
+  if (channel >= NUM_ACCEL_CHANNELS) {
+    return false;
+  }
+  portENTER_CRITICAL(&results_lock);
+  out = results[channel];
+  portEXIT_CRITICAL(&results_lock);
+  return out.valid;
+}
+
+void EnvelopeAnalyzer::printInfo() const {
+  Serial.printf("Envelope: %d-%d Hz band%s, %d Hz envelope, %lu samples dropped\n", band_low_hz, band_high_hz,
+                active ? "" : " (off)", getEnvelopeRate(), (unsigned long)dropped);
+  EnvelopeResult result;
+  if (getResult(0, result)) {
+    Serial.printf("Envelope X: %.4f g RMS, peak %.2f Hz %.4f g (%.2f Hz bins, %lu us/block)\n",
+                  result.axis[0].rms_g, result.axis[0].peaks[0].frequency_hz, result.axis[0].peaks[0].amplitude_g,
+                  result.resolution_hz, result.compute_us);
+  }
+}
@@ -0,0 +1,287 @@
+#include "event_capture.h"
+#include "data_buffer.h"
+#include "esp_heap_caps.h"
+
+EventCapture eventCapture;
+
+static void IRAM_ATTR eventTriggerISR() {
+  eventCapture.requestTrigger(EVENT_SOURCE_GPIO);
+}
+
+EventCapture::EventCapture() : slot_count(0), next_slot(0), stored_count(0), total_count(0),
+                               dropped_count(0), in_psram(false), pinned_slot(EVENT_NO_SLOT),
+                               pre_samples(0), post_samples(0), threshold_counts(0),
+                               sample_rate_hz(SAMPLE_RATE_HZ), counts_per_g(ADXL355_SCALE_2G),
+                               requested_pre_ms(DEFAULT_EVENT_PRE_MS), requested_post_ms(DEFAULT_EVENT_POST_MS),
+                               requested_threshold_mg(DEFAULT_EVENT_THRESHOLD_MG), settings_pending(true),
+                               pending_source(EVENT_SOURCE_NONE), collecting(false), post_remaining(0),
+                               trigger_source(EVENT_SOURCE_NONE), trigger_channel(0), trigger_time_us(0) {
+  memset(events, 0, sizeof(events));
+  memset(baseline, 0, sizeof(baseline));
+  memset(baseline_primed, 0, sizeof(baseline_primed));
+  slot_lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+EventCapture::~EventCapture() {
+  for (uint8_t i = 0; i < slot_count; i++) {
+    heap_caps_free(events[i].samples);
+  }
+}
+
+bool EventCapture::begin() {
+  const size_t slot_bytes = (size_t)EVENT_MAX_SAMPLES * NUM_ACCEL_CHANNELS * sizeof(uint64_t);
+
+  // Events belong in PSRAM; without it a single slot in internal RAM still
+  // keeps the most recent event
+  in_psram = true;
+  for (uint8_t i = 0; i < EVENT_MAX_EVENTS; i++) {
+    events[i].samples = (uint64_t*)heap_caps_malloc(slot_bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!events[i].samples) break;
+    slot_count++;
+  }
+
+  if (slot_count == 0) {
+    in_psram = false;
+    events[0].samples = (uint64_t*)heap_caps_malloc(slot_bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!events[0].samples) {
+      Serial.println("Failed to allocate event capture memory!");
+      return false;
+    }
+    slot_count = 1;
+  }
+
+  applySettings();
+
+  pinMode(EVENT_TRIGGER_PIN, INPUT_PULLDOWN);
+  attachInterrupt(digitalPinToInterrupt(EVENT_TRIGGER_PIN), eventTriggerISR, RISING);
+
+  #if ENABLE_DEBUG_OUTPUT
+  Serial.printf("[EVENT] %d slots x %u bytes (%s), trigger input GPIO%d\n", slot_count,
+                (unsigned)slot_bytes, in_psram ? "PSRAM" : "internal RAM", EVENT_TRIGGER_PIN);
+  #endif
+
+  return true;
+}
+
+void EventCapture::configure(uint16_t pre_ms, uint16_t post_ms, uint16_t threshold_mg) {
+  requested_pre_ms = pre_ms;
+  requested_post_ms = post_ms;
+  requested_threshold_mg = threshold_mg;
+  settings_pending = true;
+}
+
+void EventCapture::setTiming(uint16_t sample_rate, float scale_factor) {
+  sample_rate_hz = sample_rate ? sample_rate : SAMPLE_RATE_HZ;
+  counts_per_g = scale_factor;
+
+  // A capture spanning the change would mix rates; drop it. The running
+  // means restart from the next sample at the new scale.
+  collecting = false;
+  memset(baseline_primed, 0, sizeof(baseline_primed));
+  pending_source = EVENT_SOURCE_NONE;
+  settings_pending = true;
+}
+
+void EventCapture::applySettings() {
+  settings_pending = false;
+
+  uint32_t pre = ((uint32_t)requested_pre_ms * sample_rate_hz) / 1000;
+  uint32_t post = ((uint32_t)requested_post_ms * sample_rate_hz) / 1000;
+
+  // The trigger sample itself counts towards the post part
+  if (post == 0) post = 1;
+  if (post > EVENT_MAX_SAMPLES) post = EVENT_MAX_SAMPLES;
+  if (pre + post > EVENT_MAX_SAMPLES) pre = EVENT_MAX_SAMPLES - post;
+
+  pre_samples = pre;
+  post_samples = post;
+  threshold_counts = (int32_t)((float)requested_threshold_mg * counts_per_g / 1000.0f);
+}
+
+void EventCapture::startCapture(uint8_t source, uint8_t channel, unsigned long timestamp_us) {
+  collecting = true;
+  post_remaining = post_samples;
+  trigger_source = source;
+  trigger_channel = channel;
+  trigger_time_us = timestamp_us;
+}
+
+void EventCapture::processSample(uint8_t channel, int32_t x, int32_t y, int32_t z,
+                                 unsigned long timestamp_us, const PackedHistory* histories) {
+  if (slot_count == 0) {
+    return;
+  }
+
+  // Deviation of each axis from its running mean, which starts at the first
+  // sample so the trigger is quiet from the start
+  const int32_t in[3] = { x, y, z };
+  int32_t* mean = baseline[channel];
+  if (!baseline_primed[channel]) {
+    for (uint8_t a = 0; a < 3; a++) {
+      mean[a] = in[a] * (1 << EVENT_BASELINE_FRAC);
+    }
+    baseline_primed[channel] = true;
+  }
+  int32_t deviation = 0;
+  for (uint8_t a = 0; a < 3; a++) {
+    int32_t d = in[a] - ((mean[a] + (1 << (EVENT_BASELINE_FRAC - 1))) >> EVENT_BASELINE_FRAC);
+    if (d < 0) d = -d;
+    if (d > deviation) deviation = d;
+    mean[a] += (in[a] * (1 << EVENT_BASELINE_FRAC) - mean[a]) >> EVENT_BASELINE_SHIFT;
+  }
+
+  if (!collecting) {
+    if (settings_pending) {
+      applySettings();
+    }
+
+    // External requests take effect on the next sample of any channel
+    uint8_t source = pending_source;
+    if (source != EVENT_SOURCE_NONE) {
+      pending_source = EVENT_SOURCE_NONE;
+      startCapture(source, channel, timestamp_us);
+    } else if (threshold_counts > 0 && deviation >= threshold_counts) {
+      startCapture(EVENT_SOURCE_THRESHOLD, channel, timestamp_us);
+    } else {
+      return;
+    }
+  }
+
+  // Channels arrive in order each sampling tick; count post-trigger samples
+  // on the last one so every channel has the full post part in its history
+  if (channel != NUM_ACCEL_CHANNELS - 1) {
+    return;
+  }
+  if (--post_remaining == 0) {
+    finishCapture(histories);
+  }
+}
+
+void EventCapture::finishCapture(const PackedHistory* histories) {
+  collecting = false;
+
+  portENTER_CRITICAL(&slot_lock);
+  const uint8_t slot = next_slot;
+  const bool pinned = (slot == pinned_slot);
+  if (!pinned) {
+    next_slot = (next_slot + 1) % slot_count;
+    if (stored_count < slot_count) stored_count++;
+    total_count++;
+  }
+  portEXIT_CRITICAL(&slot_lock);
+
+  if (pinned) {
+    dropped_count++;
+    return;
+  }
+  EventRecord& event = events[slot];
+
+  // Copy pre + post straight out of each history, still packed. A history
+  // shorter than requested (just after reconfiguration) yields a shorter event.
+  uint32_t wanted = (uint32_t)pre_samples + post_samples;
+  uint32_t count = wanted;
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    if (histories[ch].getCount() < count) count = histories[ch].getCount();
+  }
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    histories[ch].copyRecent(count, event.samples + (size_t)ch * count);
+  }
+
+  event.id = total_count;
+  event.source = trigger_source;
+  event.trigger_channel = trigger_channel;
+  event.sample_count = count;
+  event.pre_samples = count > post_samples ? count - post_samples : 0;
+  event.sample_rate_hz = sample_rate_hz;
+  event.counts_per_g = counts_per_g;
+  event.trigger_time_us = trigger_time_us;
+  event.captured_ms = millis();
+
+  #if ENABLE_DEBUG_OUTPUT
+  Serial.printf("[EVENT] #%lu captured: source %d, channel %d, %d + %d samples\n",
+                (unsigned long)event.id, event.source, event.trigger_channel,
+                event.pre_samples, event.sample_count - event.pre_samples);
+  #endif
+}
+
+uint8_t EventCapture::slotOf(uint8_t index) const {
+  if (index >= stored_count) {
+    return EVENT_NO_SLOT;
+  }
+  return (next_slot + slot_count - 1 - index) % slot_count;
+}
+
+const EventRecord* EventCapture::getEvent(uint8_t index) const {
+  uint8_t slot = slotOf(index);
+  return slot == EVENT_NO_SLOT ? nullptr : &events[slot];
+}
+
+uint32_t EventCapture::readEvent(uint8_t index, uint8_t channel, uint32_t offset, uint32_t n,
+                                 int32_t* x, int32_t* y, int32_t* z) const {
+  const EventRecord* event = getEvent(index);
+  return event ? unpackRecord(*event, channel, offset, n, x, y, z) : 0;
+}
+
+uint32_t EventCapture::unpackRecord(const EventRecord& event, uint8_t channel, uint32_t offset, uint32_t n,
+                                    int32_t* x, int32_t* y, int32_t* z) {
+  if (channel >= NUM_ACCEL_CHANNELS || offset >= event.sample_count) {
+    return 0;
+  }
+  if (n > event.sample_count - offset) {
+    n = event.sample_count - offset;
+  }
+
+  const uint64_t* src = event.samples + (size_t)channel * event.sample_count + offset;
+  for (uint32_t i = 0; i < n; i++) {
+    x[i] = PackedHistory::unpackAxis(src[i], 0);
+    y[i] = PackedHistory::unpackAxis(src[i], 20);
+    z[i] = PackedHistory::unpackAxis(src[i], 40);
+  }
+  return n;
+}
+
+void EventCapture::printEvent(uint8_t index) const {
+  // Resolve and pin the slot once so a capture completing mid-dump cannot
+  // overwrite it or shift the index
+  portENTER_CRITICAL(&slot_lock);
+  const uint8_t slot = slotOf(index);
+  pinned_slot = slot;
+  portEXIT_CRITICAL(&slot_lock);
+  if (slot == EVENT_NO_SLOT) {
+    Serial.println("No such event");
+    return;
+  }
+  const EventRecord* event = &events[slot];
+
+  static const char* const source_names[] = { "none", "threshold", "modbus", "gpio" };
+  Serial.printf("\n=== Event #%lu (%s, channel %d) ===\n", (unsigned long)event->id,
+                source_names[event->source < 4 ? event->source : 0], event->trigger_channel);
+  Serial.printf("%d samples/channel @ %d Hz, trigger at sample %d, %.1f LSB/g\n",
+                event->sample_count, event->sample_rate_hz, event->pre_samples, event->counts_per_g);
+
+  // CSV: sample offset from the trigger, channel, raw x/y/z counts
+  Serial.println("n,ch,x,y,z");
+  int32_t x[32], y[32], z[32];
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    for (uint32_t offset = 0; offset < event->sample_count; offset += 32) {
+      uint32_t n = unpackRecord(*event, ch, offset, 32, x, y, z);
+      for (uint32_t i = 0; i < n; i++) {
+        Serial.printf("%ld,%d,%ld,%ld,%ld\n", (long)(offset + i) - event->pre_samples, ch,
+                      (long)x[i], (long)y[i], (long)z[i]);
+      }
+    }
+  }
+  Serial.println("========================\n");
+
+  portENTER_CRITICAL(&slot_lock);
+  pinned_slot = EVENT_NO_SLOT;
+  portEXIT_CRITICAL(&slot_lock);
+}
+
+void EventCapture::printInfo() const {
+  Serial.printf("Events: %lu captured, %d stored in %d slots (%s), %lu dropped while dumping%s\n",
+                (unsigned long)total_count, stored_count, slot_count, in_psram ? "PSRAM" : "internal RAM",
+                (unsigned long)dropped_count, collecting ? ", capturing" : "");
+  Serial.printf("Event window: %d + %d samples, threshold %ld counts\n",
+                pre_samples, post_samples, (long)threshold_counts);
+}
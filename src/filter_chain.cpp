@@ -0,0 +1,232 @@
+#include "filter_chain.h"
+#include <math.h>
+
+SampleFilter sampleFilter;
+
+struct BiquadTableEntry {
+  uint16_t sample_rate_hz;
+  uint8_t type;
+  uint16_t corner_hz;   // 0 for the DC blocker
+  BiquadCoeffs coeffs;
+};
+
+// Precomputed sections for the ADXL355 output data rates (and the MPU6050
+// default of 1 kHz). Same formulas as designCoeffs() (RBJ audio-EQ cookbook,
+// DC blocker y = g*(x - x1) + r*y1), evaluated in double precision and rounded
+// to Q3.28, with the high-pass b1 set to -2 b0 as designCoeffs() does.
+static const BiquadTableEntry biquad_table[] = {
+  // 4000 Hz
+  { 4000, FILTER_DC_BLOCK,    0, {   268330042,  -268330042,           0,  -268224627,           0 } },
+  { 4000, FILTER_HIGHPASS,    2, {   267839804,  -535679608,   267839804,  -535678287,   267245474 } },
+  { 4000, FILTER_HIGHPASS,   10, {   265470385,  -530940770,   265470385,  -530908017,   262538066 } },
+  { 4000, FILTER_LOWPASS,   100, {     1487862,     2975724,     1487862,  -477447832,   214963824 } },
+  { 4000, FILTER_LOWPASS,   250, {     8040872,    16081744,     8040872,  -390370540,   154098572 } },
+  { 4000, FILTER_LOWPASS,   500, {    26207642,    52415283,    26207642,  -253083375,    89478485 } },
+  { 4000, FILTER_LOWPASS,  1000, {    78622925,   157245850,    78622925,           0,    46056243 } },
+  { 4000, FILTER_BANDPASS,  100, {    19473143,           0,   -19473143,  -491794347,   229489170 } },
+  { 4000, FILTER_BANDPASS,  250, {    43113491,           0,   -43113491,  -416340703,   182208473 } },
+  { 4000, FILTER_BANDPASS,  500, {    70116381,           0,   -70116381,  -280465525,   128202693 } },
+  { 4000, FILTER_BANDPASS, 1000, {    89478485,           0,   -89478485,           0,    89478485 } },
+  // 2000 Hz
+  { 2000, FILTER_DC_BLOCK,    0, {   268224627,  -268224627,           0,  -268013799,           0 } },
+  { 2000, FILTER_HIGHPASS,    2, {   267245474,  -534490948,   267245474,  -534485673,   266060767 } },
+  { 2000, FILTER_HIGHPASS,   10, {   262538058,  -525076116,   262538058,  -524946537,   256770238 } },
+  { 2000, FILTER_LOWPASS,   100, {     5391087,    10782175,     5391087,  -419032599,   172161493 } },
+  { 2000, FILTER_LOWPASS,   250, {    26207642,    52415283,    26207642,  -253083375,    89478485 } },
+  { 2000, FILTER_LOWPASS,   500, {    78622925,   157245850,    78622925,           0,    46056243 } },
+  { 2000, FILTER_BANDPASS,  100, {    35924862,           0,   -35924862,  -442261430,   196585731 } },
+  { 2000, FILTER_BANDPASS,  250, {    70116381,           0,   -70116381,  -280465525,   128202693 } },
+  { 2000, FILTER_BANDPASS,  500, {    89478485,           0,   -89478485,           0,    89478485 } },
+  // 1000 Hz
+  { 1000, FILTER_DC_BLOCK,    0, {   268013799,  -268013799,           0,  -267592141,           0 } },
+  { 1000, FILTER_HIGHPASS,    2, {   266060767,  -532121534,   266060767,  -532100527,   263707086 } },
+  { 1000, FILTER_HIGHPASS,   10, {   256770117,  -513540234,   256770117,  -513033056,   245611955 } },
+  { 1000, FILTER_LOWPASS,   100, {    18107387,    36214774,    18107387,  -306816492,   110810585 } },
+  { 1000, FILTER_LOWPASS,   250, {    78622925,   157245850,    78622925,           0,    46056243 } },
+  { 1000, FILTER_BANDPASS,  100, {    60971984,           0,   -60971984,  -335682948,   146491487 } },
+  { 1000, FILTER_BANDPASS,  250, {    89478485,           0,   -89478485,           0,    89478485 } },
+  // 500 Hz
+  {  500, FILTER_DC_BLOCK,    0, {   267592141,  -267592141,           0,  -266748826,           0 } },
+  {  500, FILTER_HIGHPASS,    2, {   263707083,  -527414166,   263707083,  -527330872,   259062005 } },
+  {  500, FILTER_HIGHPASS,   10, {   245610159,  -491220318,   245610159,  -489275943,   224729238 } },
+  {  500, FILTER_LOWPASS,   100, {    55451272,   110902543,    55451272,   -99194250,    52563880 } },
+  {  500, FILTER_BANDPASS,  100, {    86510471,           0,   -86510471,  -112435824,    95414514 } },
+  // 250 Hz
+  {  250, FILTER_DC_BLOCK,    0, {   266748826,  -266748826,           0,  -265062197,           0 } },
+  {  250, FILTER_HIGHPASS,    2, {   259061955,  -518123910,   259061955,  -517796496,   250015867 } },
+  {  250, FILTER_HIGHPASS,   10, {   224704419,  -449408838,   224704419,  -442236671,   188145547 } },
+  {  250, FILTER_LOWPASS,   100, {   171515633,   343031267,   171515633,   306816492,   110810585 } },
+  {  250, FILTER_BANDPASS,  100, {    60971984,           0,   -60971984,   335682948,   146491487 } },
+};
+
+SampleFilter::SampleFilter() : sample_rate_hz(SAMPLE_RATE_HZ), any_active(false), rejected_sections(0),
+                               designed_sections(0), settings_pending(true) {
+  memset(filters, 0, sizeof(filters));
+  memset(active, 0, sizeof(active));
+  for (uint8_t a = 0; a < 3; a++) {
+    requested_mode[a] = DEFAULT_FILTER_MODE;
+    requested_highpass_hz[a] = DEFAULT_FILTER_HIGHPASS_HZ;
+    requested_lowpass_hz[a] = DEFAULT_FILTER_LOWPASS_HZ;
+    requested_bandpass_hz[a] = DEFAULT_FILTER_BANDPASS_HZ;
+  }
+}
+
+void SampleFilter::configure(uint8_t axis, uint8_t mode, uint16_t highpass_hz, uint16_t lowpass_hz,
+                             uint16_t bandpass_hz) {
+  if (axis >= 3) {
+    return;
+  }
+  requested_mode[axis] = mode;
+  requested_highpass_hz[axis] = highpass_hz;
+  requested_lowpass_hz[axis] = lowpass_hz;
+  requested_bandpass_hz[axis] = bandpass_hz;
+  settings_pending = true;
+}
+
+void SampleFilter::setSampleRate(uint16_t sample_rate) {
+  sample_rate_hz = sample_rate ? sample_rate : SAMPLE_RATE_HZ;
+  applySettings();
+}
+
+bool SampleFilter::lookupCoeffs(uint8_t type, uint16_t sample_rate, uint16_t corner_hz, BiquadCoeffs& out) {
+  if (type == FILTER_DC_BLOCK) {
+    corner_hz = 0;
+  }
+  for (size_t i = 0; i < sizeof(biquad_table) / sizeof(biquad_table[0]); i++) {
+    const BiquadTableEntry& entry = biquad_table[i];
+    if (entry.sample_rate_hz == sample_rate && entry.type == type && entry.corner_hz == corner_hz) {
+      out = entry.coeffs;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool SampleFilter::designCoeffs(uint8_t type, uint16_t sample_rate, uint16_t corner_hz, BiquadCoeffs& out) {
+  if (sample_rate == 0) {
+    return false;
+  }
+  const double one = (double)(1L << FILTER_COEFF_FRAC_BITS);
+  double b0, b1, b2, a1, a2;
+
+  if (type == FILTER_DC_BLOCK) {
+    // Scaled by (1 + r) / 2 for unity gain at Nyquist
+    const double r = 1.0 - 2.0 * M_PI * FILTER_DC_BLOCK_HZ / sample_rate;
+    b0 = (1.0 + r) / 2.0;
+    b1 = -b0;
+    b2 = 0.0;
+    a1 = -r;
+    a2 = 0.0;
+  } else {
+    // Corners too close to Nyquist warp badly; treat them as unusable
+    if (corner_hz == 0 || corner_hz >= 0.45 * sample_rate) {
+      return false;
+    }
+    const double w0 = 2.0 * M_PI * corner_hz / sample_rate;
+    const double c = cos(w0);
+    const double q = (type == FILTER_BANDPASS) ? FILTER_BANDPASS_Q : M_SQRT1_2;
+    const double alpha = sin(w0) / (2.0 * q);
+    const double a0 = 1.0 + alpha;
+
+    switch (type) {
+      case FILTER_HIGHPASS:
+        b0 = (1.0 + c) / 2.0;
+        b1 = -(1.0 + c);
+        b2 = (1.0 + c) / 2.0;
+        break;
+      case FILTER_LOWPASS:
+        b0 = (1.0 - c) / 2.0;
+        b1 = 1.0 - c;
+        b2 = (1.0 - c) / 2.0;
+        break;
+      case FILTER_BANDPASS:
+        b0 = alpha;
+        b1 = 0.0;
+        b2 = -alpha;
+        break;
+      default:
+        return false;
+    }
+    b0 /= a0;
+    b1 /= a0;
+    b2 /= a0;
+    a1 = -2.0 * c / a0;
+    a2 = (1.0 - alpha) / a0;
+  }
+
+  out.b0 = (int32_t)lround(b0 * one);
+  out.b1 = (int32_t)lround(b1 * one);
+  out.b2 = (int32_t)lround(b2 * one);
+  out.a1 = (int32_t)lround(a1 * one);
+  out.a2 = (int32_t)lround(a2 * one);
+  if (type == FILTER_HIGHPASS) {
+    // Rounded separately, b1 can miss -2 b0 by one LSB; at a low corner that
+    // is a DC gain of several counts per g, so make the zeros exact
+    out.b1 = -2 * out.b0;
+  }
+  return true;
+}
+
+void SampleFilter::applySettings() {
+  settings_pending = false;
+  any_active = false;
+  rejected_sections = 0;
+  designed_sections = 0;
+
+  for (uint8_t a = 0; a < 3; a++) {
+    AxisFilterConfig& config = active[a];
+    config.mode = requested_mode[a];
+    config.highpass_hz = requested_highpass_hz[a];
+    config.lowpass_hz = requested_lowpass_hz[a];
+    config.bandpass_hz = requested_bandpass_hz[a];
+
+    BiquadCoeffs coeffs[FILTER_MAX_SECTIONS];
+    uint8_t sections = 0;
+    for (uint8_t type = 0; type < FILTER_MAX_SECTIONS; type++) {
+      if (!(config.mode & (1 << type))) {
+        continue;
+      }
+      uint16_t corner = type == FILTER_HIGHPASS ? config.highpass_hz :
+                        type == FILTER_LOWPASS ? config.lowpass_hz :
+                        type == FILTER_BANDPASS ? config.bandpass_hz : 0;
+      if (lookupCoeffs(type, sample_rate_hz, corner, coeffs[sections])) {
+        sections++;
+      } else if (designCoeffs(type, sample_rate_hz, corner, coeffs[sections])) {
+        sections++;
+        designed_sections++;
+      } else {
+        rejected_sections++;
+      }
+    }
+
+    // New coefficients start from rest; old state would ring through them
+    for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+      AxisFilter& filter = filters[ch][a];
+      memcpy(filter.coeffs, coeffs, sizeof(coeffs[0]) * sections);
+      filter.sections = sections;
+      filter.clearState();
+    }
+    if (sections > 0) {
+      any_active = true;
+    }
+  }
+
+  #if ENABLE_DEBUG_OUTPUT
+  Serial.printf("[FILTER] Modes X=0x%X Y=0x%X Z=0x%X @ %d Hz (%d designed, %d rejected)\n",
+                active[0].mode, active[1].mode, active[2].mode, sample_rate_hz,
+                designed_sections, rejected_sections);
+  #endif
+}
+
+void SampleFilter::printInfo() const {
+  static const char axis_names[] = { 'X', 'Y', 'Z' };
+  for (uint8_t a = 0; a < 3; a++) {
+    Serial.printf("Filter %c: %d sections (mode 0x%X, HP %d Hz, LP %d Hz, BP %d Hz)\n", axis_names[a],
+                  filters[0][a].sections, active[a].mode, active[a].highpass_hz, active[a].lowpass_hz,
+                  active[a].bandpass_hz);
+  }
+  if (rejected_sections > 0) {
+    Serial.printf("Filter: %d sections rejected at %d Hz (corner >= 0.45 * rate)\n", rejected_sections,
+                  sample_rate_hz);
+  }
+}
@@ -0,0 +1,166 @@
+#include "goertzel.h"
+#include <math.h>
+
+ToneBank toneBank;
+
+ToneBank::ToneBank() : num_tones(0), block_samples(0), sample_rate_hz(SAMPLE_RATE_HZ), counts_per_g(0),
+                       settings_pending(false) {
+  const uint16_t defaults[GOERTZEL_NUM_TONES] = DEFAULT_TONE_FREQS_DHZ;
+  for (uint8_t t = 0; t < GOERTZEL_NUM_TONES; t++) {
+    requested_dhz[t] = defaults[t];
+  }
+  memset(coeff, 0, sizeof(coeff));
+  memset(frequency_dhz, 0, sizeof(frequency_dhz));
+  memset(tone_slot, 0, sizeof(tone_slot));
+  memset(snapshots, 0, sizeof(snapshots));
+  memset(results, 0, sizeof(results));
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    clearState(ch);
+  }
+  results_lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+void ToneBank::configure(uint16_t sample_rate, int32_t counts_per_g, uint16_t block_length) {
+  sample_rate_hz = sample_rate ? sample_rate : SAMPLE_RATE_HZ;
+  this->counts_per_g = counts_per_g;
+  block_samples = block_length;
+  applySettings();
+}
+
+void ToneBank::setFrequencies(const uint16_t* frequency_dhz) {
+  for (uint8_t t = 0; t < GOERTZEL_NUM_TONES; t++) {
+    requested_dhz[t] = frequency_dhz[t];
+  }
+  settings_pending = true;
+}
+
+void ToneBank::applySettings() {
+  settings_pending = false;
+  num_tones = 0;
+
+  for (uint8_t slot = 0; slot < GOERTZEL_NUM_TONES; slot++) {
+    uint16_t dhz = requested_dhz[slot];
+    // Targets at or above Nyquist cannot be tracked; report them as off
+    if (dhz == 0 || (uint32_t)dhz >= (uint32_t)sample_rate_hz * 5) {
+      frequency_dhz[slot] = 0;
+      continue;
+    }
+    frequency_dhz[slot] = dhz;
+    const double w = 2.0 * M_PI * dhz / (10.0 * sample_rate_hz);
+    const double c = 2.0 * cos(w) * (double)(1L << GOERTZEL_COEFF_FRAC_BITS);
+    coeff[num_tones] = c >= 2147483647.0 ? 2147483647 : (int32_t)lround(c);
+    tone_slot[num_tones] = slot;
+    num_tones++;
+  }
+
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    clearState(ch);
+  }
+
+  #if ENABLE_DEBUG_OUTPUT
+  Serial.printf("[TONES] %d tones (%d.%d, %d.%d, %d.%d, %d.%d Hz), %d-sample blocks @ %d Hz\n", num_tones,
+                frequency_dhz[0] / 10, frequency_dhz[0] % 10, frequency_dhz[1] / 10, frequency_dhz[1] % 10,
+                frequency_dhz[2] / 10, frequency_dhz[2] % 10, frequency_dhz[3] / 10, frequency_dhz[3] % 10,
+                block_samples, sample_rate_hz);
+  #endif
+}
+
+void ToneBank::clearState(uint8_t channel) {
+  memset(s1[channel], 0, sizeof(s1[channel]));
+  memset(s2[channel], 0, sizeof(s2[channel]));
+  memset(sum[channel], 0, sizeof(sum[channel]));
+  count[channel] = 0;
+}
+
+void ToneBank::finishBlock(uint8_t channel) {
+  portENTER_CRITICAL(&results_lock);
+  ToneSnapshot& snap = snapshots[channel];
+  memcpy(snap.s1, s1[channel], sizeof(snap.s1));
+  memcpy(snap.s2, s2[channel], sizeof(snap.s2));
+  memcpy(snap.sum, sum[channel], sizeof(snap.sum));
+  memcpy(snap.coeff, coeff, sizeof(snap.coeff));
+  memcpy(snap.tone_slot, tone_slot, sizeof(snap.tone_slot));
+  memcpy(snap.frequency_dhz, frequency_dhz, sizeof(snap.frequency_dhz));
+  snap.num_tones = num_tones;
+  snap.block_samples = count[channel];
+  snap.sample_rate_hz = sample_rate_hz;
+  snap.counts_per_g = counts_per_g;
+  snap.sequence++;
+  snap.valid = true;
+  portEXIT_CRITICAL(&results_lock);
+
+  clearState(channel);
+}
+
+bool ToneBank::getResult(uint8_t channel, ToneResult& out) const {
+  if (channel >= NUM_ACCEL_CHANNELS) {
+    return false;
+  }
+  ToneSnapshot snap;
+  portENTER_CRITICAL(&results_lock);
+  if (results[channel].valid && results[channel].sequence == snapshots[channel].sequence) {
+    out = results[channel];
+    portEXIT_CRITICAL(&results_lock);
+    return true;
+  }
+  snap = snapshots[channel];
+  portEXIT_CRITICAL(&results_lock);
+
+  memset(&out, 0, sizeof(out));
+  if (!snap.valid || snap.block_samples == 0 || snap.counts_per_g <= 0) {
+    return false;
+  }
+  memcpy(out.frequency_dhz, snap.frequency_dhz, sizeof(out.frequency_dhz));
+  out.block_samples = snap.block_samples;
+  out.sequence = snap.sequence;
+  out.valid = true;
+
+  const double n = snap.block_samples;
+  for (uint8_t t = 0; t < snap.num_tones; t++) {
+    // The frequency the quantized coefficient actually resonates at
+    const double w = acos((double)snap.coeff[t] / (double)(1UL << (GOERTZEL_COEFF_FRAC_BITS + 1)));
+    const double c = cos(w), s = sin(w);
+
+    // X = sum x[n] e^-jwn = e^-jw(N-1) (s1 - e^-jw s2)
+    const double rot_c = cos(w * (n - 1)), rot_s = sin(w * (n - 1));
+    // The mean's share, m * sum e^-jwn, taken out so gravity does not leak in
+    const double dc_mag = sin(n * w / 2.0) / sin(w / 2.0);
+    const double dc_c = cos(w * (n - 1) / 2.0), dc_s = sin(w * (n - 1) / 2.0);
+
+    const uint8_t slot = snap.tone_slot[t];
+    for (uint8_t a = 0; a < 3; a++) {
+      const double yr = (double)snap.s1[t][a] - c * (double)snap.s2[t][a];
+      const double yi = s * (double)snap.s2[t][a];
+      const double mean = (double)snap.sum[a] / n;
+      const double xr = yr * rot_c + yi * rot_s - mean * dc_mag * dc_c;
+      const double xi = yi * rot_c - yr * rot_s + mean * dc_mag * dc_s;
+
+      out.amplitude_g[slot][a] = (float)(2.0 * sqrt(xr * xr + xi * xi) / (n * snap.counts_per_g));
+      out.phase_deg[slot][a] = (float)(atan2(xi, xr) * 180.0 / M_PI);
+    }
+  }
+
+  // Two readers finishing the same block store the same result
+  portENTER_CRITICAL(&results_lock);
+  if (snapshots[channel].sequence == snap.sequence) {
+    results[channel] = out;
+  }
+  portEXIT_CRITICAL(&results_lock);
+  return true;
+}
+
+void ToneBank::printInfo() const {
+  ToneResult result;
+  if (!getResult(0, result)) {
+    Serial.printf("Tones: %d tracked, no block yet\n", num_tones);
+    return;
+  }
+  for (uint8_t t = 0; t < GOERTZEL_NUM_TONES; t++) {
+    if (result.frequency_dhz[t] == 0) {
+      continue;
+    }
+    Serial.printf("Tone %d: %d.%d Hz, X %.4f g @ %.1f deg, Y %.4f g, Z %.4f g (%d-sample blocks)\n", t,
+                  result.frequency_dhz[t] / 10, result.frequency_dhz[t] % 10, result.amplitude_g[t][0],
+                  result.phase_deg[t][0], result.amplitude_g[t][1], result.amplitude_g[t][2], result.block_samples);
+  }
+}
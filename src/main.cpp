@@ -2,7 +2,9 @@
 #include "config.h"
 
 // Test mode selection based on build flags
-#ifdef SERIAL_MONITOR_TEST
+#ifdef PIO_UNIT_TESTING
+  #define ACTIVE_TEST_MODE 0  // pio test: the suite provides setup() and loop()
+#elif defined(SERIAL_MONITOR_TEST)
   #define ACTIVE_TEST_MODE 1
 #elif defined(MODBUS_TEST_MODE)
   #define ACTIVE_TEST_MODE 2
@@ -237,7 +239,7 @@ void loop() {
     }
 }
 
-#else
+#elif ACTIVE_TEST_MODE == 4
 
 // Production mode: Full application with accelerometer abstraction
 #include "accelerometer_interface.h"
@@ -246,9 +248,14 @@ void loop() {
 #include "modbus_interface.h"
 #include "task_manager.h"
 
-// Global objects
-DataBuffer dataBuffer;
-Analytics analytics;
+// Global objects - one buffer and analytics pipeline per acquisition channel
+ChannelBuffer dataBuffers[NUM_ACCEL_CHANNELS];  // Statically sized, no heap use
+Analytics analyticsChannels[NUM_ACCEL_CHANNELS];
+SlidingWindow slidingWindows[NUM_ACCEL_CHANNELS];
+PackedHistory sampleHistory[NUM_ACCEL_CHANNELS];
+PackedHistory trendHistory[NUM_ACCEL_CHANNELS];
+ChannelBuffer& dataBuffer = dataBuffers[0];
+Analytics& analytics = analyticsChannels[0];
 ModbusInterface modbusInterface;
 
 void setup() {
@@ -272,16 +279,48 @@ void setup() {
     Serial.println("Accelerometer initialized successfully!");
   }
   
-  // Initialize data buffer
-  if (!dataBuffer.begin()) {
-    Serial.println("Failed to initialize data buffer!");
-    while(1); // Halt on failure
+  // Initialize data buffers and analytics for every channel
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    if (!dataBuffers[ch].begin()) {
+      Serial.printf("Failed to initialize data buffer for channel %d!\n", ch);
+      while(1); // Halt on failure
+    }
+    
+    if (!slidingWindows[ch].begin()) {
+      Serial.printf("Failed to initialize sliding window for channel %d!\n", ch);
+      while(1); // Halt on failure
+    }
+    
+    if (!analyticsChannels[ch].begin()) {
+      Serial.printf("Failed to initialize analytics for channel %d!\n", ch);
+      while(1); // Halt on failure
+    }
   }
   
-  // Initialize analytics
-  if (!analytics.begin()) {
-    Serial.println("Failed to initialize analytics!");
-    while(1); // Halt on failure
+  spectrumAnalyzer.begin();
+  envelopeAnalyzer.begin();
+  
+  // Event slots are allocated before the history so it cannot starve them
+  if (!eventCapture.begin()) {
+    Serial.println("WARNING: Event capture disabled");
+  }
+  
+  // Both histories are optional and get fixed internal-RAM budgets without
+  // PSRAM. The smaller trend history goes first so the raw history, which
+  // only falls short of its budget on a tight heap, cannot crowd it out.
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    uint32_t trend_rate = SAMPLE_RATE_HZ >> TREND_DECIMATION_STAGES;
+    if (!trendHistory[ch].begin((uint32_t)TREND_HISTORY_SECONDS * trend_rate,
+                                (uint32_t)TREND_INTERNAL_SECONDS * trend_rate)) {
+      Serial.printf("WARNING: No trend history for channel %d\n", ch);
+    }
+  }
+  
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    if (!sampleHistory[ch].begin((uint32_t)HISTORY_SECONDS * SAMPLE_RATE_HZ,
+                                 (uint32_t)HISTORY_INTERNAL_SECONDS * SAMPLE_RATE_HZ)) {
+      Serial.printf("WARNING: No sample history for channel %d\n", ch);
+    }
   }
   
   #if ENABLE_MODBUS_INTERFACE
@@ -338,6 +377,16 @@ void loop() {
     last_stats_time = millis();
   }
   
+  // Announce captured events; 'e' on the console dumps the newest one as CSV
+  static uint32_t events_seen = 0;
+  if (eventCapture.getTotalCount() != events_seen) {
+    events_seen = eventCapture.getTotalCount();
+    Serial.printf("Event #%lu captured - send 'e' to dump it\n", (unsigned long)events_seen);
+  }
+  if (Serial.available() && Serial.read() == 'e') {
+    eventCapture.printEvent(0);
+  }
+  
   // Small delay to prevent watchdog issues
   delay(500);  // Increased from 100ms to reduce loop frequency
 }
@@ -1,6 +1,7 @@
 #include "modbus_rtu_custom.h"
 #include "config.h"
 #include "task_manager.h"
+#include "accelerometer_interface.h"
 
 // Global instance
 ModbusRTUCustom modbusRTU;
@@ -52,6 +53,8 @@ ModbusRTUCustom::ModbusRTUCustom() {
   last_byte_time = 0;
   frame_timeout = MODBUS_T35_US;
   last_update_time = 0;
+  config_generation_seen = 0;
+  config_errors_seen = 0;
   
   // Initialize registers with default values
   memset(holding_registers, 0, sizeof(holding_registers));
@@ -61,6 +64,33 @@ ModbusRTUCustom::ModbusRTUCustom() {
   holding_registers[REG_DEVICE_ID] = 0x1234;  // Device ID
   holding_registers[REG_FIRMWARE_VERSION] = FIRMWARE_VERSION;
   holding_registers[REG_SAMPLE_RATE] = 1000;  // 1kHz default
+  holding_registers[REG_ACCEL_RANGE] = DEFAULT_ACCEL_RANGE_G;
+  holding_registers[REG_HPF_CORNER] = DEFAULT_HPF_CORNER;
+  holding_registers[REG_SENSOR_LPF] = DEFAULT_SENSOR_LPF;
+  holding_registers[REG_WINDOW_LENGTH_MS] = DEFAULT_WINDOW_LENGTH_MS;
+  holding_registers[REG_HOP_LENGTH_MS] = DEFAULT_HOP_LENGTH_MS;
+  holding_registers[REG_EVENT_THRESHOLD_MG] = DEFAULT_EVENT_THRESHOLD_MG;
+  holding_registers[REG_EVENT_PRE_MS] = DEFAULT_EVENT_PRE_MS;
+  holding_registers[REG_EVENT_POST_MS] = DEFAULT_EVENT_POST_MS;
+  const uint16_t band_edges[SPECTRUM_NUM_BANDS + 1] = SPECTRUM_DEFAULT_BAND_EDGES_HZ;
+  for (uint8_t b = 0; b <= SPECTRUM_NUM_BANDS; b++) {
+    holding_registers[REG_BAND_EDGE_BASE + b] = band_edges[b];
+  }
+  for (uint8_t a = 0; a < 3; a++) {
+    uint16_t base = REG_FILTER_BASE + a * REG_FILTER_AXIS_SIZE;
+    holding_registers[base + REG_FLT_MODE] = DEFAULT_FILTER_MODE;
+    holding_registers[base + REG_FLT_HIGHPASS_HZ] = DEFAULT_FILTER_HIGHPASS_HZ;
+    holding_registers[base + REG_FLT_LOWPASS_HZ] = DEFAULT_FILTER_LOWPASS_HZ;
+    holding_registers[base + REG_FLT_BANDPASS_HZ] = DEFAULT_FILTER_BANDPASS_HZ;
+  }
+  holding_registers[REG_ISO_MACHINE_CLASS] = DEFAULT_ISO_MACHINE_CLASS;
+  holding_registers[REG_VELOCITY_HIGHPASS_HZ] = DEFAULT_VELOCITY_HIGHPASS_HZ;
+  holding_registers[REG_ENVELOPE_BAND_LOW_HZ] = DEFAULT_ENVELOPE_BAND_LOW_HZ;
+  holding_registers[REG_ENVELOPE_BAND_HIGH_HZ] = DEFAULT_ENVELOPE_BAND_HIGH_HZ;
+  const uint16_t tones[GOERTZEL_NUM_TONES] = DEFAULT_TONE_FREQS_DHZ;
+  for (uint8_t t = 0; t < GOERTZEL_NUM_TONES; t++) {
+    holding_registers[REG_TONE_FREQ_BASE + t] = tones[t];
+  }
   
   // Reset statistics
   memset(&stats, 0, sizeof(stats));
@@ -114,6 +144,7 @@ void ModbusRTUCustom::update() {
   
   // Update registers from analytics data
   if (millis() - last_update_time > 100) {  // Update every 100ms
+    updateConfigRegisters();
     updateRegistersFromAnalytics();
     last_update_time = millis();
   }
@@ -340,8 +371,35 @@ void ModbusRTUCustom::handleWriteSingleRegister(uint8_t* frame, uint16_t length)
     return;
   }
   
+  if (!isValidHoldingWrite(address, value)) {
+    sendExceptionResponse(frame[1], MODBUS_EX_ILLEGAL_DATA_VALUE);
+    return;
+  }
+  
   holding_registers[address] = value;
   
+  if (isConfigRegister(address)) {
+    applyConfigRegisters();
+  }
+  if (isEventRegister(address)) {
+    applyEventRegisters();
+  }
+  if (isSpectrumRegister(address)) {
+    applySpectrumRegisters();
+  }
+  if (isFilterRegister(address)) {
+    applyFilterRegisters();
+  }
+  if (isVelocityRegister(address)) {
+    applyVelocityRegisters();
+  }
+  if (isEnvelopeRegister(address)) {
+    applyEnvelopeRegisters();
+  }
+  if (isToneRegister(address)) {
+    applyToneRegisters();
+  }
+  
   // Echo the request as response
   memcpy(tx_buffer, frame, length);
   tx_buffer_length = length;
@@ -367,10 +425,55 @@ void ModbusRTUCustom::handleWriteMultipleRegisters(uint8_t* frame, uint16_t leng
     return;
   }
   
+  // Validate every value before writing any, so a bad frame changes nothing
+  for (uint16_t i = 0; i < quantity; i++) {
+    uint16_t value = bytesToUint16(frame[7 + i*2], frame[8 + i*2]);
+    if (!isValidHoldingWrite(start_address + i, value)) {
+      sendExceptionResponse(frame[1], MODBUS_EX_ILLEGAL_DATA_VALUE);
+      return;
+    }
+  }
+  
   // Write registers
+  bool config_changed = false;
+  bool event_changed = false;
+  bool spectrum_changed = false;
+  bool filter_changed = false;
+  bool velocity_changed = false;
+  bool envelope_changed = false;
+  bool tone_changed = false;
   for (uint16_t i = 0; i < quantity; i++) {
     uint16_t value = bytesToUint16(frame[7 + i*2], frame[8 + i*2]);
     holding_registers[start_address + i] = value;
+    if (isConfigRegister(start_address + i)) config_changed = true;
+    if (isEventRegister(start_address + i)) event_changed = true;
+    if (isSpectrumRegister(start_address + i)) spectrum_changed = true;
+    if (isFilterRegister(start_address + i)) filter_changed = true;
+    if (isVelocityRegister(start_address + i)) velocity_changed = true;
+    if (isEnvelopeRegister(start_address + i)) envelope_changed = true;
+    if (isToneRegister(start_address + i)) tone_changed = true;
+  }
+  
+  if (config_changed) {
+    applyConfigRegisters();
+  }
+  if (event_changed) {
+    applyEventRegisters();
+  }
+  if (spectrum_changed) {
+    applySpectrumRegisters();
+  }
+  if (filter_changed) {
+    applyFilterRegisters();
+  }
+  if (velocity_changed) {
+    applyVelocityRegisters();
+  }
+  if (envelope_changed) {
+    applyEnvelopeRegisters();
+  }
+  if (tone_changed) {
+    applyToneRegisters();
   }
   
   // Build response
@@ -477,7 +580,12 @@ void ModbusRTUCustom::appendCRC(uint8_t* frame, uint16_t length) {
 
 void ModbusRTUCustom::updateRegistersFromAnalytics() {
   // Only update if analytics is available and initialized
-  extern Analytics analytics;
+  updateChannelBanks();
+  updateSpectrumRegisters();
+  updateVelocityRegisters();
+  updateEnvelopeRegisters();
+  updateToneRegisters();
+  
   if (!analytics.isInitialized()) {
     #if ENABLE_DEBUG_OUTPUT
     Serial.println("[Modbus] Analytics not initialized - using test values");
@@ -516,59 +624,27 @@ void ModbusRTUCustom::updateRegistersFromAnalytics() {
   #if ENABLE_DEBUG_OUTPUT
   static unsigned long last_modbus_debug = 0;
   if (millis() - last_modbus_debug > 2000) {  // Debug every 2 seconds
-    Serial.printf("[Modbus-DEBUG] Analytics data (g-values) - X: %.6f, Y: %.6f, Z: %.6f\n", 
-                  data.current_avg_x, data.current_avg_y, data.current_avg_z);
-    Serial.printf("[Modbus-DEBUG] Max values (g-values) - X: %.6f, Y: %.6f, Z: %.6f\n", 
-                  data.current_max_x, data.current_max_y, data.current_max_z);
-    Serial.printf("[Modbus-DEBUG] STD values (g-values) - X: %.6f, Y: %.6f, Z: %.6f\n", 
-                  data.current_std_x, data.current_std_y, data.current_std_z);
-    Serial.printf("[Modbus-DEBUG] RMS values (g-values) - X: %.6f, Y: %.6f, Z: %.6f\n", 
-                  data.current_rms_x, data.current_rms_y, data.current_rms_z);
+    Serial.printf("[Modbus-DEBUG] Analytics data (Q.8 counts @ %ld LSB/g) - X: %ld, Y: %ld, Z: %ld\n", 
+                  (long)data.counts_per_g, (long)data.current_avg_x, (long)data.current_avg_y, (long)data.current_avg_z);
+    Serial.printf("[Modbus-DEBUG] Max values (Q.8 counts) - X: %ld, Y: %ld, Z: %ld\n", 
+                  (long)data.current_max_x, (long)data.current_max_y, (long)data.current_max_z);
+    Serial.printf("[Modbus-DEBUG] STD values (Q.8 counts) - X: %ld, Y: %ld, Z: %ld\n", 
+                  (long)data.current_std_x, (long)data.current_std_y, (long)data.current_std_z);
+    Serial.printf("[Modbus-DEBUG] RMS values (Q.8 counts) - X: %ld, Y: %ld, Z: %ld\n", 
+                  (long)data.current_rms_x, (long)data.current_rms_y, (long)data.current_rms_z);
     
-    // Show what happens when we convert to scaled integers
-    int32_t scaled_x = (int32_t)(data.current_avg_x * MODBUS_SCALE_FACTOR);
-    int32_t scaled_y = (int32_t)(data.current_avg_y * MODBUS_SCALE_FACTOR);
-    int32_t scaled_z = (int32_t)(data.current_avg_z * MODBUS_SCALE_FACTOR);
-    Serial.printf("[Modbus-DEBUG] Scaled for Modbus: X=%ld, Y=%ld, Z=%ld (should be in ±32767 range)\n", 
-                  scaled_x, scaled_y, scaled_z);
+    // Show what the registers will hold
+    Serial.printf("[Modbus-DEBUG] Scaled for Modbus (mg): X=%d, Y=%d, Z=%d\n", 
+                  countsToScaledInt(data.current_avg_x, data.counts_per_g),
+                  countsToScaledInt(data.current_avg_y, data.counts_per_g),
+                  countsToScaledInt(data.current_avg_z, data.counts_per_g));
     
     last_modbus_debug = millis();
   }
   #endif
   
-  // Update current window statistics
-  input_registers[REG_CURRENT_AVG_X] = floatToScaledInt(data.current_avg_x);
-  input_registers[REG_CURRENT_AVG_Y] = floatToScaledInt(data.current_avg_y);
-  input_registers[REG_CURRENT_AVG_Z] = floatToScaledInt(data.current_avg_z);
-  input_registers[REG_CURRENT_MAX_X] = floatToScaledInt(data.current_max_x);
-  input_registers[REG_CURRENT_MAX_Y] = floatToScaledInt(data.current_max_y);
-  input_registers[REG_CURRENT_MAX_Z] = floatToScaledInt(data.current_max_z);
-  input_registers[REG_CURRENT_MIN_X] = floatToScaledInt(data.current_min_x);
-  input_registers[REG_CURRENT_MIN_Y] = floatToScaledInt(data.current_min_y);
-  input_registers[REG_CURRENT_MIN_Z] = floatToScaledInt(data.current_min_z);
-  input_registers[REG_CURRENT_STD_X] = floatToScaledInt(data.current_std_x);
-  input_registers[REG_CURRENT_STD_Y] = floatToScaledInt(data.current_std_y);
-  input_registers[REG_CURRENT_STD_Z] = floatToScaledInt(data.current_std_z);
-  input_registers[REG_CURRENT_RMS_X] = floatToScaledInt(data.current_rms_x);
-  input_registers[REG_CURRENT_RMS_Y] = floatToScaledInt(data.current_rms_y);
-  input_registers[REG_CURRENT_RMS_Z] = floatToScaledInt(data.current_rms_z);
-  
-  // Update running statistics
-  input_registers[REG_RUNNING_AVG_X] = floatToScaledInt(data.running_avg_x);
-  input_registers[REG_RUNNING_AVG_Y] = floatToScaledInt(data.running_avg_y);
-  input_registers[REG_RUNNING_AVG_Z] = floatToScaledInt(data.running_avg_z);
-  input_registers[REG_RUNNING_STD_X] = floatToScaledInt(data.running_std_x);
-  input_registers[REG_RUNNING_STD_Y] = floatToScaledInt(data.running_std_y);
-  input_registers[REG_RUNNING_STD_Z] = floatToScaledInt(data.running_std_z);
-  input_registers[REG_RUNNING_RMS_X] = floatToScaledInt(data.running_rms_x);
-  input_registers[REG_RUNNING_RMS_Y] = floatToScaledInt(data.running_rms_y);
-  input_registers[REG_RUNNING_RMS_Z] = floatToScaledInt(data.running_rms_z);
-  input_registers[REG_GLOBAL_MAX_X] = floatToScaledInt(data.global_max_x);
-  input_registers[REG_GLOBAL_MAX_Y] = floatToScaledInt(data.global_max_y);
-  input_registers[REG_GLOBAL_MAX_Z] = floatToScaledInt(data.global_max_z);
-  input_registers[REG_GLOBAL_MIN_X] = floatToScaledInt(data.global_min_x);
-  input_registers[REG_GLOBAL_MIN_Y] = floatToScaledInt(data.global_min_y);
-  input_registers[REG_GLOBAL_MIN_Z] = floatToScaledInt(data.global_min_z);
+  // Channel 0 statistics at the legacy addresses
+  updateStatsRegisters(0, data);
   
   // Update system status
   input_registers[REG_TASK_STATUS] = getTaskStatusFlags();
@@ -578,12 +654,352 @@ void ModbusRTUCustom::updateRegistersFromAnalytics() {
   holding_registers[REG_WINDOW_COUNT_HIGH] = (data.window_count >> 16) & 0xFFFF;
   
   // Update error counts and timing
-  extern TaskManagerStatus task_status;
   input_registers[REG_SAMPLING_ERRORS] = task_status.sampling_errors & 0xFFFF;
   input_registers[REG_PROCESSING_ERRORS] = task_status.processing_errors & 0xFFFF;
   input_registers[REG_ANALYTICS_ERRORS] = task_status.analytics_errors & 0xFFFF;
   input_registers[REG_MISSED_SAMPLES] = task_status.missed_samples & 0xFFFF;
   input_registers[REG_LAST_UPDATE_TIME] = (millis() - data.last_update_time) & 0xFFFF;
+  input_registers[REG_FIFO_OVERRUNS] = task_status.fifo_overruns & 0xFFFF;
+  input_registers[REG_DRDY_JITTER_US] = task_status.drdy_jitter_max_us > 0xFFFF ? 0xFFFF : task_status.drdy_jitter_max_us;
+  input_registers[REG_FILTER_CYCLES] = sampleFilter.isActive() ? task_status.filter_cost.cycles_avg : 0;
+  input_registers[REG_FILTER_OVER_BUDGET] = task_status.filter_cost.over_budget & 0xFFFF;
+  input_registers[REG_DECIMATION_CYCLES] = oversampleDecimator.isActive() ? task_status.decimator_cost.cycles_avg : 0;
+  input_registers[REG_SENSOR_RATE_HZ] = task_status.sensor_rate_hz;
+  input_registers[REG_ENVELOPE_CYCLES] = envelopeAnalyzer.isActive() ? task_status.envelope_cost.cycles_avg : 0;
+  input_registers[REG_ENVELOPE_OVER_BUDGET] = task_status.envelope_cost.over_budget & 0xFFFF;
+  input_registers[REG_TONE_CYCLES] = toneBank.isActive() ? task_status.tone_cost.cycles_avg : 0;
+  input_registers[REG_TONE_OVER_BUDGET] = task_status.tone_cost.over_budget & 0xFFFF;
+  
+  // Event capture summary
+  input_registers[REG_EVENT_COUNT] = eventCapture.getTotalCount() & 0xFFFF;
+  input_registers[REG_EVENT_STORED] = eventCapture.getStoredCount();
+  const EventRecord* newest = eventCapture.getEvent(0);
+  input_registers[REG_EVENT_LAST_SOURCE] = newest ? newest->source : 0;
+  uint32_t age_s = newest ? (millis() - newest->captured_ms) / 1000 : 0;
+  input_registers[REG_EVENT_LAST_AGE_S] = age_s > 0xFFFF ? 0xFFFF : age_s;
+}
+
+void ModbusRTUCustom::updateStatsRegisters(uint16_t base, const AnalyticsData& data) {
+  // Update current window statistics
+  input_registers[base + REG_CURRENT_AVG_X] = countsToScaledInt(data.current_avg_x, data.counts_per_g);
+  input_registers[base + REG_CURRENT_AVG_Y] = countsToScaledInt(data.current_avg_y, data.counts_per_g);
+  input_registers[base + REG_CURRENT_AVG_Z] = countsToScaledInt(data.current_avg_z, data.counts_per_g);
+  input_registers[base + REG_CURRENT_MAX_X] = countsToScaledInt(data.current_max_x, data.counts_per_g);
+  input_registers[base + REG_CURRENT_MAX_Y] = countsToScaledInt(data.current_max_y, data.counts_per_g);
+  input_registers[base + REG_CURRENT_MAX_Z] = countsToScaledInt(data.current_max_z, data.counts_per_g);
+  input_registers[base + REG_CURRENT_MIN_X] = countsToScaledInt(data.current_min_x, data.counts_per_g);
+  input_registers[base + REG_CURRENT_MIN_Y] = countsToScaledInt(data.current_min_y, data.counts_per_g);
+  input_registers[base + REG_CURRENT_MIN_Z] = countsToScaledInt(data.current_min_z, data.counts_per_g);
+  input_registers[base + REG_CURRENT_STD_X] = countsToScaledInt(data.current_std_x, data.counts_per_g);
+  input_registers[base + REG_CURRENT_STD_Y] = countsToScaledInt(data.current_std_y, data.counts_per_g);
+  input_registers[base + REG_CURRENT_STD_Z] = countsToScaledInt(data.current_std_z, data.counts_per_g);
+  input_registers[base + REG_CURRENT_RMS_X] = countsToScaledInt(data.current_rms_x, data.counts_per_g);
+  input_registers[base + REG_CURRENT_RMS_Y] = countsToScaledInt(data.current_rms_y, data.counts_per_g);
+  input_registers[base + REG_CURRENT_RMS_Z] = countsToScaledInt(data.current_rms_z, data.counts_per_g);
+  
+  // Update running statistics
+  input_registers[base + REG_RUNNING_AVG_X] = countsToScaledInt(data.running_avg_x, data.counts_per_g);
+  input_registers[base + REG_RUNNING_AVG_Y] = countsToScaledInt(data.running_avg_y, data.counts_per_g);
+  input_registers[base + REG_RUNNING_AVG_Z] = countsToScaledInt(data.running_avg_z, data.counts_per_g);
+  input_registers[base + REG_RUNNING_STD_X] = countsToScaledInt(data.running_std_x, data.counts_per_g);
+  input_registers[base + REG_RUNNING_STD_Y] = countsToScaledInt(data.running_std_y, data.counts_per_g);
+  input_registers[base + REG_RUNNING_STD_Z] = countsToScaledInt(data.running_std_z, data.counts_per_g);
+  input_registers[base + REG_RUNNING_RMS_X] = countsToScaledInt(data.running_rms_x, data.counts_per_g);
+  input_registers[base + REG_RUNNING_RMS_Y] = countsToScaledInt(data.running_rms_y, data.counts_per_g);
+  input_registers[base + REG_RUNNING_RMS_Z] = countsToScaledInt(data.running_rms_z, data.counts_per_g);
+  input_registers[base + REG_GLOBAL_MAX_X] = countsToScaledInt(data.global_max_x, data.counts_per_g);
+  input_registers[base + REG_GLOBAL_MAX_Y] = countsToScaledInt(data.global_max_y, data.counts_per_g);
+  input_registers[base + REG_GLOBAL_MAX_Z] = countsToScaledInt(data.global_max_z, data.counts_per_g);
+  input_registers[base + REG_GLOBAL_MIN_X] = countsToScaledInt(data.global_min_x, data.counts_per_g);
+  input_registers[base + REG_GLOBAL_MIN_Y] = countsToScaledInt(data.global_min_y, data.counts_per_g);
+  input_registers[base + REG_GLOBAL_MIN_Z] = countsToScaledInt(data.global_min_z, data.counts_per_g);
+}
+
+void ModbusRTUCustom::updateSpectrumRegisters() {
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    SpectrumResult spectrum;
+    if (!spectrumAnalyzer.getResult(ch, spectrum)) {
+      continue;
+    }
+    
+    uint16_t bank = REG_SPECTRUM_BASE + ch * REG_SPECTRUM_BANK_SIZE;
+    for (uint8_t a = 0; a < 3; a++) {
+      const AxisSpectrum& axis = spectrum.axis[a];
+      uint16_t base = bank + a * REG_SPEC_AXIS_SIZE;
+      
+      input_registers[base + REG_SPEC_DOMINANT_FREQ] = (uint16_t)(axis.dominant_hz * 10.0f + 0.5f);
+      input_registers[base + REG_SPEC_DOMINANT_AMP] = floatToScaledInt(axis.dominant_g);
+      for (uint8_t p = 0; p < SPECTRUM_NUM_PEAKS; p++) {
+        input_registers[base + REG_SPEC_PEAK_BASE + 2 * p] = (uint16_t)(axis.peaks[p].frequency_hz * 10.0f + 0.5f);
+        input_registers[base + REG_SPEC_PEAK_BASE + 2 * p + 1] = floatToScaledInt(axis.peaks[p].amplitude_g);
+      }
+      for (uint8_t b = 0; b < SPECTRUM_NUM_BANDS; b++) {
+        input_registers[base + REG_SPEC_BAND_BASE + b] = floatToScaledInt(axis.band_rms_g[b]);
+      }
+    }
+    
+    input_registers[bank + REG_SPEC_SEQUENCE] = spectrum.sequence & 0xFFFF;
+    input_registers[bank + REG_SPEC_RESOLUTION] = (uint16_t)(spectrum.resolution_hz * 1000.0f + 0.5f);
+    input_registers[bank + REG_SPEC_COMPUTE_US] = spectrum.compute_us > 0xFFFF ? 0xFFFF : spectrum.compute_us;
+  }
+}
+
+void ModbusRTUCustom::updateVelocityRegisters() {
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    VelocityResult velocity;
+    if (!velocityMeter.getResult(ch, velocity)) {
+      continue;
+    }
+    
+    uint16_t bank = REG_VELOCITY_BASE + ch * REG_VELOCITY_BANK_SIZE;
+    for (uint8_t a = 0; a < 3; a++) {
+      uint32_t rms = (velocity.rms_um_s[a] + 5) / 10;  // um/s -> 0.01 mm/s
+      input_registers[bank + REG_VEL_RMS_X + a] = rms > 0xFFFF ? 0xFFFF : rms;
+      input_registers[bank + REG_VEL_ZONE_X + a] = velocity.zone[a];
+    }
+    input_registers[bank + REG_VEL_WORST_ZONE] = velocity.worst_zone;
+    input_registers[bank + REG_VEL_SEQUENCE] = velocity.sequence & 0xFFFF;
+  }
+}
+
+void ModbusRTUCustom::updateEnvelopeRegisters() {
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    EnvelopeResult envelope;
+    if (!envelopeAnalyzer.getResult(ch, envelope)) {
+      continue;
+    }
+    
+    uint16_t bank = REG_ENVELOPE_BASE + ch * REG_ENVELOPE_BANK_SIZE;
+    for (uint8_t a = 0; a < 3; a++) {
+      const AxisEnvelope& axis = envelope.axis[a];
+      uint16_t base = bank + a * REG_ENV_AXIS_SIZE;
+      
+      input_registers[base + REG_ENV_RMS] = floatToScaledInt(axis.rms_g);
+      for (uint8_t p = 0; p < ENVELOPE_NUM_PEAKS; p++) {
+        input_registers[base + REG_ENV_PEAK_BASE + 2 * p] = (uint16_t)(axis.peaks[p].frequency_hz * 10.0f + 0.5f);
+        input_registers[base + REG_ENV_PEAK_BASE + 2 * p + 1] = floatToScaledInt(axis.peaks[p].amplitude_g);
+      }
+    }
+    
+    input_registers[bank + REG_ENV_SEQUENCE] = envelope.sequence & 0xFFFF;
+    input_registers[bank + REG_ENV_RESOLUTION] = (uint16_t)(envelope.resolution_hz * 1000.0f + 0.5f);
+    input_registers[bank + REG_ENV_COMPUTE_US] = envelope.compute_us > 0xFFFF ? 0xFFFF : envelope.compute_us;
+  }
+}
+
+void ModbusRTUCustom::updateToneRegisters() {
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    ToneResult tones;
+    if (!toneBank.getResult(ch, tones)) {
+      continue;
+    }
+    
+    uint16_t bank = REG_TONE_BANK_BASE + ch * REG_TONE_BANK_SIZE;
+    for (uint8_t t = 0; t < GOERTZEL_NUM_TONES; t++) {
+      uint16_t base = bank + t * REG_TONE_BLOCK_SIZE;
+      for (uint8_t a = 0; a < 3; a++) {
+        input_registers[base + REG_TONE_AMP_X + 2 * a] = floatToScaledInt(tones.amplitude_g[t][a]);
+        input_registers[base + REG_TONE_AMP_X + 2 * a + 1] = (int16_t)lroundf(tones.phase_deg[t][a] * 10.0f);
+      }
+    }
+    
+    input_registers[bank + REG_TONE_SEQUENCE] = tones.sequence & 0xFFFF;
+    input_registers[bank + REG_TONE_BLOCK_SAMPLES] = tones.block_samples;
+  }
+}
+
+void ModbusRTUCustom::updateChannelBanks() {
+  uint8_t channel_mask = accelerometer.getChannelMask();
+  
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    uint16_t base = REG_CHANNEL_BANK_BASE + ch * REG_CHANNEL_BANK_SIZE;
+    AnalyticsData data = analyticsChannels[ch].getAnalyticsData();
+    
+    if (data.data_valid) {
+      updateStatsRegisters(base, data);
+    }
+    input_registers[base + REG_CH_SENSOR_STATUS] = (channel_mask & (1 << ch)) ? 1 : 0;
+    input_registers[base + REG_CH_WINDOW_COUNT] = data.window_count & 0xFFFF;
+    
+    if (data.data_valid) {
+      updateShapeRegisters(REG_SHAPE_BASE + ch * REG_SHAPE_BANK_SIZE, data);
+    }
+  }
+}
+
+void ModbusRTUCustom::updateShapeRegisters(uint16_t base, const AnalyticsData& data) {
+  const int32_t p2p[3] = { data.current_p2p_x, data.current_p2p_y, data.current_p2p_z };
+  const int32_t crest[3] = { data.current_crest_x, data.current_crest_y, data.current_crest_z };
+  const int32_t skew[3] = { data.current_skew_x, data.current_skew_y, data.current_skew_z };
+  const int32_t kurt[3] = { data.current_kurt_x, data.current_kurt_y, data.current_kurt_z };
+  const uint16_t clipped[3] = { data.current_clipped_x, data.current_clipped_y, data.current_clipped_z };
+  
+  for (uint8_t a = 0; a < 3; a++) {
+    uint16_t axis = base + a * REG_SHAPE_AXIS_SIZE;
+    input_registers[axis + REG_SHAPE_P2P] = countsToScaledInt(p2p[a], data.counts_per_g);
+    input_registers[axis + REG_SHAPE_CREST] = ratioToScaledInt(crest[a]);
+    input_registers[axis + REG_SHAPE_SKEW] = ratioToScaledInt(skew[a]);
+    input_registers[axis + REG_SHAPE_KURT] = ratioToScaledInt(kurt[a]);
+    input_registers[axis + REG_SHAPE_CLIPPED] = clipped[a];
+  }
+  input_registers[base + REG_SHAPE_VECTOR_RMS] = countsToScaledInt(data.current_vector_rms, data.counts_per_g);
+}
+
+bool ModbusRTUCustom::isConfigRegister(uint16_t address) {
+  return address == REG_SAMPLE_RATE || address == REG_ACCEL_RANGE ||
+         address == REG_HPF_CORNER || address == REG_WINDOW_LENGTH_MS ||
+         address == REG_HOP_LENGTH_MS || address == REG_SENSOR_LPF;
+}
+
+bool ModbusRTUCustom::isValidHoldingWrite(uint16_t address, uint16_t value) {
+  // Acquisition settings are checked against the sensor found at boot, so a
+  // write the driver would refuse is rejected here instead
+  const AccelCapabilities caps = accelerometer.getCapabilities();
+  switch (address) {
+    case REG_SAMPLE_RATE:
+      return value >= 1 && value <= caps.max_sample_rate_hz;
+    case REG_ACCEL_RANGE:
+      return (value == 2 || value == 4 || value == 8 || value == 16) && (caps.range_mask & value);
+    case REG_HPF_CORNER:
+      return caps.max_sample_rate_hz > 0 && value <= caps.max_hpf_corner;
+    case REG_SENSOR_LPF:
+      return caps.max_sample_rate_hz > 0 && value <= caps.max_lpf_code;
+    case REG_WINDOW_LENGTH_MS:
+      return value >= 10 && value <= 10000;
+    case REG_HOP_LENGTH_MS:
+      return value <= 10000;
+    case REG_EVENT_PRE_MS:
+    case REG_EVENT_POST_MS:
+      return value <= 10000;
+    case REG_EVENT_TRIGGER:
+      return value <= 1;
+    case REG_ISO_MACHINE_CLASS:
+      return value < ISO_NUM_MACHINE_CLASSES;
+    case REG_VELOCITY_HIGHPASS_HZ:
+      return value >= 1 && value <= 100;
+    case REG_ENVELOPE_BAND_LOW_HZ:
+    case REG_ENVELOPE_BAND_HIGH_HZ:
+      return value >= 1 && value <= 2000;
+    default:
+      if (isToneRegister(address)) {
+        return value <= 20000;  // Nyquist at the highest sample rate, Hz x 10
+      }
+      if (isSpectrumRegister(address)) {
+        return value <= 2000;  // Nyquist at the highest sample rate
+      }
+      if (isFilterRegister(address)) {
+        if ((address - REG_FILTER_BASE) % REG_FILTER_AXIS_SIZE == REG_FLT_MODE) {
+          return value < (1 << FILTER_MAX_SECTIONS);
+        }
+        return value >= 1 && value <= 2000;
+      }
+      return true;
+  }
+}
+
+void ModbusRTUCustom::applyConfigRegisters() {
+  AcquisitionConfig config;
+  config.sensor.sample_rate_hz = holding_registers[REG_SAMPLE_RATE];
+  config.sensor.range_g = holding_registers[REG_ACCEL_RANGE];
+  config.sensor.hpf_corner = holding_registers[REG_HPF_CORNER];
+  config.sensor.lpf_code = holding_registers[REG_SENSOR_LPF];
+  config.window_length_ms = holding_registers[REG_WINDOW_LENGTH_MS];
+  config.hop_length_ms = holding_registers[REG_HOP_LENGTH_MS];
+  
+  if (!requestAcquisitionConfig(config)) {
+    #if ENABLE_DEBUG_OUTPUT
+    Serial.println("[Modbus] Failed to queue configuration change");
+    #endif
+    restoreConfigRegisters();
+    return;
+  }
+  
+  #if ENABLE_DEBUG_OUTPUT
+  Serial.printf("[Modbus] Config requested: %d Hz, ±%dg, HPF %d, LPF %d, window %d ms, hop %d ms\n",
+                config.sensor.sample_rate_hz, config.sensor.range_g, config.sensor.hpf_corner,
+                config.sensor.lpf_code, config.window_length_ms, config.hop_length_ms);
+  #endif
+}
+
+bool ModbusRTUCustom::isEventRegister(uint16_t address) {
+  return address == REG_EVENT_THRESHOLD_MG || address == REG_EVENT_PRE_MS ||
+         address == REG_EVENT_POST_MS || address == REG_EVENT_TRIGGER;
+}
+
+void ModbusRTUCustom::applyEventRegisters() {
+  eventCapture.configure(holding_registers[REG_EVENT_PRE_MS], holding_registers[REG_EVENT_POST_MS],
+                         holding_registers[REG_EVENT_THRESHOLD_MG]);
+  
+  // Trigger is a command, not a setting
+  if (holding_registers[REG_EVENT_TRIGGER]) {
+    holding_registers[REG_EVENT_TRIGGER] = 0;
+    eventCapture.requestTrigger(EVENT_SOURCE_MODBUS);
+  }
+}
+
+bool ModbusRTUCustom::isSpectrumRegister(uint16_t address) {
+  return address >= REG_BAND_EDGE_BASE && address <= REG_BAND_EDGE_BASE + SPECTRUM_NUM_BANDS;
+}
+
+void ModbusRTUCustom::applySpectrumRegisters() {
+  spectrumAnalyzer.setBandEdges(&holding_registers[REG_BAND_EDGE_BASE]);
+}
+
+bool ModbusRTUCustom::isFilterRegister(uint16_t address) {
+  return address >= REG_FILTER_BASE && address < REG_FILTER_BASE + 3 * REG_FILTER_AXIS_SIZE;
+}
+
+void ModbusRTUCustom::applyFilterRegisters() {
+  for (uint8_t a = 0; a < 3; a++) {
+    const uint16_t* block = &holding_registers[REG_FILTER_BASE + a * REG_FILTER_AXIS_SIZE];
+    sampleFilter.configure(a, block[REG_FLT_MODE], block[REG_FLT_HIGHPASS_HZ], block[REG_FLT_LOWPASS_HZ],
+                           block[REG_FLT_BANDPASS_HZ]);
+  }
+}
+
+bool ModbusRTUCustom::isVelocityRegister(uint16_t address) {
+  return address == REG_ISO_MACHINE_CLASS || address == REG_VELOCITY_HIGHPASS_HZ;
+}
+
+void ModbusRTUCustom::applyVelocityRegisters() {
+  velocityMeter.setSettings(holding_registers[REG_ISO_MACHINE_CLASS], holding_registers[REG_VELOCITY_HIGHPASS_HZ]);
+}
+
+bool ModbusRTUCustom::isEnvelopeRegister(uint16_t address) {
+  return address == REG_ENVELOPE_BAND_LOW_HZ || address == REG_ENVELOPE_BAND_HIGH_HZ;
+}
+
+void ModbusRTUCustom::applyEnvelopeRegisters() {
+  envelopeAnalyzer.setBand(holding_registers[REG_ENVELOPE_BAND_LOW_HZ], holding_registers[REG_ENVELOPE_BAND_HIGH_HZ]);
+}
+
+bool ModbusRTUCustom::isToneRegister(uint16_t address) {
+  return address >= REG_TONE_FREQ_BASE && address < REG_TONE_FREQ_BASE + GOERTZEL_NUM_TONES;
+}
+
+void ModbusRTUCustom::applyToneRegisters() {
+  toneBank.setFrequencies(&holding_registers[REG_TONE_FREQ_BASE]);
+}
+
+void ModbusRTUCustom::updateConfigRegisters() {
+  // Reflect the values the sampling task actually applied (e.g. nearest ODR),
+  // or put the old ones back if it refused the request
+  if (task_status.config_generation == config_generation_seen &&
+      task_status.config_errors == config_errors_seen) {
+    return;
+  }
+  config_generation_seen = task_status.config_generation;
+  config_errors_seen = task_status.config_errors;
+  restoreConfigRegisters();
+}
+
+void ModbusRTUCustom::restoreConfigRegisters() {
+  holding_registers[REG_SAMPLE_RATE] = active_acquisition_config.sensor.sample_rate_hz;
+  holding_registers[REG_ACCEL_RANGE] = active_acquisition_config.sensor.range_g;
+  holding_registers[REG_HPF_CORNER] = active_acquisition_config.sensor.hpf_corner;
+  holding_registers[REG_SENSOR_LPF] = active_acquisition_config.sensor.lpf_code;
+  holding_registers[REG_WINDOW_LENGTH_MS] = active_acquisition_config.window_length_ms;
+  holding_registers[REG_HOP_LENGTH_MS] = active_acquisition_config.hop_length_ms;
 }
 
 int16_t ModbusRTUCustom::floatToScaledInt(float value) {
@@ -604,8 +1020,29 @@ int16_t ModbusRTUCustom::floatToScaledInt(float value) {
   return (int16_t)scaled;
 }
 
+int16_t ModbusRTUCustom::countsToScaledInt(int32_t value, int32_t counts_per_g) {
+  // Q.8 counts straight to milli-g: the only unit conversion on the
+  // statistics path, in integers so every build rounds the same way
+  if (counts_per_g <= 0) {
+    return 0;
+  }
+  int64_t scaled = divRound((int64_t)value * MODBUS_SCALE_FACTOR, (int64_t)counts_per_g << STATS_FRAC_BITS);
+  
+  if (scaled > 32767) scaled = 32767;
+  if (scaled < -32768) scaled = -32768;
+  return (int16_t)scaled;
+}
+
+int16_t ModbusRTUCustom::ratioToScaledInt(int32_t value) {
+  // Q.16 ratio to x1000
+  int64_t scaled = divRound((int64_t)value * MODBUS_SCALE_FACTOR, 1L << SHAPE_FRAC_BITS);
+  
+  if (scaled > 32767) scaled = 32767;
+  if (scaled < -32768) scaled = -32768;
+  return (int16_t)scaled;
+}
+
 uint16_t ModbusRTUCustom::getTaskStatusFlags() {
-  extern TaskManagerStatus task_status;
   uint16_t flags = 0;
   
   if (task_status.sampling_task_running) flags |= 0x0001;
@@ -0,0 +1,254 @@
+#include "mpu6050.h"
+
+// DLPF_CFG accelerometer bandwidths (Hz) for printing
+static const uint16_t dlpf_bandwidth_hz[] = { 260, 184, 94, 44, 21, 10, 5, 0 };
+
+MPU6050::MPU6050(uint8_t i2c_address) : initialized(false), address(i2c_address), range_g(2),
+                                        dlpf_cfg(0), sample_rate_divider(0), fifo_enabled(false),
+                                        fifo_overruns(0) {
+}
+
+bool MPU6050::probe() {
+  // WHO_AM_I only; does not reset or reconfigure the part
+  if (!Wire.begin(MPU6050_SDA_PIN, MPU6050_SCL_PIN, MPU6050_I2C_FREQUENCY)) {
+    return false;
+  }
+  return checkDeviceID();
+}
+
+bool MPU6050::begin() {
+  // Fast-mode I2C: a 6-byte accel burst takes ~200 us instead of ~800 us
+  if (!Wire.begin(MPU6050_SDA_PIN, MPU6050_SCL_PIN, MPU6050_I2C_FREQUENCY)) {
+    Serial.println("MPU6050 initialization failed - I2C");
+    return false;
+  }
+  Wire.setClock(MPU6050_I2C_FREQUENCY);
+  
+  if (!checkDeviceID()) {
+    Serial.println("MPU6050 initialization failed - wrong device ID");
+    return false;
+  }
+  
+  // Reset, wake up and put the unused gyro in standby
+  writeRegister(MPU6050_PWR_MGMT_1, MPU6050_PWR_DEVICE_RESET);
+  delay(100);
+  writeRegister(MPU6050_PWR_MGMT_1, MPU6050_PWR_CLK_INTERNAL);
+  writeRegister(MPU6050_PWR_MGMT_2, MPU6050_PWR2_GYRO_STANDBY);
+  delay(10);
+  
+  setRange(2);
+  setDlpf(MPU6050_DEFAULT_DLPF);
+  setSampleRateDivider(0);
+  
+  initialized = true;
+  Serial.println("MPU6050 initialized successfully");
+  printDeviceInfo();
+  return true;
+}
+
+void MPU6050::end() {
+  if (initialized) {
+    writeRegister(MPU6050_USER_CTRL, 0x00);
+    writeRegister(MPU6050_PWR_MGMT_1, MPU6050_PWR_SLEEP);  // Sleep mode
+    fifo_enabled = false;
+    initialized = false;
+  }
+}
+
+void MPU6050::writeRegister(uint8_t reg, uint8_t value) {
+  Wire.beginTransmission(address);
+  Wire.write(reg);
+  Wire.write(value);
+  Wire.endTransmission();
+}
+
+uint8_t MPU6050::readRegister(uint8_t reg) {
+  uint8_t value = 0;
+  readRegisters(reg, &value, 1);
+  return value;
+}
+
+bool MPU6050::readRegisters(uint8_t reg, uint8_t* data, uint8_t length) {
+  Wire.beginTransmission(address);
+  Wire.write(reg);
+  if (Wire.endTransmission(false) != 0) {  // Repeated start
+    return false;
+  }
+  
+  if (Wire.requestFrom(address, length) != length) {
+    return false;
+  }
+  
+  return Wire.readBytes(data, length) == length;
+}
+
+bool MPU6050::readXYZ(int32_t &x, int32_t &y, int32_t &z) {
+  uint8_t buffer[6];
+  
+  // Only the six accelerometer bytes - no gyro or temperature
+  if (!readRegisters(MPU6050_ACCEL_XOUT_H, buffer, 6)) {
+    return false;
+  }
+  
+  x = (int16_t)((buffer[0] << 8) | buffer[1]);
+  y = (int16_t)((buffer[2] << 8) | buffer[3]);
+  z = (int16_t)((buffer[4] << 8) | buffer[5]);
+  return true;
+}
+
+bool MPU6050::readAcceleration(float &x_g, float &y_g, float &z_g) {
+  int32_t x_raw, y_raw, z_raw;
+  if (!readXYZ(x_raw, y_raw, z_raw)) {
+    return false;
+  }
+  
+  const float scale_factor = getScaleFactor();
+  x_g = (float)x_raw / scale_factor;
+  y_g = (float)y_raw / scale_factor;
+  z_g = (float)z_raw / scale_factor;
+  return true;
+}
+
+bool MPU6050::setRange(uint8_t range) {
+  uint8_t afs_sel;
+  switch (range) {
+    case 2:  afs_sel = 0; break;
+    case 4:  afs_sel = 1; break;
+    case 8:  afs_sel = 2; break;
+    case 16: afs_sel = 3; break;
+    default: return false;
+  }
+  
+  writeRegister(MPU6050_ACCEL_CONFIG, afs_sel << 3);
+  range_g = range;
+  return true;
+}
+
+bool MPU6050::setDlpf(uint8_t cfg) {
+  if (cfg > 6) {
+    return false;
+  }
+  
+  writeRegister(MPU6050_CONFIG, cfg & MPU6050_DLPF_MASK);
+  dlpf_cfg = cfg;
+  return true;
+}
+
+bool MPU6050::setSampleRateDivider(uint8_t divider) {
+  writeRegister(MPU6050_SMPLRT_DIV, divider);
+  sample_rate_divider = divider;
+  return true;
+}
+
+bool MPU6050::setSampleRate(uint16_t rate_hz) {
+  // Accelerometer output is limited to 1 kHz regardless of the gyro rate
+  if (rate_hz == 0 || rate_hz > 1000) {
+    return false;
+  }
+  
+  uint16_t base_hz = (dlpf_cfg == 0) ? 8000 : 1000;
+  uint16_t divider = base_hz / rate_hz - 1;
+  if (divider > 255) divider = 255;
+  
+  return setSampleRateDivider((uint8_t)divider);
+}
+
+uint16_t MPU6050::getSampleRate() const {
+  uint16_t base_hz = (dlpf_cfg == 0) ? 8000 : 1000;
+  uint16_t rate = base_hz / (1 + sample_rate_divider);
+  return rate > 1000 ? 1000 : rate;
+}
+
+float MPU6050::getScaleFactor() const {
+  // 16-bit output: 16384 LSB/g at ±2g, halving with each range step
+  return 16384.0f / (range_g / 2);
+}
+
+bool MPU6050::configureFifo() {
+  // Accelerometer-only FIFO: 6 bytes per sample, 170 samples deep
+  writeRegister(MPU6050_USER_CTRL, 0x00);
+  writeRegister(MPU6050_FIFO_EN, MPU6050_FIFO_EN_ACCEL);
+  writeRegister(MPU6050_USER_CTRL, MPU6050_USER_FIFO_RESET);
+  writeRegister(MPU6050_USER_CTRL, MPU6050_USER_FIFO_ENABLE);
+  readRegister(MPU6050_INT_STATUS);  // Clear a stale overflow flag
+  
+  fifo_enabled = true;
+  fifo_overruns = 0;
+  
+  #if ENABLE_DEBUG_OUTPUT
+  Serial.println("[MPU6050] FIFO enabled (accelerometer only)");
+  #endif
+  
+  return true;
+}
+
+uint16_t MPU6050::getFifoCount() {
+  uint8_t buffer[2];
+  if (!readRegisters(MPU6050_FIFO_COUNTH, buffer, 2)) {
+    return 0;
+  }
+  return ((uint16_t)buffer[0] << 8) | buffer[1];
+}
+
+uint16_t MPU6050::readFifo(int32_t* xyz, uint16_t max_samples, bool* overrun, uint16_t* waiting) {
+  if (overrun) *overrun = false;
+  if (waiting) *waiting = 0;
+  if (!fifo_enabled) {
+    return 0;
+  }
+  
+  // 1024 is not a multiple of 6, so after an overflow the frame boundary is
+  // lost; reset and start clean rather than decode shifted data
+  if (readRegister(MPU6050_INT_STATUS) & MPU6050_INT_FIFO_OFLOW) {
+    fifo_overruns++;
+    if (overrun) *overrun = true;
+    writeRegister(MPU6050_USER_CTRL, MPU6050_USER_FIFO_ENABLE | MPU6050_USER_FIFO_RESET);
+    return 0;
+  }
+  
+  // One FIFO_COUNT read per drain; it is also what the caller reports
+  uint16_t samples = getFifoCount() / MPU6050_FIFO_SAMPLE_BYTES;
+  if (waiting) *waiting = samples;
+  if (samples > max_samples) samples = max_samples;
+  
+  uint8_t buffer[MPU6050_I2C_CHUNK];
+  uint16_t count = 0;
+  
+  while (count < samples) {
+    uint16_t chunk_samples = samples - count;
+    if (chunk_samples > MPU6050_I2C_CHUNK / MPU6050_FIFO_SAMPLE_BYTES) {
+      chunk_samples = MPU6050_I2C_CHUNK / MPU6050_FIFO_SAMPLE_BYTES;
+    }
+    
+    // Burst reads of FIFO_R_W pop successive FIFO bytes
+    if (!readRegisters(MPU6050_FIFO_R_W, buffer, chunk_samples * MPU6050_FIFO_SAMPLE_BYTES)) {
+      break;
+    }
+    
+    for (uint16_t i = 0; i < chunk_samples; i++) {
+      const uint8_t* b = &buffer[i * MPU6050_FIFO_SAMPLE_BYTES];
+      xyz[count * 3 + 0] = (int16_t)((b[0] << 8) | b[1]);
+      xyz[count * 3 + 1] = (int16_t)((b[2] << 8) | b[3]);
+      xyz[count * 3 + 2] = (int16_t)((b[4] << 8) | b[5]);
+      count++;
+    }
+  }
+  
+  return count;
+}
+
+void MPU6050::enableDataReadyInterrupt(bool enable) {
+  // Active-high push-pull 50 us pulse on INT, cleared automatically
+  writeRegister(MPU6050_INT_PIN_CFG, 0x00);
+  writeRegister(MPU6050_INT_ENABLE, enable ? MPU6050_INT_DATA_RDY : 0x00);
+}
+
+bool MPU6050::checkDeviceID() {
+  return readRegister(MPU6050_WHO_AM_I) == EXPECTED_MPU6050_ID;
+}
+
+void MPU6050::printDeviceInfo() {
+  Serial.print("WHO_AM_I: 0x"); Serial.println(readRegister(MPU6050_WHO_AM_I), HEX);
+  Serial.printf("Range: ±%dg, DLPF: %d (%d Hz), Rate: %d Hz\n", 
+                range_g, dlpf_cfg, dlpf_bandwidth_hz[dlpf_cfg], getSampleRate());
+}
@@ -0,0 +1,129 @@
+#include "packed_history.h"
+#include "esp_heap_caps.h"
+
+PackedHistory::PackedHistory() : samples(nullptr), capacity(0), head(0), count(0), in_psram(false),
+                                 newest_time_us(0), sampling_interval_us(1000) {
+}
+
+PackedHistory::~PackedHistory() {
+  if (samples) {
+    heap_caps_free(samples);
+  }
+}
+
+bool PackedHistory::begin(uint32_t max_samples, uint32_t internal_samples) {
+  // PSRAM holds the full request when the module has it
+  samples = (uint64_t*)heap_caps_malloc(max_samples * sizeof(uint64_t),
+                                        MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (samples) {
+    capacity = max_samples;
+    in_psram = true;
+  } else {
+    // Internal RAM: the fixed budget, if the largest free block allows it
+    // with the reserve kept
+    size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    uint32_t fit = largest > HISTORY_HEAP_RESERVE ?
+                   (largest - HISTORY_HEAP_RESERVE) / sizeof(uint64_t) : 0;
+    capacity = max_samples < internal_samples ? max_samples : internal_samples;
+    if (capacity > fit) capacity = fit;
+
+    if (capacity < HISTORY_MIN_SAMPLES) {
+      capacity = 0;
+      Serial.println("Not enough memory for sample history");
+      return false;
+    }
+
+    samples = (uint64_t*)heap_caps_malloc(capacity * sizeof(uint64_t),
+                                          MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!samples) {
+      capacity = 0;
+      Serial.println("Failed to allocate sample history!");
+      return false;
+    }
+    in_psram = false;
+  }
+
+  reset();
+
+  #if ENABLE_DEBUG_OUTPUT
+  Serial.printf("[HISTORY] %lu samples (%lu bytes, %s)\n", (unsigned long)capacity,
+                (unsigned long)getMemoryBytes(), in_psram ? "PSRAM" : "internal RAM");
+  #endif
+
+  return true;
+}
+
+void PackedHistory::reset() {
+  head = 0;
+  count = 0;
+  newest_time_us = 0;
+}
+
+uint32_t PackedHistory::unpack(uint32_t offset, uint32_t n, int32_t* x, int32_t* y, int32_t* z) const {
+  if (!samples || offset >= count) {
+    return 0;
+  }
+  if (n > count - offset) {
+    n = count - offset;
+  }
+
+  // Oldest sample sits at head once the history has wrapped
+  uint32_t index = (count == capacity ? head : 0) + offset;
+  if (index >= capacity) index -= capacity;
+
+  // Unpack in at most two contiguous runs
+  uint32_t done = 0;
+  while (done < n) {
+    uint32_t run = capacity - index;
+    if (run > n - done) run = n - done;
+
+    const uint64_t* src = samples + index;
+    for (uint32_t i = 0; i < run; i++) {
+      uint64_t word = src[i];
+      x[done + i] = unpackAxis(word, 0);
+      y[done + i] = unpackAxis(word, 20);
+      z[done + i] = unpackAxis(word, 40);
+    }
+
+    done += run;
+    index = 0;
+  }
+
+  return n;
+}
+
+uint32_t PackedHistory::unpackRecent(uint32_t n, int32_t* x, int32_t* y, int32_t* z) const {
+  if (n > count) {
+    n = count;
+  }
+  return unpack(count - n, n, x, y, z);
+}
+
+uint32_t PackedHistory::copyRecent(uint32_t n, uint64_t* out) const {
+  if (!samples) {
+    return 0;
+  }
+  if (n > count) {
+    n = count;
+  }
+
+  // Start n samples back from the write position, wrapping once at most
+  uint32_t index = head >= n ? head - n : head + capacity - n;
+  uint32_t first = capacity - index;
+  if (first > n) first = n;
+  memcpy(out, samples + index, first * sizeof(uint64_t));
+  memcpy(out + first, samples, (n - first) * sizeof(uint64_t));
+
+  return n;
+}
+
+unsigned long PackedHistory::getOldestTime() const {
+  if (count == 0) {
+    return 0;
+  }
+  return newest_time_us - (count - 1) * sampling_interval_us;
+}
+
+float PackedHistory::getSpanSeconds() const {
+  return (float)count * sampling_interval_us / 1000000.0f;
+}
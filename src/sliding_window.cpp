@@ -0,0 +1,237 @@
+#include "sliding_window.h"
+#include "config.h"
+#include <new>
+
+SlidingWindow::SlidingWindow() : write_pos(0), count(0), window_length(BUFFER_SIZE),
+                                 hop_length(BUFFER_SIZE), since_hop(0), newest_time_us(0),
+                                 sampling_interval_us(SAMPLING_INTERVAL_US), counts_per_g((int32_t)ADXL355_SCALE_2G) {
+  clip_flags = nullptr;
+  for (uint8_t a = 0; a < 3; a++) {
+    axis[a] = nullptr;
+    memset(&max_q[a], 0, sizeof(MonoDeque));
+    memset(&min_q[a], 0, sizeof(MonoDeque));
+  }
+}
+
+SlidingWindow::~SlidingWindow() {
+  // axis[0] and max_q[0].pos own the blocks for all three axes
+  if (axis[0]) {
+    delete[] axis[0];
+  }
+  if (max_q[0].pos) {
+    delete[] max_q[0].pos;
+  }
+  if (clip_flags) {
+    delete[] clip_flags;
+  }
+}
+
+bool SlidingWindow::begin() {
+  // Memory comes with the first overlapping configuration
+  reset();
+  return true;
+}
+
+bool SlidingWindow::allocate() {
+  if (axis[0]) {
+    return true;
+  }
+
+  int32_t* samples = new (std::nothrow) int32_t[3 * BUFFER_SIZE];
+  uint16_t* positions = new (std::nothrow) uint16_t[6 * BUFFER_SIZE];
+  uint8_t* flags = new (std::nothrow) uint8_t[BUFFER_SIZE];
+  if (!samples || !positions || !flags) {
+    delete[] samples;
+    delete[] positions;
+    delete[] flags;
+    Serial.println("Failed to allocate sliding window memory!");
+    return false;
+  }
+  clip_flags = flags;
+
+  for (uint8_t a = 0; a < 3; a++) {
+    axis[a] = samples + a * BUFFER_SIZE;
+    max_q[a].pos = positions + (2 * a) * BUFFER_SIZE;
+    min_q[a].pos = positions + (2 * a + 1) * BUFFER_SIZE;
+    max_q[a].capacity = BUFFER_SIZE;
+    min_q[a].capacity = BUFFER_SIZE;
+  }
+
+  reset();
+  return true;
+}
+
+bool SlidingWindow::configure(uint16_t window_samples, uint16_t hop_samples, uint16_t sample_rate,
+                              int32_t scale_factor) {
+  if (window_samples == 0) window_samples = 1;
+  if (window_samples > BUFFER_SIZE) window_samples = BUFFER_SIZE;
+  if (hop_samples == 0 || hop_samples > window_samples) hop_samples = window_samples;
+  if (sample_rate == 0) sample_rate = SAMPLE_RATE_HZ;
+
+  window_length = window_samples;
+  hop_length = hop_samples;
+  sampling_interval_us = 1000000UL / sample_rate;
+  counts_per_g = scale_factor;
+
+  reset();
+
+  // Tumbling windows never touch the ring
+  if (hop_length < window_length && !allocate()) {
+    hop_length = window_length;
+    return false;
+  }
+
+  #if ENABLE_DEBUG_OUTPUT
+  Serial.printf("[SLIDING] Window: %d samples, hop %d samples\n", window_length, hop_length);
+  #endif
+  return true;
+}
+
+void SlidingWindow::reset() {
+  write_pos = 0;
+  count = 0;
+  since_hop = 0;
+  newest_time_us = 0;
+  for (uint8_t a = 0; a < 3; a++) {
+    sum[a] = 0;
+    sum_sq[a] = 0;
+    origin[a] = 0;
+    higher[a].clear();
+    clipped[a] = 0;
+    max_q[a].head = max_q[a].count = 0;
+    min_q[a].head = min_q[a].count = 0;
+  }
+}
+
+void SlidingWindow::pushBack(MonoDeque& q, const int32_t* values, uint16_t position, bool is_max) {
+  const int32_t v = values[position];
+
+  // Drop entries the new sample dominates; they can never be the extreme again
+  while (q.count > 0) {
+    uint16_t back = q.head + q.count - 1;
+    if (back >= q.capacity) back -= q.capacity;
+    int32_t b = values[q.pos[back]];
+    if (is_max ? (b > v) : (b < v)) {
+      break;
+    }
+    q.count--;
+  }
+
+  uint16_t slot = q.head + q.count;
+  if (slot >= q.capacity) slot -= q.capacity;
+  q.pos[slot] = position;
+  q.count++;
+}
+
+bool SlidingWindow::addSample(int32_t x, int32_t y, int32_t z, unsigned long timestamp_us, uint8_t clip) {
+  if (!axis[0]) {
+    return false;
+  }
+
+  const int32_t in[3] = { x, y, z };
+  const uint16_t position = write_pos;
+
+  if (count == 0) {
+    // The origin stays put until the next reset so the moment sums can be
+    // unwound exactly as samples leave
+    origin[0] = x;
+    origin[1] = y;
+    origin[2] = z;
+  }
+  const uint8_t clip_out = (count == window_length) ? clip_flags[position] : 0;
+
+  for (uint8_t a = 0; a < 3; a++) {
+    int32_t* values = axis[a];
+
+    // Oldest sample leaves the window
+    if (count == window_length) {
+      int32_t out = values[position];
+      sum[a] -= out;
+      sum_sq[a] -= (long long)out * out;
+      higher[a].remove(out - origin[a]);
+      if (clip_out & (1 << a)) clipped[a]--;
+
+      // Each position appears at most once per deque, and only at the front
+      // once it is the oldest
+      if (max_q[a].count > 0 && max_q[a].pos[max_q[a].head] == position) {
+        max_q[a].head = (max_q[a].head + 1 == max_q[a].capacity) ? 0 : max_q[a].head + 1;
+        max_q[a].count--;
+      }
+      if (min_q[a].count > 0 && min_q[a].pos[min_q[a].head] == position) {
+        min_q[a].head = (min_q[a].head + 1 == min_q[a].capacity) ? 0 : min_q[a].head + 1;
+        min_q[a].count--;
+      }
+    }
+
+    // New sample enters
+    values[position] = in[a];
+    sum[a] += in[a];
+    sum_sq[a] += (long long)in[a] * in[a];
+    higher[a].add(in[a] - origin[a]);
+    if (clip & (1 << a)) clipped[a]++;
+    pushBack(max_q[a], values, position, true);
+    pushBack(min_q[a], values, position, false);
+  }
+
+  clip_flags[position] = clip;
+  write_pos = (position + 1 == window_length) ? 0 : position + 1;
+  if (count < window_length) count++;
+  newest_time_us = timestamp_us;
+
+  // Report once the window is full, then every hop
+  if (++since_hop >= hop_length && count == window_length) {
+    since_hop = 0;
+    return true;
+  }
+  if (since_hop >= hop_length) {
+    since_hop = hop_length;  // Hold until the first window fills
+  }
+  return false;
+}
+
+void SlidingWindow::calculateStats(BufferStats& stats) const {
+  memset(&stats, 0, sizeof(stats));
+  if (count == 0) {
+    return;
+  }
+
+  int32_t* avg[3] = { &stats.avg_x, &stats.avg_y, &stats.avg_z };
+  int32_t* rms[3] = { &stats.rms_x, &stats.rms_y, &stats.rms_z };
+  int32_t* max_v[3] = { &stats.max_x, &stats.max_y, &stats.max_z };
+  int32_t* min_v[3] = { &stats.min_x, &stats.min_y, &stats.min_z };
+  int32_t* std_v[3] = { &stats.std_x, &stats.std_y, &stats.std_z };
+
+  // Same STATS_FRAC_BITS fixed point as DataBuffer
+  for (uint8_t a = 0; a < 3; a++) {
+    *avg[a] = (int32_t)divRound(sum[a] * (1 << STATS_FRAC_BITS), count);
+    *rms[a] = isqrt64(fixedDiv(sum_sq[a], count, 2 * STATS_FRAC_BITS));
+    long long m2n = (long long)count * sum_sq[a] - sum[a] * sum[a];  // count^2 * variance, exact
+    *std_v[a] = m2n > 0 ? isqrt64(fixedDiv(m2n, (uint64_t)count * count, 2 * STATS_FRAC_BITS)) : 0;
+    *max_v[a] = axis[a][max_q[a].pos[max_q[a].head]] * (1 << STATS_FRAC_BITS);
+    *min_v[a] = axis[a][min_q[a].pos[min_q[a].head]] * (1 << STATS_FRAC_BITS);
+  }
+
+  // Shape statistics; the higher moments are centered on the origin, so the
+  // first and second sums are re-centered to match
+  int32_t* p2p[3] = { &stats.p2p_x, &stats.p2p_y, &stats.p2p_z };
+  int32_t* crest[3] = { &stats.crest_x, &stats.crest_y, &stats.crest_z };
+  int32_t* skew[3] = { &stats.skew_x, &stats.skew_y, &stats.skew_z };
+  int32_t* kurt[3] = { &stats.kurt_x, &stats.kurt_y, &stats.kurt_z };
+  uint16_t* clip_v[3] = { &stats.clipped_x, &stats.clipped_y, &stats.clipped_z };
+  uint64_t variance_sum = 0;
+  for (uint8_t a = 0; a < 3; a++) {
+    *p2p[a] = *max_v[a] - *min_v[a];
+    *crest[a] = crestFactor(*min_v[a], *max_v[a], *avg[a], *std_v[a]);
+    long long centered_sum = sum[a] - (long long)count * origin[a];
+    long long centered_sq = sum_sq[a] - 2 * (long long)origin[a] * sum[a] + (long long)count * origin[a] * origin[a];
+    higher[a].shape(count, centered_sum, centered_sq, *skew[a], *kurt[a]);
+    long long m2n = (long long)count * sum_sq[a] - sum[a] * sum[a];
+    if (m2n > 0) variance_sum += fixedDiv(m2n, (uint64_t)count * count, 2 * STATS_FRAC_BITS);
+    *clip_v[a] = clipped[a];
+  }
+  stats.vector_rms = isqrt64(variance_sum);
+
+  stats.sample_count = count;
+  stats.counts_per_g = counts_per_g;
+  stats.duration_us = (count - 1) * sampling_interval_us;
+}
@@ -0,0 +1,249 @@
+#include "spectrum.h"
+#include "stats_kernels.h"
+#include <math.h>
+
+SpectrumAnalyzer spectrumAnalyzer;
+
+SpectrumAnalyzer::SpectrumAnalyzer() : due_mask(0), next_channel(0), staged_channel(0), staged_rate_hz(0), staged_counts_per_g(1.0f),
+                                       busy(false), skipped(0), window_sum_sq(0) {
+  const uint16_t edges[SPECTRUM_NUM_BANDS + 1] = SPECTRUM_DEFAULT_BAND_EDGES_HZ;
+  for (uint8_t b = 0; b <= SPECTRUM_NUM_BANDS; b++) {
+    requested_edges_hz[b] = edges[b];
+    band_edges_hz[b] = edges[b];
+  }
+  memset(results, 0, sizeof(results));
+  results_lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+bool SpectrumAnalyzer::begin() {
+  // Hann window and its power gain
+  for (uint16_t i = 0; i < SPECTRUM_FFT_SIZE; i++) {
+    window[i] = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * i / SPECTRUM_FFT_SIZE);
+  }
+  window_sum_sq = statsSumSqF32(window, SPECTRUM_FFT_SIZE);
+
+  // Twiddles W_N^k = cos - j sin for the split step; the half-size complex
+  // FFT uses every second one
+  for (uint16_t k = 0; k < HALF; k++) {
+    tw_cos[k] = cosf(2.0f * (float)M_PI * k / SPECTRUM_FFT_SIZE);
+    tw_sin[k] = sinf(2.0f * (float)M_PI * k / SPECTRUM_FFT_SIZE);
+  }
+
+  #if ENABLE_DEBUG_OUTPUT
+  Serial.printf("[SPECTRUM] %d-point FFT, %d peaks, %d bands\n",
+                SPECTRUM_FFT_SIZE, SPECTRUM_NUM_PEAKS, SPECTRUM_NUM_BANDS);
+  #endif
+
+  return true;
+}
+
+void SpectrumAnalyzer::setBandEdges(const uint16_t* edges_hz) {
+  for (uint8_t b = 0; b <= SPECTRUM_NUM_BANDS; b++) {
+    requested_edges_hz[b] = edges_hz[b];
+  }
+}
+
+void SpectrumAnalyzer::markDue(uint8_t channel) {
+  // Still due from the previous window: that one goes without a spectrum
+  if (due_mask & (1 << channel)) {
+    skipped++;
+  }
+  due_mask |= (1 << channel);
+}
+
+bool SpectrumAnalyzer::stage(const PackedHistory* histories, uint16_t sample_rate, float counts_per_g) {
+  if (busy || due_mask == 0 || sample_rate == 0) {
+    return false;
+  }
+
+  // Serve due channels in turn so channel 0 cannot starve the others
+  uint8_t channel = next_channel;
+  while (!(due_mask & (1 << channel))) {
+    channel = (channel + 1) % NUM_ACCEL_CHANNELS;
+  }
+  due_mask &= ~(1 << channel);
+  next_channel = (channel + 1) % NUM_ACCEL_CHANNELS;
+
+  const PackedHistory& history = histories[channel];
+  if (history.getCount() < SPECTRUM_FFT_SIZE) {
+    return false;
+  }
+
+  history.unpackRecent(SPECTRUM_FFT_SIZE, staged[0], staged[1], staged[2]);
+  staged_channel = channel;
+  staged_rate_hz = sample_rate;
+  staged_counts_per_g = counts_per_g > 0.0f ? counts_per_g : 1.0f;
+  busy = true;
+  return true;
+}
+
+// In-place iterative radix-2 FFT of n complex points
+static void fftComplex(float* data, uint16_t n, const float* tw_cos, const float* tw_sin) {
+  // Bit-reversal permutation
+  for (uint16_t i = 1, j = 0; i < n; i++) {
+    uint16_t bit = n >> 1;
+    for (; j & bit; bit >>= 1) {
+      j ^= bit;
+    }
+    j ^= bit;
+    if (i < j) {
+      float tr = data[2 * i], ti = data[2 * i + 1];
+      data[2 * i] = data[2 * j];
+      data[2 * i + 1] = data[2 * j + 1];
+      data[2 * j] = tr;
+      data[2 * j + 1] = ti;
+    }
+  }
+
+  // Butterflies; W_n^k = W_2n^(2k)
+  for (uint16_t len = 2; len <= n; len <<= 1) {
+    const uint16_t half_len = len >> 1;
+    const uint16_t tw_step = (2 * n / len);
+    for (uint16_t start = 0; start < n; start += len) {
+      for (uint16_t k = 0; k < half_len; k++) {
+        const float wr = tw_cos[k * tw_step];
+        const float wi = -tw_sin[k * tw_step];
+        float* a = &data[2 * (start + k)];
+        float* b = &data[2 * (start + k + half_len)];
+        const float br = b[0] * wr - b[1] * wi;
+        const float bi = b[0] * wi + b[1] * wr;
+        b[0] = a[0] - br;
+        b[1] = a[1] - bi;
+        a[0] += br;
+        a[1] += bi;
+      }
+    }
+  }
+}
+
+void fftRealPower(float* data, uint16_t n, const float* tw_cos, const float* tw_sin, float* power) {
+  fftComplex(data, n, tw_cos, tw_sin);
+
+  // Split: X[k] = Fe[k] + W_2n^k Fo[k]
+  power[0] = (data[0] + data[1]) * (data[0] + data[1]);
+  power[n] = (data[0] - data[1]) * (data[0] - data[1]);
+  for (uint16_t k = 1; k < n; k++) {
+    const float ar = data[2 * k], ai = data[2 * k + 1];
+    const float br = data[2 * (n - k)], bi = -data[2 * (n - k) + 1];  // conj(Z[n-k])
+    const float er = 0.5f * (ar + br), ei = 0.5f * (ai + bi);
+    const float or_ = 0.5f * (ai - bi), oi = -0.5f * (ar - br);
+    const float c = tw_cos[k], s = tw_sin[k];
+    const float xr = er + c * or_ + s * oi;
+    const float xi = ei + c * oi - s * or_;
+    power[k] = xr * xr + xi * xi;
+  }
+}
+
+uint8_t findSpectralPeaks(const float* power, uint16_t n, float resolution, float power_scale,
+                          SpectrumPeak* peaks, uint8_t max_peaks) {
+  // Strongest local maxima, kept sorted
+  uint16_t peak_bins[SPECTRUM_NUM_PEAKS] = { 0 };
+  if (max_peaks > SPECTRUM_NUM_PEAKS) {
+    max_peaks = SPECTRUM_NUM_PEAKS;
+  }
+  uint8_t found = 0;
+  for (uint16_t k = 2; k < n; k++) {
+    const float p = power[k];
+    if (p <= power[k - 1] || p < power[k + 1]) continue;
+    if (found == max_peaks && p <= power[peak_bins[found - 1]]) continue;
+
+    uint8_t slot = found < max_peaks ? found++ : found - 1;
+    while (slot > 0 && power[peak_bins[slot - 1]] < p) {
+      peak_bins[slot] = peak_bins[slot - 1];
+      slot--;
+    }
+    peak_bins[slot] = k;
+  }
+
+  for (uint8_t i = 0; i < found; i++) {
+    const uint16_t k = peak_bins[i];
+    // Parabolic interpolation on magnitudes
+    const float a = sqrtf(power[k - 1]), b = sqrtf(power[k]), c = sqrtf(power[k + 1]);
+    const float denom = a - 2.0f * b + c;
+    const float delta = denom != 0.0f ? 0.5f * (a - c) / denom : 0.0f;
+    peaks[i].frequency_hz = (k + delta) * resolution;
+
+    // Amplitude from the energy of the whole Hann main lobe (+-2 bins), which
+    // does not scallop when the tone falls between bins
+    float lobe = 0;
+    for (int16_t j = (int16_t)k - 2; j <= (int16_t)k + 2; j++) {
+      if (j >= 1 && j <= n) lobe += power[j];
+    }
+    peaks[i].amplitude_g = sqrtf(2.0f * lobe * power_scale);
+  }
+  return found;
+}
+
+// Windowed, mean-removed real FFT; leaves |X[k]|^2 in power[0..HALF]
+void SpectrumAnalyzer::realFft(const int32_t* samples, float mean, float scale) {
+  // Pack even/odd samples as real/imaginary parts of a half-size sequence
+  for (uint16_t n = 0; n < SPECTRUM_FFT_SIZE; n++) {
+    work[n] = ((float)samples[n] - mean) * scale * window[n];
+  }
+  fftRealPower(work, HALF, tw_cos, tw_sin, power);
+}
+
+void SpectrumAnalyzer::analyzeAxis(const int32_t* samples, AxisSpectrum& out) {
+  memset(&out, 0, sizeof(out));
+
+  const int64_t sum = statsSumI32(samples, SPECTRUM_FFT_SIZE);
+  realFft(samples, (float)sum / SPECTRUM_FFT_SIZE, 1.0f / staged_counts_per_g);
+
+  const float resolution = (float)staged_rate_hz / SPECTRUM_FFT_SIZE;
+  const float power_scale = 2.0f / (SPECTRUM_FFT_SIZE * window_sum_sq);  // Mean square per bin
+
+  // Band energies (single-sided, DC excluded)
+  for (uint8_t b = 0; b < SPECTRUM_NUM_BANDS; b++) {
+    uint16_t k_lo = (uint16_t)ceilf(band_edges_hz[b] / resolution);
+    uint16_t k_hi = (uint16_t)ceilf(band_edges_hz[b + 1] / resolution);
+    if (k_lo < 1) k_lo = 1;
+    if (k_hi > HALF) k_hi = HALF;
+    const float ms = k_hi > k_lo ? statsSumF32(&power[k_lo], k_hi - k_lo) : 0.0f;
+    out.band_rms_g[b] = sqrtf(ms * power_scale);
+  }
+
+  uint8_t found = findSpectralPeaks(power, HALF, resolution, power_scale, out.peaks, SPECTRUM_NUM_PEAKS);
+  if (found > 0) {
+    out.dominant_hz = out.peaks[0].frequency_hz;
+    out.dominant_g = out.peaks[0].amplitude_g;
+  }
+}
+
+void SpectrumAnalyzer::process() {
+  if (!busy) {
+    return;
+  }
+
+  for (uint8_t b = 0; b <= SPECTRUM_NUM_BANDS; b++) {
+    band_edges_hz[b] = requested_edges_hz[b];
+  }
+
+  unsigned long start = micros();
+
+  SpectrumResult result;
+  for (uint8_t a = 0; a < 3; a++) {
+    analyzeAxis(staged[a], result.axis[a]);
+  }
+  result.sample_rate_hz = staged_rate_hz;
+  result.resolution_hz = (float)staged_rate_hz / SPECTRUM_FFT_SIZE;
+  result.compute_us = micros() - start;
+  result.valid = true;
+
+  const uint8_t channel = staged_channel;
+  busy = false;
+
+  portENTER_CRITICAL(&results_lock);
+  result.sequence = results[channel].sequence + 1;
+  results[channel] = result;
+  portEXIT_CRITICAL(&results_lock);
+}
+
+bool SpectrumAnalyzer::getResult(uint8_t channel, SpectrumResult& out) const {
+  if (channel >= NUM_ACCEL_CHANNELS) {
+    return false;
+  }
+  portENTER_CRITICAL(&results_lock);
+  out = results[channel];
+  portEXIT_CRITICAL(&results_lock);
+  return out.valid;
+}
@@ -0,0 +1,320 @@
+#include "stats_kernels.h"
+
+#if STATS_KERNELS_ESP_DSP
+#include "esp_dsp.h"
+#endif
+#if STATS_KERNELS_SSE41
+#include <smmintrin.h>
+#endif
+
+#if STATS_KERNELS_SSE41
+
+// Horizontal sum of the two 64-bit lanes
+static inline int64_t hsumI64(__m128i v) {
+  return _mm_cvtsi128_si64(v) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(v, v));
+}
+
+static inline float hsumF32(__m128 v) {
+  __m128 s = _mm_add_ps(v, _mm_movehl_ps(v, v));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+  return _mm_cvtss_f32(s);
+}
+
+// Signed 32x32->64 products of all four lanes, summed pairwise into two lanes
+static inline __m128i mulAddI64(__m128i a, __m128i b) {
+  __m128i even = _mm_mul_epi32(a, b);
+  __m128i odd = _mm_mul_epi32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+  return _mm_add_epi64(even, odd);
+}
+
+int64_t statsSumI32(const int32_t* v, uint32_t n) {
+  __m128i acc = _mm_setzero_si128();
+  uint32_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i x = _mm_loadu_si128((const __m128i*)(v + i));
+    acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(x));
+    acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(_mm_unpackhi_epi64(x, x)));
+  }
+  int64_t sum = hsumI64(acc);
+  for (; i < n; i++) sum += v[i];
+  return sum;
+}
+
+int64_t statsDotI32(const int32_t* a, const int32_t* b, uint32_t n) {
+  __m128i acc = _mm_setzero_si128();
+  uint32_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    acc = _mm_add_epi64(acc, mulAddI64(_mm_loadu_si128((const __m128i*)(a + i)),
+                                       _mm_loadu_si128((const __m128i*)(b + i))));
+  }
+  int64_t dot = hsumI64(acc);
+  for (; i < n; i++) dot += (int64_t)a[i] * b[i];
+  return dot;
+}
+
+int64_t statsSumSqI32(const int32_t* v, uint32_t n) {
+  return statsDotI32(v, v, n);
+}
+
+void statsScanI32(const int32_t* v, uint32_t n, KernelAxisStats* out) {
+  __m128i sum = _mm_setzero_si128();
+  __m128i sum_sq = _mm_setzero_si128();
+  __m128i lo = _mm_set1_epi32(v[0]);
+  __m128i hi = lo;
+  uint32_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i x = _mm_loadu_si128((const __m128i*)(v + i));
+    sum = _mm_add_epi64(sum, _mm_cvtepi32_epi64(x));
+    sum = _mm_add_epi64(sum, _mm_cvtepi32_epi64(_mm_unpackhi_epi64(x, x)));
+    sum_sq = _mm_add_epi64(sum_sq, mulAddI64(x, x));
+    lo = _mm_min_epi32(lo, x);
+    hi = _mm_max_epi32(hi, x);
+  }
+  lo = _mm_min_epi32(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(1, 0, 3, 2)));
+  lo = _mm_min_epi32(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(2, 3, 0, 1)));
+  hi = _mm_max_epi32(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(1, 0, 3, 2)));
+  hi = _mm_max_epi32(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(2, 3, 0, 1)));
+
+  out->sum = hsumI64(sum);
+  out->sum_sq = hsumI64(sum_sq);
+  out->min = _mm_cvtsi128_si32(lo);
+  out->max = _mm_cvtsi128_si32(hi);
+  for (; i < n; i++) {
+    out->sum += v[i];
+    out->sum_sq += (int64_t)v[i] * v[i];
+    if (v[i] < out->min) out->min = v[i];
+    if (v[i] > out->max) out->max = v[i];
+  }
+}
+
+void statsMinMaxI32(const int32_t* v, uint32_t n, int32_t* min_out, int32_t* max_out) {
+  __m128i lo = _mm_set1_epi32(v[0]);
+  __m128i hi = lo;
+  uint32_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i x = _mm_loadu_si128((const __m128i*)(v + i));
+    lo = _mm_min_epi32(lo, x);
+    hi = _mm_max_epi32(hi, x);
+  }
+  lo = _mm_min_epi32(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(1, 0, 3, 2)));
+  lo = _mm_min_epi32(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(2, 3, 0, 1)));
+  hi = _mm_max_epi32(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(1, 0, 3, 2)));
+  hi = _mm_max_epi32(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(2, 3, 0, 1)));
+  int32_t mn = _mm_cvtsi128_si32(lo), mx = _mm_cvtsi128_si32(hi);
+  for (; i < n; i++) {
+    if (v[i] < mn) mn = v[i];
+    if (v[i] > mx) mx = v[i];
+  }
+  *min_out = mn;
+  *max_out = mx;
+}
+
+float statsSumF32(const float* v, uint32_t n) {
+  __m128 acc = _mm_setzero_ps();
+  uint32_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    acc = _mm_add_ps(acc, _mm_loadu_ps(v + i));
+  }
+  float sum = hsumF32(acc);
+  for (; i < n; i++) sum += v[i];
+  return sum;
+}
+
+float statsDotF32(const float* a, const float* b, uint32_t n) {
+  __m128 acc = _mm_setzero_ps();
+  uint32_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+  }
+  float dot = hsumF32(acc);
+  for (; i < n; i++) dot += a[i] * b[i];
+  return dot;
+}
+
+float statsSumSqF32(const float* v, uint32_t n) {
+  return statsDotF32(v, v, n);
+}
+
+void statsMinMaxF32(const float* v, uint32_t n, float* min_out, float* max_out) {
+  __m128 lo = _mm_set1_ps(v[0]);
+  __m128 hi = lo;
+  uint32_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128 x = _mm_loadu_ps(v + i);
+    lo = _mm_min_ps(lo, x);
+    hi = _mm_max_ps(hi, x);
+  }
+  lo = _mm_min_ps(lo, _mm_movehl_ps(lo, lo));
+  lo = _mm_min_ss(lo, _mm_shuffle_ps(lo, lo, 1));
+  hi = _mm_max_ps(hi, _mm_movehl_ps(hi, hi));
+  hi = _mm_max_ss(hi, _mm_shuffle_ps(hi, hi, 1));
+  float mn = _mm_cvtss_f32(lo), mx = _mm_cvtss_f32(hi);
+  for (; i < n; i++) {
+    if (v[i] < mn) mn = v[i];
+    if (v[i] > mx) mx = v[i];
+  }
+  *min_out = mn;
+  *max_out = mx;
+}
+
+const char* statsKernelBackend() {
+  return "sse4.1";
+}
+
+#else // Xtensa and portable
+
+// Independent accumulators hide the multiply and load latency. The
+// products are written as int32 x int32 -> int64 so Xtensa uses MULL/MULSH
+// rather than a 64-bit multiply call, and the ternaries compile to MIN/MAX
+// instead of compare-and-branch.
+
+int64_t statsSumI32(const int32_t* v, uint32_t n) {
+  int64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  uint32_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    s0 += v[i];
+    s1 += v[i + 1];
+    s2 += v[i + 2];
+    s3 += v[i + 3];
+  }
+  for (; i < n; i++) s0 += v[i];
+  return (s0 + s1) + (s2 + s3);
+}
+
+int64_t statsDotI32(const int32_t* a, const int32_t* b, uint32_t n) {
+  int64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  uint32_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    s0 += (int64_t)a[i] * b[i];
+    s1 += (int64_t)a[i + 1] * b[i + 1];
+    s2 += (int64_t)a[i + 2] * b[i + 2];
+    s3 += (int64_t)a[i + 3] * b[i + 3];
+  }
+  for (; i < n; i++) s0 += (int64_t)a[i] * b[i];
+  return (s0 + s1) + (s2 + s3);
+}
+
+int64_t statsSumSqI32(const int32_t* v, uint32_t n) {
+  return statsDotI32(v, v, n);
+}
+
+void statsMinMaxI32(const int32_t* v, uint32_t n, int32_t* min_out, int32_t* max_out) {
+  int32_t lo0 = v[0], lo1 = v[0], hi0 = v[0], hi1 = v[0];
+  uint32_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    const int32_t a = v[i], b = v[i + 1];
+    lo0 = a < lo0 ? a : lo0;
+    hi0 = a > hi0 ? a : hi0;
+    lo1 = b < lo1 ? b : lo1;
+    hi1 = b > hi1 ? b : hi1;
+  }
+  if (i < n) {
+    lo0 = v[i] < lo0 ? v[i] : lo0;
+    hi0 = v[i] > hi0 ? v[i] : hi0;
+  }
+  *min_out = lo0 < lo1 ? lo0 : lo1;
+  *max_out = hi0 > hi1 ? hi0 : hi1;
+}
+
+void statsScanI32(const int32_t* v, uint32_t n, KernelAxisStats* out) {
+  int64_t s0 = 0, s1 = 0, q0 = 0, q1 = 0;
+  int32_t lo0 = v[0], lo1 = v[0], hi0 = v[0], hi1 = v[0];
+  uint32_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    const int32_t a = v[i], b = v[i + 1];
+    s0 += a;
+    s1 += b;
+    q0 += (int64_t)a * a;
+    q1 += (int64_t)b * b;
+    lo0 = a < lo0 ? a : lo0;
+    hi0 = a > hi0 ? a : hi0;
+    lo1 = b < lo1 ? b : lo1;
+    hi1 = b > hi1 ? b : hi1;
+  }
+  if (i < n) {
+    const int32_t a = v[i];
+    s0 += a;
+    q0 += (int64_t)a * a;
+    lo0 = a < lo0 ? a : lo0;
+    hi0 = a > hi0 ? a : hi0;
+  }
+  out->sum = s0 + s1;
+  out->sum_sq = q0 + q1;
+  out->min = lo0 < lo1 ? lo0 : lo1;
+  out->max = hi0 > hi1 ? hi0 : hi1;
+}
+
+float statsSumF32(const float* v, uint32_t n) {
+  #if STATS_KERNELS_ESP_DSP
+  // Dot product with a single 1.0 read at stride 0
+  static const float one = 1.0f;
+  float sum = 0;
+  if (n > 0) dsps_dotprode_f32(v, &one, &sum, (int)n, 1, 0);
+  return sum;
+  #else
+  float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  uint32_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    s0 += v[i];
+    s1 += v[i + 1];
+    s2 += v[i + 2];
+    s3 += v[i + 3];
+  }
+  for (; i < n; i++) s0 += v[i];
+  return (s0 + s1) + (s2 + s3);
+  #endif
+}
+
+float statsDotF32(const float* a, const float* b, uint32_t n) {
+  #if STATS_KERNELS_ESP_DSP
+  // Hand-scheduled MADD.S loop for the ESP32 FPU
+  float dot = 0;
+  if (n > 0) dsps_dotprod_f32(a, b, &dot, (int)n);
+  return dot;
+  #else
+  float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  uint32_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    s0 += a[i] * b[i];
+    s1 += a[i + 1] * b[i + 1];
+    s2 += a[i + 2] * b[i + 2];
+    s3 += a[i + 3] * b[i + 3];
+  }
+  for (; i < n; i++) s0 += a[i] * b[i];
+  return (s0 + s1) + (s2 + s3);
+  #endif
+}
+
+float statsSumSqF32(const float* v, uint32_t n) {
+  return statsDotF32(v, v, n);
+}
+
+void statsMinMaxF32(const float* v, uint32_t n, float* min_out, float* max_out) {
+  float lo0 = v[0], lo1 = v[0], hi0 = v[0], hi1 = v[0];
+  uint32_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    const float a = v[i], b = v[i + 1];
+    lo0 = a < lo0 ? a : lo0;
+    hi0 = a > hi0 ? a : hi0;
+    lo1 = b < lo1 ? b : lo1;
+    hi1 = b > hi1 ? b : hi1;
+  }
+  if (i < n) {
+    lo0 = v[i] < lo0 ? v[i] : lo0;
+    hi0 = v[i] > hi0 ? v[i] : hi0;
+  }
+  *min_out = lo0 < lo1 ? lo0 : lo1;
+  *max_out = hi0 > hi1 ? hi0 : hi1;
+}
+
+const char* statsKernelBackend() {
+  #if STATS_KERNELS_ESP_DSP
+  return "esp-dsp";
+  #elif STATS_KERNELS_XTENSA
+  return "xtensa";
+  #else
+  return "portable";
+  #endif
+}
+
+#endif
@@ -1,147 +1,801 @@
 #include "task_manager.h"
 #include "modbus_interface.h"
 #include "accelerometer_interface.h"
+#include "sensor_policy.h"
+#include "stats_kernels.h"
 
 // Task handles
 TaskHandle_t sampling_task_handle = nullptr;
 TaskHandle_t processing_task_handle = nullptr;
 TaskHandle_t analytics_task_handle = nullptr;
 TaskHandle_t modbus_task_handle = nullptr;
+TaskHandle_t spectrum_task_handle = nullptr;
 
 // Synchronization primitives
 SemaphoreHandle_t buffer_mutex = nullptr;
 SemaphoreHandle_t buffer_ready_semaphore = nullptr;
 QueueHandle_t analytics_queue = nullptr;
 
+// Sampling -> processing hand-off
+SpscRing<RingSample, SAMPLE_RING_SIZE> sample_ring;
+
 // Task status
 TaskManagerStatus task_status;
 
-void samplingTask(void* parameter) {
-  Serial.println("Sampling task started on core " + String(xPortGetCoreID()));
-  task_status.sampling_task_running = true;
+// Runtime acquisition configuration
+QueueHandle_t config_queue = nullptr;
+AcquisitionConfig active_acquisition_config = {
+  { SAMPLE_RATE_HZ, DEFAULT_ACCEL_RANGE_G, DEFAULT_HPF_CORNER, DEFAULT_SENSOR_LPF },
+  DEFAULT_WINDOW_LENGTH_MS,
+  DEFAULT_HOP_LENGTH_MS
+};
+
+// Overlapping windows active (hop shorter than window): samples go to the
+// SlidingWindows instead of the DataBuffers; guarded by buffer_mutex
+static bool sliding_mode = false;
+
+// Tag for ring samples, bumped by the sampling task on reconfiguration under
+// buffer_mutex. The ring indices keep a single writer each: rather than the
+// producer emptying the ring, the consumer drops samples with an older tag.
+static volatile uint8_t ring_generation = 0;
+
+// Active timing and scale, owned by the sampling task
+static unsigned long sample_period_us = SAMPLING_INTERVAL_US;  // Sensor ODR period
+static unsigned long decimation_delay_us = 0;                   // Oversampling decimator group delay
+
+// Raw count at which the sensor output saturates, and the clip flags of raw
+// samples the decimator has not yet turned into an output sample
+static int32_t clip_limit = (1L << (ACCEL_SAMPLE_BITS - 1)) - 1;
+static uint8_t clip_pending[NUM_ACCEL_CHANNELS];
+
+// Trend decimator group delay, set under buffer_mutex
+static unsigned long trend_delay_us = 0;
+static AccelScale sample_scale = { (int32_t)ADXL355_SCALE_2G, 20, 2 };
+
+// Timestamp of the most recent sensor data-ready edge (written from ISR)
+static volatile unsigned long drdy_timestamp_us = 0;
+
+static void IRAM_ATTR sensorDataReadyISR() {
+  drdy_timestamp_us = micros();
+  
+  BaseType_t higher_priority_task_woken = pdFALSE;
+  vTaskNotifyGiveFromISR(sampling_task_handle, &higher_priority_task_woken);
+  portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+// Axes of a raw sample sitting at the sensor's output limit
+static inline uint8_t clipMask(const AccelRawData& raw) {
+  return ((raw.x >= clip_limit || raw.x <= -clip_limit) ? CLIP_X : 0) |
+         ((raw.y >= clip_limit || raw.y <= -clip_limit) ? CLIP_Y : 0) |
+         ((raw.z >= clip_limit || raw.z <= -clip_limit) ? CLIP_Z : 0);
+}
+
+// Hand one sample to the processing core, filtered and as it was before the
+// filter; never blocks
+static bool storeSample(uint8_t channel, const AccelRawData& filtered, const AccelRawData& raw,
+                        unsigned long timestamp_us, uint8_t clipped) {
+  RingSample sample;
+  sample.x = filtered.x;
+  sample.y = filtered.y;
+  sample.z = filtered.z;
+  sample.raw_x = raw.x;
+  sample.raw_y = raw.y;
+  sample.raw_z = raw.z;
+  sample.timestamp_us = timestamp_us;
+  sample.channel = channel;
+  sample.clipped = clipped;
+  sample.generation = ring_generation;
   
+  if (!sample_ring.push(sample)) {
+    // Processing core has fallen a full ring behind
+    task_status.missed_samples++;
+    return false;
+  }
+  
+  // Wake the processing task once a batch is waiting
+  uint32_t level = sample_ring.size();
+  if (level > task_status.ring_peak_level) {
+    task_status.ring_peak_level = level;
+  }
+  if (level >= RING_BATCH_SAMPLES) {
+    xSemaphoreGive(buffer_ready_semaphore);
+  }
+  return true;
+}
+
+// Stage cost, accumulated per batch and published every 1000 samples
+static void accountStageCost(StageCost& cost, uint32_t cycles, uint16_t samples, uint32_t budget) {
+  if (samples == 0) {
+    return;
+  }
+  uint32_t per_sample = cycles / samples;
+  if (per_sample > cost.cycles_peak) {
+    cost.cycles_peak = per_sample > 0xFFFF ? 0xFFFF : per_sample;
+  }
+  if (per_sample > budget) {
+    cost.over_budget++;
+  }
+  
+  cost.window_cycles += cycles;
+  cost.window_samples += samples;
+  if (cost.window_samples >= 1000) {
+    uint32_t avg = cost.window_cycles / cost.window_samples;
+    cost.cycles_avg = avg > 0xFFFF ? 0xFFFF : avg;
+    cost.window_cycles = 0;
+    cost.window_samples = 0;
+  }
+}
+
+// Single-sample path: one pass over all channels per scheduler tick or
+// data-ready edge. Sensors are read back-to-back before the buffers are
+// touched, so every channel's sample shares the same tick and timestamp.
+template <typename Policy>
+static uint16_t pollSensor(unsigned long timestamp_us) {
+  const uint8_t mask = Policy::channelMask();
+  AccelRawData raw[NUM_ACCEL_CHANNELS];
+  
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    raw[ch].valid = false;
+    if (mask & (1 << ch)) {
+      // Native counts straight from the driver - no float round trip
+      Policy::readRaw(ch, raw[ch]);
+    }
+  }
+  
+  #if ENABLE_DEBUG_OUTPUT
+  static unsigned long last_sensor_debug = 0;
+  if (raw[0].valid && millis() - last_sensor_debug > 3000) {  // Debug every 3 seconds
+    Serial.printf("[SENSOR-RAW] Raw values: X=%ld, Y=%ld, Z=%ld\n", raw[0].x, raw[0].y, raw[0].z);
+    Serial.printf("[SENSOR-G] G-values: X=%.6f, Y=%.6f, Z=%.6f (%s)\n", 
+                 (float)raw[0].x / sample_scale.counts_per_g, (float)raw[0].y / sample_scale.counts_per_g,
+                 (float)raw[0].z / sample_scale.counts_per_g, accelerometer.getSensorName());
+    last_sensor_debug = millis();
+  }
+  #endif
+  
+  bool ready[NUM_ACCEL_CHANNELS];
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    ready[ch] = (mask & (1 << ch)) && raw[ch].valid;
+    if (ready[ch]) {
+      clip_pending[ch] |= clipMask(raw[ch]);
+    }
+  }
+  
+  // Oversampled sensor: only every getFactor()-th read yields a sample
+  if (oversampleDecimator.isActive()) {
+    uint32_t start = ESP.getCycleCount();
+    uint16_t decimated = 0;
+    for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+      if (ready[ch]) {
+        ready[ch] = oversampleDecimator.process(ch, raw[ch].x, raw[ch].y, raw[ch].z);
+        decimated++;
+      }
+    }
+    accountStageCost(task_status.decimator_cost, ESP.getCycleCount() - start, decimated, DECIMATOR_BUDGET_CYCLES);
+    timestamp_us -= decimation_delay_us;
+  }
+  
+  // The histories and event captures keep the samples as they were before the filter
+  AccelRawData unfiltered[NUM_ACCEL_CHANNELS];
+  memcpy(unfiltered, raw, sizeof(unfiltered));
+  
+  if (sampleFilter.isActive()) {
+    uint32_t start = ESP.getCycleCount();
+    uint16_t filtered = 0;
+    for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+      if (ready[ch]) {
+        sampleFilter.process(ch, raw[ch].x, raw[ch].y, raw[ch].z);
+        filtered++;
+      }
+    }
+    accountStageCost(task_status.filter_cost, ESP.getCycleCount() - start, filtered, FILTER_BUDGET_CYCLES);
+  }
+  
+  if (toneBank.isActive()) {
+    uint32_t start = ESP.getCycleCount();
+    uint16_t tracked = 0;
+    for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+      if (ready[ch]) {
+        toneBank.process(ch, raw[ch].x, raw[ch].y, raw[ch].z);
+        tracked++;
+      }
+    }
+    accountStageCost(task_status.tone_cost, ESP.getCycleCount() - start, tracked, GOERTZEL_BUDGET_CYCLES);
+  }
+  
+  uint16_t added = 0;
+  
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    if (!(mask & (1 << ch))) {
+      continue;
+    }
+    
+    if (!raw[ch].valid) {
+      // Failed to read sensor data
+      task_status.sampling_errors++;
+      continue;
+    }
+    
+    if (!ready[ch]) {
+      continue;
+    }
+    
+    uint8_t clipped = clip_pending[ch];
+    clip_pending[ch] = 0;
+    if (storeSample(ch, raw[ch], unfiltered[ch], timestamp_us, clipped) && ch == 0) {
+      added++;
+      task_status.last_sample_time = millis();
+    }
+  }
+  
+  return added;
+}
+
+// Burst path. Each wakeup starts every sensor's FIFO burst, then decimates,
+// filters and stores the batch collected on the previous wakeup while the
+// DMA moves the new one, and finally collects it. Samples reach the buffers
+// one drain interval later than they would if read and processed in line.
+static AccelRawData fifo_batch[NUM_ACCEL_CHANNELS][ACCEL_MAX_BURST_SAMPLES];
+static uint16_t fifo_batch_counts[NUM_ACCEL_CHANNELS];
+static unsigned long fifo_batch_time_us = 0;  // When the newest sample in the batch was taken
+static uint8_t fifo_batch_generation = 0;
+
+static uint16_t processFifoBatch() {
+  static uint16_t source[NUM_ACCEL_CHANNELS][ACCEL_MAX_BURST_SAMPLES];  // FIFO index of each decimated sample
+  static uint8_t clip_flags[NUM_ACCEL_CHANNELS][ACCEL_MAX_BURST_SAMPLES];
+  static AccelRawData unfiltered[NUM_ACCEL_CHANNELS][ACCEL_MAX_BURST_SAMPLES];  // Decimated, before the filter
+  uint16_t outputs[NUM_ACCEL_CHANNELS];
+  const unsigned long now = fifo_batch_time_us;
+  
+  // A batch read before a reconfiguration was taken at the old rate/scale
+  if (fifo_batch_generation != ring_generation) {
+    return 0;
+  }
+  
+  uint16_t total = 0;
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    total += fifo_batch_counts[ch];
+  }
+  if (total == 0) {
+    return 0;
+  }
+  
+  // Decimate in place, remembering which FIFO entry completed each output;
+  // an output is flagged if any raw sample behind it clipped
+  const bool decimating = oversampleDecimator.isActive();
+  uint16_t output_total = total;
+  if (decimating) {
+    uint32_t start = ESP.getCycleCount();
+    output_total = 0;
+    for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+      uint16_t n = 0;
+      for (uint16_t i = 0; i < fifo_batch_counts[ch]; i++) {
+        AccelRawData& s = fifo_batch[ch][i];
+        clip_pending[ch] |= clipMask(s);
+        if (oversampleDecimator.process(ch, s.x, s.y, s.z)) {
+          fifo_batch[ch][n] = s;
+          source[ch][n] = i;
+          clip_flags[ch][n] = clip_pending[ch];
+          clip_pending[ch] = 0;
+          n++;
+        }
+      }
+      outputs[ch] = n;
+      output_total += n;
+    }
+    accountStageCost(task_status.decimator_cost, ESP.getCycleCount() - start, total, DECIMATOR_BUDGET_CYCLES);
+  } else {
+    for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+      outputs[ch] = fifo_batch_counts[ch];
+      for (uint16_t i = 0; i < fifo_batch_counts[ch]; i++) {
+        clip_flags[ch][i] = clipMask(fifo_batch[ch][i]);
+      }
+    }
+  }
+  
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    memcpy(unfiltered[ch], fifo_batch[ch], outputs[ch] * sizeof(AccelRawData));
+  }
+  
+  if (sampleFilter.isActive()) {
+    uint32_t start = ESP.getCycleCount();
+    for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+      for (uint16_t i = 0; i < outputs[ch]; i++) {
+        sampleFilter.process(ch, fifo_batch[ch][i].x, fifo_batch[ch][i].y, fifo_batch[ch][i].z);
+      }
+    }
+    accountStageCost(task_status.filter_cost, ESP.getCycleCount() - start, output_total, FILTER_BUDGET_CYCLES);
+  }
+  
+  if (toneBank.isActive()) {
+    uint32_t start = ESP.getCycleCount();
+    for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+      for (uint16_t i = 0; i < outputs[ch]; i++) {
+        toneBank.process(ch, fifo_batch[ch][i].x, fifo_batch[ch][i].y, fifo_batch[ch][i].z);
+      }
+    }
+    accountStageCost(task_status.tone_cost, ESP.getCycleCount() - start, output_total, GOERTZEL_BUDGET_CYCLES);
+  }
+  
+  uint16_t added = 0;
+  
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    uint16_t count = fifo_batch_counts[ch];
+    
+    for (uint16_t i = 0; i < outputs[ch]; i++) {
+      // Newest FIFO sample was taken at 'now'; older ones are one ODR period apart
+      uint16_t index = decimating ? source[ch][i] : i;
+      unsigned long timestamp_us = now - (unsigned long)(count - 1 - index) * sample_period_us - decimation_delay_us;
+      
+      if (!storeSample(ch, fifo_batch[ch][i], unfiltered[ch][i], timestamp_us, clip_flags[ch][i])) {
+        continue;
+      }
+      if (ch == 0) {
+        added++;
+      }
+    }
+  }
+  
+  if (added > 0) {
+    task_status.last_sample_time = millis();
+  }
+  
+  return added;
+}
+
+template <typename Policy>
+static uint16_t drainSensorFifo() {
+  const uint8_t mask = Policy::channelMask();
+  
+  // Queue every channel first so the bursts stay back-to-back on the bus
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    if (mask & (1 << ch)) {
+      Policy::queueBurstRaw(ch, ACCEL_MAX_BURST_SAMPLES);
+    }
+  }
+  unsigned long now = micros();
+  
+  // Runs while the bursts are in flight
+  uint16_t added = processFifoBatch();
+  
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    fifo_batch_counts[ch] = 0;
+    if (!(mask & (1 << ch))) {
+      continue;
+    }
+    
+    AccelBurstInfo info;
+    fifo_batch_counts[ch] = Policy::collectBurstRaw(ch, fifo_batch[ch], ACCEL_MAX_BURST_SAMPLES, info);
+    
+    if (info.overrun) {
+      task_status.fifo_overruns++;
+    }
+    if (info.fifo_entries > task_status.fifo_peak_level) {
+      task_status.fifo_peak_level = info.fifo_entries;
+    }
+  }
+  fifo_batch_time_us = now;
+  fifo_batch_generation = ring_generation;
+  task_status.fifo_drains++;
+  
+  return added;
+}
+
+// Interrupt path: wait for the sensor's own data-ready edge, so the sample
+// rate follows the sensor ODR clock instead of the FreeRTOS tick
+template <typename Policy>
+static uint16_t waitDataReady() {
+  uint32_t pending = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(DRDY_TIMEOUT_MS));
+  
+  if (pending == 0) {
+    // No edge - force a read so a latched DRDY line is released
+    task_status.drdy_timeouts++;
+    return pollSensor<Policy>(micros());
+  }
+  
+  if (pending > 1) {
+    // We were late: the data registers only hold the newest sample
+    task_status.missed_samples += pending - 1;
+  }
+  
+  unsigned long timestamp_us = drdy_timestamp_us;
+  
+  // Track worst period deviation, published once per 1000 edges
+  static unsigned long last_edge_us = 0;
+  static unsigned long window_jitter_max_us = 0;
+  static uint16_t window_edges = 0;
+  if (last_edge_us != 0 && pending == 1) {
+    long deviation = (long)(timestamp_us - last_edge_us) - (long)sample_period_us;
+    unsigned long jitter_us = (unsigned long)(deviation < 0 ? -deviation : deviation);
+    if (jitter_us > window_jitter_max_us) {
+      window_jitter_max_us = jitter_us;
+    }
+  }
+  last_edge_us = timestamp_us;
+  
+  if (++window_edges >= 1000) {
+    task_status.drdy_jitter_max_us = window_jitter_max_us;
+    window_jitter_max_us = 0;
+    window_edges = 0;
+  }
+  
+  return pollSensor<Policy>(timestamp_us);
+}
+
+// Fastest sensor rate the acquisition mode and sensor can oversample at
+static uint32_t maxOversampledRate(uint8_t mode) {
+  uint32_t max_rate = OVERSAMPLE_MAX_RATE_HZ;
+  if (accelerometer.getSensorType() == ACCEL_SENSOR_MPU6050) {
+    max_rate = MPU6050_MAX_RATE_HZ;
+  }
+  if (mode == ACQ_MODE_POLLING && max_rate > configTICK_RATE_HZ) {
+    max_rate = configTICK_RATE_HZ;  // One read per scheduler tick
+  }
+  return max_rate;
+}
+
+// Retune sensor, buffer window and timing; runs on the sampling task between samples
+static bool applyAcquisitionConfig(const AcquisitionConfig& config, uint8_t mode) {
+  if (xSemaphoreTake(buffer_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+    task_status.config_errors++;
+    return false;
+  }
+  
+  // Run the sensor faster than requested where possible; the decimator
+  // brings it back down behind a sharper anti-alias filter than the sensor's
+  AccelConfig sensor_config = config.sensor;
+  uint32_t oversampled = (uint32_t)config.sensor.sample_rate_hz << OVERSAMPLE_STAGES;
+  uint32_t max_rate = maxOversampledRate(mode);
+  if (oversampled > max_rate) {
+    oversampled = max_rate;
+  }
+  if (oversampled > config.sensor.sample_rate_hz) {
+    sensor_config.sample_rate_hz = oversampled;
+  }
+  
+  bool success = accelerometer.configure(sensor_config);
+  
+  if (success) {
+    uint16_t sensor_rate = accelerometer.getSampleRate();
+    uint8_t stages = 0;
+    while (stages < OVERSAMPLE_STAGES && (sensor_rate >> (stages + 1)) >= config.sensor.sample_rate_hz) {
+      stages++;
+    }
+    uint16_t rate = sensor_rate >> stages;
+    unsigned long output_period_us = 1000000UL / rate;
+    sample_period_us = 1000000UL / sensor_rate;
+    sample_scale = accelerometer.getScale();
+    
+    clip_limit = (1L << (sample_scale.resolution_bits - 1)) - 1;
+    memset(clip_pending, 0, sizeof(clip_pending));
+    oversampleDecimator.configure(stages);
+    decimation_delay_us = oversampleDecimator.getDelaySamples() * sample_period_us;
+    trendDecimator.configure(TREND_DECIMATION_STAGES);
+    trend_delay_us = trendDecimator.getDelaySamples() * output_period_us;
+    task_status.sensor_rate_hz = sensor_rate;
+    
+    // Samples still in flight were taken at the old rate/scale. The processing
+    // task only pops while holding buffer_mutex, so it sees the new tag before
+    // its next batch and skips them.
+    ring_generation++;
+    
+    uint32_t window_samples = ((uint32_t)rate * config.window_length_ms) / 1000;
+    uint32_t hop_samples = ((uint32_t)rate * config.hop_length_ms) / 1000;
+    if (window_samples > 0xFFFF) window_samples = 0xFFFF;
+    if (hop_samples == 0 || hop_samples > window_samples) hop_samples = window_samples;
+    
+    // Overlap needs the sliding ring on every channel; without the memory all
+    // channels fall back to tumbling windows and the hop reads back as 0
+    bool overlap_ok = true;
+    for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+      overlap_ok = slidingWindows[ch].configure(window_samples, hop_samples, rate, sample_scale.counts_per_g) &&
+                   overlap_ok;
+    }
+    if (!overlap_ok) {
+      hop_samples = window_samples;
+      for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+        slidingWindows[ch].configure(window_samples, hop_samples, rate, sample_scale.counts_per_g);
+      }
+      task_status.config_errors++;
+    }
+    
+    for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+      dataBuffers[ch].configure(window_samples, rate, sample_scale.counts_per_g);
+      sampleHistory[ch].setSamplingInterval(output_period_us);
+      sampleHistory[ch].reset();
+      trendHistory[ch].setSamplingInterval(output_period_us * trendDecimator.getFactor());
+      trendHistory[ch].reset();
+    }
+    eventCapture.setTiming(rate, (float)sample_scale.counts_per_g);
+    sampleFilter.setSampleRate(rate);
+    // One velocity RMS per reported window: the whole window when tumbling, each hop when sliding
+    velocityMeter.configure(rate, sample_scale.counts_per_g, (uint16_t)hop_samples);
+    envelopeAnalyzer.configure(rate, sample_scale.counts_per_g);
+    toneBank.configure(rate, sample_scale.counts_per_g, (uint16_t)window_samples);
+    
+    // Report the rate the buffers actually run at
+    active_acquisition_config = config;
+    active_acquisition_config.sensor.sample_rate_hz = rate;
+    if (accelerometer.getCapabilities().max_lpf_code == 0) {
+      active_acquisition_config.sensor.lpf_code = 0;  // Nothing selectable on this sensor
+    }
+    active_acquisition_config.window_length_ms = 
+      (uint16_t)(((uint32_t)dataBuffer.getWindowLength() * 1000) / rate);
+    sliding_mode = slidingWindows[0].getHopLength() < slidingWindows[0].getWindowLength();
+    active_acquisition_config.hop_length_ms = sliding_mode ?
+      (uint16_t)(((uint32_t)slidingWindows[0].getHopLength() * 1000) / rate) : 0;
+    task_status.config_generation++;
+    
+    // Standby during reconfiguration clears the sensor FIFO; re-prime it
+    if (mode == ACQ_MODE_FIFO) {
+      accelerometer.beginFifo(FIFO_WATERMARK_SAMPLES);
+    }
+  } else {
+    task_status.config_errors++;
+  }
+  
+  xSemaphoreGive(buffer_mutex);
+  return success;
+}
+
+static TickType_t pollingPeriodTicks() {
+  TickType_t ticks = pdMS_TO_TICKS(sample_period_us / 1000);
+  return ticks > 0 ? ticks : 1;  // Polling cannot run faster than the tick
+}
+
+bool requestAcquisitionConfig(const AcquisitionConfig& config) {
+  if (config_queue == nullptr) {
+    return false;
+  }
+  
+  // Latest request wins; the sampling task picks it up on its next wakeup
+  return xQueueOverwrite(config_queue, &config) == pdTRUE;
+}
+
+// Acquisition loop, compiled once per sensor policy so the hot path calls
+// the driver directly
+template <typename Policy>
+static void samplingLoop(uint8_t mode) {
   TickType_t xLastWakeTime = xTaskGetTickCount();
-  const TickType_t xFrequency = pdMS_TO_TICKS(1); // 1ms = 1000Hz
+  TickType_t xFrequency = (mode == ACQ_MODE_FIFO) ? pdMS_TO_TICKS(FIFO_DRAIN_INTERVAL_MS) 
+                                                  : pollingPeriodTicks(); // 1ms = 1000Hz
   
   unsigned long sample_count = 0;
+  unsigned long next_rate_update = 1000;
   unsigned long start_time = millis();
   
   while (true) {
     task_status.sampling_loop_count++;
     
     try {
-      // Take mutex to access buffer safely
-      if (xSemaphoreTake(buffer_mutex, pdMS_TO_TICKS(1)) == pdTRUE) {
-        
-        // Check if buffer has space
-        if (!dataBuffer.isFull()) {
-          // Read sensor data using abstraction layer
-          AccelData accelData;
-          if (accelerometer.readData(accelData) && accelData.valid) {
-            // Convert g-force to raw values for compatibility with existing buffer system
-            // Assuming scale factor similar to ADXL355 (can be adjusted)
-            int32_t x = (int32_t)(accelData.x * 256000.0f);
-            int32_t y = (int32_t)(accelData.y * 256000.0f);
-            int32_t z = (int32_t)(accelData.z * 256000.0f);
-            
-            #if ENABLE_DEBUG_OUTPUT
-            static unsigned long last_sensor_debug = 0;
-            if (millis() - last_sensor_debug > 3000) {  // Debug every 3 seconds
-              Serial.printf("[SENSOR-RAW] Raw values: X=%ld, Y=%ld, Z=%ld\n", x, y, z);
-              Serial.printf("[SENSOR-G] G-values: X=%.6f, Y=%.6f, Z=%.6f (%s)\n", 
-                           accelData.x, accelData.y, accelData.z, accelerometer.getSensorName());
-              last_sensor_debug = millis();
-            }
-            #endif
-            
-            // Add sample to buffer
-            if (dataBuffer.addSample(x, y, z)) {
-              sample_count++;
-              task_status.last_sample_time = millis();
-              
-              // Check if buffer is now full
-              if (dataBuffer.isFull()) {
-                // Signal processing task that buffer is ready
-                xSemaphoreGive(buffer_ready_semaphore);
-              }
-            } else {
-              task_status.sampling_errors++;
-            }
-          } else {
-            // Failed to read sensor data
-            task_status.sampling_errors++;
+      // Apply pending configuration from Modbus without stopping the task
+      AcquisitionConfig requested;
+      if (xQueueReceive(config_queue, &requested, 0) == pdTRUE) {
+        if (applyAcquisitionConfig(requested, mode)) {
+          if (mode == ACQ_MODE_POLLING) {
+            xFrequency = pollingPeriodTicks();
           }
-        } else {
-          // Buffer is full and hasn't been processed yet
-          task_status.missed_samples++;
+          sample_count = 0;
+          next_rate_update = 1000;
+          start_time = millis();
         }
-        
-        xSemaphoreGive(buffer_mutex);
-        
-      } else {
-        // Couldn't get mutex in time
-        task_status.missed_samples++;
       }
       
-      // Calculate actual sample rate every second
-      if (sample_count > 0 && (sample_count % 1000) == 0) {
+      // Filter and tone settings from Modbus take effect between samples
+      sampleFilter.update();
+      toneBank.update();
+      
+      switch (mode) {
+        case ACQ_MODE_FIFO:
+          sample_count += drainSensorFifo<Policy>();
+          break;
+        case ACQ_MODE_DRDY:
+          sample_count += waitDataReady<Policy>();
+          break;
+        default:
+          sample_count += pollSensor<Policy>(micros());
+          break;
+      }
+      
+      // Calculate actual sample rate every 1000 samples
+      if (sample_count >= next_rate_update) {
         unsigned long elapsed = millis() - start_time;
         task_status.actual_sample_rate = (sample_count * 1000.0) / elapsed;
+        next_rate_update = sample_count + 1000;
       }
       
     } catch (...) {
       task_status.sampling_errors++;
     }
     
-    // Wait for next sample time (maintains 1kHz rate)
-    vTaskDelayUntil(&xLastWakeTime, xFrequency);
+    // DRDY mode is paced by the sensor; the other modes by the scheduler tick
+    if (mode != ACQ_MODE_DRDY) {
+      vTaskDelayUntil(&xLastWakeTime, xFrequency);
+    }
+  }
+}
+
+void samplingTask(void* parameter) {
+  Serial.println("Sampling task started on core " + String(xPortGetCoreID()));
+  task_status.sampling_task_running = true;
+  
+  uint8_t mode = ACQUISITION_MODE;
+  
+  if (mode == ACQ_MODE_FIFO) {
+    if (accelerometer.beginFifo(FIFO_WATERMARK_SAMPLES)) {
+      Serial.printf("Sampling task: FIFO burst mode, draining every %d ms\n", FIFO_DRAIN_INTERVAL_MS);
+    } else {
+      Serial.printf("Sampling task: FIFO not available on %s, using polling\n", accelerometer.getSensorName());
+      mode = ACQ_MODE_POLLING;
+    }
+  } else if (mode == ACQ_MODE_DRDY) {
+    uint8_t irq_pin = DRDY_USE_INT1 ? INT1_PIN : DRDY_PIN;
+    if (accelerometer.beginDataReady(DRDY_USE_INT1)) {
+      pinMode(irq_pin, INPUT);
+      attachInterrupt(digitalPinToInterrupt(irq_pin), sensorDataReadyISR, RISING);
+      Serial.printf("Sampling task: data-ready interrupt mode on GPIO %d\n", irq_pin);
+    } else {
+      Serial.printf("Sampling task: data-ready not available on %s, using polling\n", accelerometer.getSensorName());
+      mode = ACQ_MODE_POLLING;
+    }
+  }
+  task_status.acquisition_mode = mode;
+  
+  // Program ODR, range and filter before the first sample
+  applyAcquisitionConfig(active_acquisition_config, mode);
+  
+  // Instantiate the acquisition loop for the detected sensor
+  switch (accelerometer.getSensorType()) {
+    case ACCEL_SENSOR_ADXL355:
+      samplingLoop<Adxl355Policy>(mode);
+      break;
+    case ACCEL_SENSOR_MPU6050:
+      samplingLoop<Mpu6050Policy>(mode);
+      break;
+    default:
+      samplingLoop<NoSensorPolicy>(mode);
+      break;
+  }
+}
+
+// Queue one window's statistics for the analytics task
+static void publishStats(BufferStats& stats, uint8_t channel) {
+  stats.channel = channel;
+  
+  // Send stats to analytics task via queue
+  if (analytics_queue != nullptr) {
+    if (xQueueSend(analytics_queue, &stats, pdMS_TO_TICKS(10)) != pdTRUE) {
+      Serial.println("Failed to send stats to analytics queue");
+      task_status.processing_errors++;
+    }
   }
+  
+  spectrumAnalyzer.markDue(channel);
+  
+  task_status.last_processing_time = millis();
+}
+
+// Close the completed window: stats to the analytics task, buffer released
+static void processWindow(uint8_t channel) {
+  ChannelBuffer& buffer = dataBuffers[channel];
+  
+  BufferStats stats;
+  buffer.calculateStats(stats);
+  // buffer.printStats(stats);
+  publishStats(stats, channel);
+  
+  // The next sample starts a new window
+  buffer.releaseWindow();
 }
 
 void processingTask(void* parameter) {
   Serial.println("Processing task started on core " + String(xPortGetCoreID()));
   task_status.processing_task_running = true;
   
+  static RingSample batch[RING_BATCH_SAMPLES];
+  
   while (true) {
     task_status.processing_loop_count++;
     
-    // Wait for buffer to be ready (blocks until signaled)
-    if (xSemaphoreTake(buffer_ready_semaphore, portMAX_DELAY) == pdTRUE) {
-      
-      try {
-        // Take mutex to access buffer safely
-        if (xSemaphoreTake(buffer_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-          
-          // Process the buffer data
-          if (dataBuffer.isFull()) {
-            BufferStats stats;
-            dataBuffer.calculateStats(stats);
-            // dataBuffer.printStats(stats);
+    // Woken once a batch is queued, or on timeout to pick up a partial batch
+    xSemaphoreTake(buffer_ready_semaphore, pdMS_TO_TICKS(RING_DRAIN_TIMEOUT_MS));
+    
+    try {
+      // Buffers are only shared with reconfiguration, never with the sampler
+      if (xSemaphoreTake(buffer_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        
+        velocityMeter.update();
+        envelopeAnalyzer.update();
+        
+        // Stable while buffer_mutex is held
+        const uint8_t generation = ring_generation;
+        
+        uint32_t count;
+        while ((count = sample_ring.popBatch(batch, RING_BATCH_SAMPLES)) > 0) {
+          uint32_t trend_cycles = 0;
+          uint32_t velocity_cycles = 0;
+          uint32_t envelope_cycles = 0;
+          for (uint32_t i = 0; i < count; i++) {
+            const RingSample& sample = batch[i];
+            if (sample.generation != generation) {
+              continue;  // Taken before the last reconfiguration
+            }
+            if (sample.channel >= NUM_ACCEL_CHANNELS) {
+              task_status.processing_errors++;
+              continue;
+            }
+            
+            // Histories and event captures hold the unfiltered stream
+            sampleHistory[sample.channel].add(sample.raw_x, sample.raw_y, sample.raw_z, sample.timestamp_us);
+            
+            // Same stream at the trend rate for long-term storage
+            int32_t tx = sample.raw_x, ty = sample.raw_y, tz = sample.raw_z;
+            uint32_t trend_start = ESP.getCycleCount();
+            if (trendDecimator.process(sample.channel, tx, ty, tz)) {
+              trendHistory[sample.channel].add(tx, ty, tz, sample.timestamp_us - trend_delay_us);
+            }
+            trend_cycles += ESP.getCycleCount() - trend_start;
+            eventCapture.processSample(sample.channel, sample.raw_x, sample.raw_y, sample.raw_z,
+                                       sample.timestamp_us, sampleHistory);
             
-            // Send stats to analytics task via queue
-            if (analytics_queue != nullptr) {
-              if (xQueueSend(analytics_queue, &stats, pdMS_TO_TICKS(10)) != pdTRUE) {
-                Serial.println("Failed to send stats to analytics queue");
-                task_status.processing_errors++;
+            uint32_t velocity_start = ESP.getCycleCount();
+            velocityMeter.processSample(sample.channel, sample.x, sample.y, sample.z);
+            velocity_cycles += ESP.getCycleCount() - velocity_start;
+            
+            uint32_t envelope_start = ESP.getCycleCount();
+            envelopeAnalyzer.processSample(sample.channel, sample.x, sample.y, sample.z);
+            envelope_cycles += ESP.getCycleCount() - envelope_start;
+            
+            // Overlapping windows: statistics are updated per sample and
+            // reported every hop without a rescan. The SlidingWindow is the
+            // only window source in this mode; the DataBuffer is not fed and
+            // each hop is published as a window.
+            if (sliding_mode) {
+              SlidingWindow& window = slidingWindows[sample.channel];
+              if (window.addSample(sample.x, sample.y, sample.z, sample.timestamp_us, sample.clipped)) {
+                BufferStats stats;
+                window.calculateStats(stats);
+                publishStats(stats, sample.channel);
               }
+              continue;
             }
             
-            // Reset buffer for next collection cycle
-            dataBuffer.reset();
+            ChannelBuffer& buffer = dataBuffers[sample.channel];
+            if (!buffer.addSample(sample.x, sample.y, sample.z, sample.timestamp_us, sample.clipped)) {
+              task_status.missed_samples++;
+            }
             
-            task_status.last_processing_time = millis();
+            // Close a completed window before the next sample arrives
+            if (buffer.hasReadyWindow()) {
+              processWindow(sample.channel);
+            }
           }
           
-          xSemaphoreGive(buffer_mutex);
+          accountStageCost(task_status.trend_cost, trend_cycles, count, DECIMATOR_BUDGET_CYCLES);
+          accountStageCost(task_status.velocity_cost, velocity_cycles, count, VELOCITY_BUDGET_CYCLES);
+          if (envelopeAnalyzer.isActive()) {
+            accountStageCost(task_status.envelope_cost, envelope_cycles, count, ENVELOPE_BUDGET_CYCLES);
+          }
+          
+          // Hand the newest samples of a finished window to the spectrum task
+          if (spectrum_task_handle != nullptr &&
+              spectrumAnalyzer.stage(sampleHistory, dataBuffer.getSampleRate(), (float)sample_scale.counts_per_g)) {
+            xTaskNotifyGive(spectrum_task_handle);
+          }
           
-        } else {
-          Serial.println("Processing task: Failed to get buffer mutex");
-          task_status.processing_errors++;
+          // At most one envelope axis spectrum per batch keeps the work bounded
+          envelopeAnalyzer.service();
         }
         
-      } catch (...) {
+        xSemaphoreGive(buffer_mutex);
+        
+      } else {
+        Serial.println("Processing task: Failed to get buffer mutex");
         task_status.processing_errors++;
       }
+      
+    } catch (...) {
+      task_status.processing_errors++;
     }
   }
 }
@@ -159,14 +813,19 @@ void analyticsTask(void* parameter) {
     if (xQueueReceive(analytics_queue, &stats, portMAX_DELAY) == pdTRUE) {
       
       try {
-        // Process the statistics with analytics
-        analytics.processBufferStats(stats);
+        // Process the statistics with the channel's analytics
+        uint8_t ch = stats.channel < NUM_ACCEL_CHANNELS ? stats.channel : 0;
+        Analytics& channel_analytics = analyticsChannels[ch];
+        channel_analytics.processBufferStats(stats);
         
         task_status.last_analytics_time = millis();
         
         // Print analytics every 10 windows (10 seconds)
-        if (analytics.getWindowCount() % 10 == 0) {
-          analytics.printRunningStats();
+        if (channel_analytics.getWindowCount() % 10 == 0) {
+          if (NUM_ACCEL_CHANNELS > 1) {
+            Serial.printf("--- Channel %d ---\n", ch);
+          }
+          channel_analytics.printRunningStats();
         }
         
       } catch (...) {
@@ -205,6 +864,17 @@ void modbusTask(void* parameter) {
   #endif
 }
 
+void spectrumTask(void* parameter) {
+  Serial.println("Spectrum task started on core " + String(xPortGetCoreID()));
+  task_status.spectrum_task_running = true;
+  
+  while (true) {
+    // Woken by the processing task once a window's samples are staged
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    spectrumAnalyzer.process();
+  }
+}
+
 bool startTasks() {
   Serial.println("Initializing FreeRTOS tasks...");
   
@@ -222,8 +892,15 @@ bool startTasks() {
     return false;
   }
   
-  // Create queue for analytics data (hold up to 3 BufferStats)
-  analytics_queue = xQueueCreate(3, sizeof(BufferStats));
+  // Create single-slot queue for runtime configuration requests
+  config_queue = xQueueCreate(1, sizeof(AcquisitionConfig));
+  if (config_queue == nullptr) {
+    Serial.println("Failed to create config queue!");
+    return false;
+  }
+  
+  // Create queue for analytics data (hold up to 3 BufferStats per channel)
+  analytics_queue = xQueueCreate(3 * NUM_ACCEL_CHANNELS, sizeof(BufferStats));
   if (analytics_queue == nullptr) {
     Serial.println("Failed to create analytics queue!");
     return false;
@@ -262,6 +939,17 @@ bool startTasks() {
     ANALYTICS_TASK_CORE              // Core
   );
   
+  // Create spectrum task (background, core 0)
+  BaseType_t result5 = xTaskCreatePinnedToCore(
+    spectrumTask,                    // Task function
+    "SpectrumTask",                  // Task name
+    SPECTRUM_TASK_STACK_SIZE,        // Stack size
+    nullptr,                         // Parameter
+    SPECTRUM_TASK_PRIORITY,          // Priority
+    &spectrum_task_handle,           // Task handle
+    SPECTRUM_TASK_CORE               // Core
+  );
+  
   #if ENABLE_MODBUS_INTERFACE
   // Create modbus task (same priority as analytics, core 0)
   BaseType_t result4 = xTaskCreatePinnedToCore(
@@ -277,7 +965,8 @@ bool startTasks() {
   BaseType_t result4 = pdPASS;  // Dummy success result when Modbus is disabled
   #endif
   
-  if (result1 == pdPASS && result2 == pdPASS && result3 == pdPASS && result4 == pdPASS) {
+  if (result1 == pdPASS && result2 == pdPASS && result3 == pdPASS && result4 == pdPASS &&
+      result5 == pdPASS) {
     Serial.println("All tasks created successfully");
     return true;
   } else {
@@ -311,6 +1000,12 @@ void stopTasks() {
     task_status.modbus_task_running = false;
   }
   
+  if (spectrum_task_handle != nullptr) {
+    vTaskDelete(spectrum_task_handle);
+    spectrum_task_handle = nullptr;
+    task_status.spectrum_task_running = false;
+  }
+  
   if (buffer_mutex != nullptr) {
     vSemaphoreDelete(buffer_mutex);
     buffer_mutex = nullptr;
@@ -326,6 +1021,11 @@ void stopTasks() {
     analytics_queue = nullptr;
   }
   
+  if (config_queue != nullptr) {
+    vQueueDelete(config_queue);
+    config_queue = nullptr;
+  }
+  
   Serial.println("All tasks stopped");
 }
 
@@ -335,6 +1035,7 @@ void printTaskInfo() {
   Serial.print("Processing task running: "); Serial.println(task_status.processing_task_running ? "Yes" : "No");
   Serial.print("Analytics task running: "); Serial.println(task_status.analytics_task_running ? "Yes" : "No");
   Serial.print("Modbus task running: "); Serial.println(task_status.modbus_task_running ? "Yes" : "No");
+  Serial.print("Spectrum task running: "); Serial.println(task_status.spectrum_task_running ? "Yes" : "No");
   Serial.print("Sampling loops: "); Serial.println(task_status.sampling_loop_count);
   Serial.print("Processing loops: "); Serial.println(task_status.processing_loop_count);
   Serial.print("Analytics loops: "); Serial.println(task_status.analytics_loop_count);
@@ -344,7 +1045,71 @@ void printTaskInfo() {
   Serial.print("Analytics errors: "); Serial.println(task_status.analytics_errors);
   Serial.print("Modbus errors: "); Serial.println(task_status.modbus_errors);
   Serial.print("Missed samples: "); Serial.println(task_status.missed_samples);
+  Serial.print("Sample ring peak: "); Serial.print(task_status.ring_peak_level);
+  Serial.print(" / "); Serial.println(SAMPLE_RING_SIZE);
+  Serial.print("Acquisition mode: ");
+  Serial.println(task_status.acquisition_mode == ACQ_MODE_FIFO ? "FIFO" :
+                 task_status.acquisition_mode == ACQ_MODE_DRDY ? "DRDY" : "Polling");
+  if (task_status.acquisition_mode == ACQ_MODE_DRDY) {
+    Serial.print("DRDY max jitter: "); Serial.print(task_status.drdy_jitter_max_us); Serial.println(" us");
+    Serial.print("DRDY timeouts: "); Serial.println(task_status.drdy_timeouts);
+  }
+  if (task_status.acquisition_mode == ACQ_MODE_FIFO) {
+    Serial.print("FIFO drains: "); Serial.println(task_status.fifo_drains);
+    Serial.print("FIFO overruns: "); Serial.println(task_status.fifo_overruns);
+    Serial.print("FIFO peak level: "); Serial.print(task_status.fifo_peak_level); Serial.println(" samples");
+  }
   Serial.print("Actual sample rate: "); Serial.print(task_status.actual_sample_rate, 1); Serial.println(" Hz");
+  Serial.printf("Channels: %d configured, mask 0x%02X\n", NUM_ACCEL_CHANNELS, accelerometer.getChannelMask());
+  Serial.printf("History: %.1f s held, %lu samples/channel (%s)\n", sampleHistory[0].getSpanSeconds(),
+                (unsigned long)sampleHistory[0].getCapacity(), sampleHistory[0].isInPsram() ? "PSRAM" : "internal RAM");
+  eventCapture.printInfo();
+  sampleFilter.printInfo();
+  if (sampleFilter.isActive()) {
+    Serial.printf("Filter cost: %d cycles/sample avg, %d peak, budget %d (%lu batches over)\n",
+                  task_status.filter_cost.cycles_avg, task_status.filter_cost.cycles_peak, FILTER_BUDGET_CYCLES,
+                  task_status.filter_cost.over_budget);
+  }
+  Serial.printf("Decimation: sensor %d Hz -> %d Hz (x%d), trend %d Hz (x%d)\n", task_status.sensor_rate_hz,
+                active_acquisition_config.sensor.sample_rate_hz, oversampleDecimator.getFactor(),
+                active_acquisition_config.sensor.sample_rate_hz / trendDecimator.getFactor(),
+                trendDecimator.getFactor());
+  if (oversampleDecimator.isActive()) {
+    Serial.printf("Decimator cost: %d cycles/sample avg, %d peak, budget %d (%lu batches over)\n",
+                  task_status.decimator_cost.cycles_avg, task_status.decimator_cost.cycles_peak,
+                  DECIMATOR_BUDGET_CYCLES, task_status.decimator_cost.over_budget);
+  }
+  Serial.printf("Trend decimator cost: %d cycles/sample avg, %d peak\n", task_status.trend_cost.cycles_avg,
+                task_status.trend_cost.cycles_peak);
+  velocityMeter.printInfo();
+  Serial.printf("Velocity cost: %d cycles/sample avg, %d peak, budget %d (%lu batches over)\n",
+                task_status.velocity_cost.cycles_avg, task_status.velocity_cost.cycles_peak,
+                VELOCITY_BUDGET_CYCLES, task_status.velocity_cost.over_budget);
+  envelopeAnalyzer.printInfo();
+  if (envelopeAnalyzer.isActive()) {
+    Serial.printf("Envelope cost: %d cycles/sample avg, %d peak, budget %d (%lu batches over)\n",
+                  task_status.envelope_cost.cycles_avg, task_status.envelope_cost.cycles_peak,
+                  ENVELOPE_BUDGET_CYCLES, task_status.envelope_cost.over_budget);
+  }
+  toneBank.printInfo();
+  if (toneBank.isActive()) {
+    Serial.printf("Tone bank cost: %d cycles/sample avg, %d peak, budget %d (%lu batches over)\n",
+                  task_status.tone_cost.cycles_avg, task_status.tone_cost.cycles_peak,
+                  GOERTZEL_BUDGET_CYCLES, task_status.tone_cost.over_budget);
+  }
+  Serial.printf("Trend history: %.1f s held, %lu samples/channel (%s)\n", trendHistory[0].getSpanSeconds(),
+                (unsigned long)trendHistory[0].getCapacity(), trendHistory[0].isInPsram() ? "PSRAM" : "internal RAM");
+  SpectrumResult spectrum;
+  if (spectrumAnalyzer.getResult(0, spectrum)) {
+    Serial.printf("Spectrum: %d points, %.2f Hz bins, %lu us/window, %lu skipped (%s kernels)\n", SPECTRUM_FFT_SIZE,
+                  spectrum.resolution_hz, spectrum.compute_us, (unsigned long)spectrumAnalyzer.getSkipped(),
+                  statsKernelBackend());
+  }
+  Serial.printf("Configuration: %d Hz, ±%dg, HPF %d, LPF %d, window %d ms, hop %d ms (%lu changes, %lu errors)\n",
+                active_acquisition_config.sensor.sample_rate_hz, active_acquisition_config.sensor.range_g,
+                active_acquisition_config.sensor.hpf_corner, active_acquisition_config.sensor.lpf_code,
+                active_acquisition_config.window_length_ms,
+                active_acquisition_config.hop_length_ms, task_status.config_generation, task_status.config_errors);
   Serial.print("Last sample: "); Serial.print(millis() - task_status.last_sample_time); Serial.println(" ms ago");
   Serial.print("Last processing: "); Serial.print(millis() - task_status.last_processing_time); Serial.println(" ms ago");
   Serial.print("Last analytics: "); Serial.print(millis() - task_status.last_analytics_time); Serial.println(" ms ago");
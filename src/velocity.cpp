@@ -0,0 +1,176 @@
+#include "velocity.h"
+#include "fixed_point.h"
+
+VelocityMeter velocityMeter;
+
+// Zone boundaries A/B, B/C and C/D in um/s RMS, per machine class
+static const uint16_t iso_zone_limits_um_s[ISO_NUM_MACHINE_CLASSES][3] = {
+  {  710, 1800,  4500 },   // 10816-1 class I: small machines up to 15 kW
+  { 1120, 2800,  7100 },   // 10816-1 class II: medium machines, 15-75 kW
+  { 1800, 4500, 11200 },   // 10816-1 class III: large machines, rigid foundations
+  { 2800, 7100, 18000 },   // 10816-1 class IV: large machines, flexible foundations
+  { 2300, 4500,  7100 },   // 10816-3 group 1 (300 kW - 50 MW), rigid
+  { 3500, 7100, 11000 },   // 10816-3 group 1, flexible
+  { 1400, 2800,  4500 },   // 10816-3 group 2 (15 - 300 kW), rigid
+  { 2300, 4500,  7100 }    // 10816-3 group 2, flexible
+};
+
+VelocityMeter::VelocityMeter() : block_samples(0), sample_rate_hz(SAMPLE_RATE_HZ), counts_per_g(0),
+                                 scale_q24(0), leak_shift(0), machine_class(DEFAULT_ISO_MACHINE_CLASS),
+                                 highpass_hz(DEFAULT_VELOCITY_HIGHPASS_HZ), highpass_active(false),
+                                 requested_class(DEFAULT_ISO_MACHINE_CLASS),
+                                 requested_highpass_hz(DEFAULT_VELOCITY_HIGHPASS_HZ), settings_pending(false) {
+  memset(axes, 0, sizeof(axes));
+  memset(primed, 0, sizeof(primed));
+  memset(block_count, 0, sizeof(block_count));
+  memset(results, 0, sizeof(results));
+  results_lock = portMUX_INITIALIZER_UNLOCKED;
+}
+
+void VelocityMeter::configure(uint16_t sample_rate, int32_t counts_per_g, uint16_t block_length) {
+  sample_rate_hz = sample_rate ? sample_rate : SAMPLE_RATE_HZ;
+  this->counts_per_g = counts_per_g;
+  block_samples = block_length;
+
+  // v = integral / (8 fs) / counts_per_g * g, with g in um/s^2
+  scale_q24 = counts_per_g > 0 ?
+    divRound((int64_t)9806650 << VELOCITY_SCALE_FRAC_BITS, 8 * (int64_t)sample_rate_hz * counts_per_g) : 0;
+
+  applySettings();
+}
+
+void VelocityMeter::setSettings(uint8_t machine_class, uint16_t highpass_hz) {
+  requested_class = machine_class < ISO_NUM_MACHINE_CLASSES ? machine_class : DEFAULT_ISO_MACHINE_CLASS;
+  requested_highpass_hz = highpass_hz;
+  settings_pending = true;
+}
+
+void VelocityMeter::applySettings() {
+  settings_pending = false;
+  machine_class = requested_class;
+  highpass_hz = requested_highpass_hz;
+
+  // Table first, then design; a corner the rate cannot carry falls back to
+  // the DC blocker so gravity still never reaches the integrator
+  BiquadCoeffs coeffs;
+  highpass_active = SampleFilter::lookupCoeffs(FILTER_HIGHPASS, sample_rate_hz, highpass_hz, coeffs) ||
+                    SampleFilter::designCoeffs(FILTER_HIGHPASS, sample_rate_hz, highpass_hz, coeffs);
+  if (!highpass_active) {
+    SampleFilter::designCoeffs(FILTER_DC_BLOCK, sample_rate_hz, 0, coeffs);
+  }
+
+  // Leak pole at 1 - 2^-k puts the integrator corner at fs / (2 pi 2^k);
+  // take the smallest k that puts it VELOCITY_LEAK_RATIO below the band
+  // edge: ratio * fs > 2 pi * corner * 2^k, with the corner in mHz
+  const uint64_t corner_mhz = highpass_active ? (uint64_t)highpass_hz * 1000 : (uint64_t)(FILTER_DC_BLOCK_HZ * 1000);
+  leak_shift = 1;
+  while ((uint64_t)VELOCITY_LEAK_RATIO * sample_rate_hz * 1000000 > ((6283 * corner_mhz) << leak_shift) &&
+         leak_shift < 16) {
+    leak_shift++;
+  }
+
+  for (uint8_t ch = 0; ch < NUM_ACCEL_CHANNELS; ch++) {
+    for (uint8_t a = 0; a < 3; a++) {
+      AxisVelocity& axis = axes[ch][a];
+      axis.highpass.coeffs[0] = coeffs;
+      axis.highpass.sections = 1;
+      axis.highpass.clearState();
+      axis.prev = 0;
+      axis.integral = 0;
+      axis.sum_sq = 0;
+    }
+    primed[ch] = false;
+    block_count[ch] = 0;
+  }
+
+  #if ENABLE_DEBUG_OUTPUT
+  Serial.printf("[VELOCITY] %d Hz high-pass%s, leak 2^-%d, class %d @ %d Hz\n", highpass_hz,
+                highpass_active ? "" : " (unusable, DC block)", leak_shift, machine_class, sample_rate_hz);
+  #endif
+}
+
+void VelocityMeter::processSample(uint8_t channel, int32_t x, int32_t y, int32_t z) {
+  if (block_samples == 0) {
+    return;
+  }
+  const int32_t in[3] = { x, y, z };
+
+  // Start the high-pass as if the first sample had always been there, so
+  // the gravity step does not ring through the integrator
+  if (!primed[channel]) {
+    for (uint8_t a = 0; a < 3; a++) {
+      AxisFilter& hp = axes[channel][a].highpass;
+      hp.x1[0] = hp.x2[0] = in[a];
+    }
+    primed[channel] = true;
+  }
+
+  for (uint8_t a = 0; a < 3; a++) {
+    AxisVelocity& axis = axes[channel][a];
+    int32_t hp = axis.highpass.process(in[a]);
+    axis.integral += 7 * hp + axis.prev;
+    axis.integral -= roundShift(axis.integral, leak_shift);
+    axis.prev = hp;
+
+    int64_t v = roundShift(axis.integral * scale_q24, VELOCITY_SCALE_FRAC_BITS);
+    if (v > VELOCITY_MAX_UM_S) v = VELOCITY_MAX_UM_S;
+    if (v < -VELOCITY_MAX_UM_S) v = -VELOCITY_MAX_UM_S;
+    axis.sum_sq += (uint64_t)(v * v);
+  }
+
+  if (++block_count[channel] >= block_samples) {
+    finishBlock(channel);
+  }
+}
+
+void VelocityMeter::finishBlock(uint8_t channel) {
+  VelocityResult result;
+  result.worst_zone = ISO_ZONE_A;
+  for (uint8_t a = 0; a < 3; a++) {
+    AxisVelocity& axis = axes[channel][a];
+    result.rms_um_s[a] = isqrt64((axis.sum_sq + block_count[channel] / 2) / block_count[channel]);
+    result.zone[a] = zoneFor(result.rms_um_s[a], machine_class);
+    if (result.zone[a] > result.worst_zone) {
+      result.worst_zone = result.zone[a];
+    }
+    axis.sum_sq = 0;
+  }
+  result.valid = true;
+  block_count[channel] = 0;
+
+  portENTER_CRITICAL(&results_lock);
+  result.sequence = results[channel].sequence + 1;
+  results[channel] = result;
+  portEXIT_CRITICAL(&results_lock);
+}
+
+bool VelocityMeter::getResult(uint8_t channel, VelocityResult& out) const {
+  if (channel >= NUM_ACCEL_CHANNELS) {
+    return false;
+  }
+  portENTER_CRITICAL(&results_lock);
+  out = results[channel];
+  portEXIT_CRITICAL(&results_lock);
+  return out.valid;
+}
+
+uint8_t VelocityMeter::zoneFor(uint32_t rms_um_s, uint8_t machine_class) {
+  if (machine_class >= ISO_NUM_MACHINE_CLASSES) {
+    machine_class = DEFAULT_ISO_MACHINE_CLASS;
+  }
+  const uint16_t* limits = iso_zone_limits_um_s[machine_class];
+  uint8_t zone = ISO_ZONE_A;
+  while (zone < ISO_ZONE_D && rms_um_s >= limits[zone]) {
+    zone++;
+  }
+  return zone;
+}
+
+void VelocityMeter::printInfo() const {
+  VelocityResult result;
+  getResult(0, result);
+  Serial.printf("Velocity: %d Hz high-pass%s, class %d, block %d samples, RMS %.2f/%.2f/%.2f mm/s, zone %c\n",
+                highpass_hz, highpass_active ? "" : " (DC block)", machine_class, block_samples,
+                result.rms_um_s[0] / 1000.0f, result.rms_um_s[1] / 1000.0f, result.rms_um_s[2] / 1000.0f,
+                'A' + result.worst_zone);
+}
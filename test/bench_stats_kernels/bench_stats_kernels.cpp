@@ -0,0 +1,269 @@
+// Check and benchmark of the statistics kernels against the original window loop
+//
+// The baseline is the loop DataBuffer::calculateStats used to run over each
+// completed window: one pass over an array of {x, y, z, timestamp} structs
+// with six min/max compares and three 64-bit multiply-accumulates per
+// sample. The kernels scan each axis of a structure-of-arrays window instead.
+//
+// Every kernel must first match a plain loop: the integer results exactly,
+// the float ones to within the rounding of a different summation order. A
+// mismatch prints FAIL and, on a host, exits non-zero. Timings follow, with
+// the speedup over the baseline.
+//
+// On the ESP32 it runs as a sketch and prints to Serial. On a host:
+//   g++ -O2 -msse4.1 -Iinclude test/bench_stats_kernels/bench_stats_kernels.cpp src/stats_kernels.cpp -o bench
+//   ./bench
+// Drop -msse4.1 to measure the portable backend.
+
+#include "stats_kernels.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#define BENCH_PRINTF Serial.printf
+static unsigned long benchNowUs() { return micros(); }
+#else
+#include <chrono>
+#define BENCH_PRINTF printf
+static unsigned long benchNowUs() {
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+#define BENCH_SAMPLES     1000   // One 1 s window at 1 kHz
+#define BENCH_FLOAT_TOL   1e-5f  // Relative, float kernels vs reference
+#ifdef ARDUINO
+#define BENCH_ITERATIONS  200
+#else
+#define BENCH_ITERATIONS  20000
+#endif
+
+struct BenchSample {
+  int32_t x, y, z;
+  unsigned long timestamp_us;
+};
+
+struct BenchStats {
+  int32_t min[3], max[3];
+  long long sum[3], sum_sq[3];
+};
+
+static BenchSample aos[BENCH_SAMPLES];
+static int32_t soa[3][BENCH_SAMPLES];
+static float fx[BENCH_SAMPLES];
+static float fy[BENCH_SAMPLES];
+static volatile long long sink;
+
+static void fillWindow() {
+  // 20-bit counts: gravity on z, a few tones and some noise
+  uint32_t seed = 12345;
+  for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+    seed = seed * 1103515245u + 12345u;
+    int32_t noise = (int32_t)((seed >> 16) & 0x3FF) - 512;
+    aos[i].x = (int32_t)(20000.0f * sinf(0.31f * i)) + noise;
+    aos[i].y = (int32_t)(9000.0f * sinf(0.07f * i + 1.0f)) - noise;
+    aos[i].z = 256000 + (int32_t)(4000.0f * sinf(1.3f * i)) + noise / 2;
+    aos[i].timestamp_us = i * 1000UL;
+    soa[0][i] = aos[i].x;
+    soa[1][i] = aos[i].y;
+    soa[2][i] = aos[i].z;
+    fx[i] = aos[i].x / 256000.0f;
+    fy[i] = aos[i].y / 256000.0f;
+  }
+}
+
+// The baseline: the AoS window loop
+static void referenceLoop(BenchStats& s) {
+  s.min[0] = s.max[0] = aos[0].x;
+  s.min[1] = s.max[1] = aos[0].y;
+  s.min[2] = s.max[2] = aos[0].z;
+  long long sum_x = 0, sum_y = 0, sum_z = 0;
+  long long sum_sq_x = 0, sum_sq_y = 0, sum_sq_z = 0;
+  for (uint16_t i = 0; i < BENCH_SAMPLES; i++) {
+    int32_t x = aos[i].x;
+    int32_t y = aos[i].y;
+    int32_t z = aos[i].z;
+    sum_x += x;
+    sum_y += y;
+    sum_z += z;
+    sum_sq_x += (long long)x * x;
+    sum_sq_y += (long long)y * y;
+    sum_sq_z += (long long)z * z;
+    if (x < s.min[0]) s.min[0] = x;
+    if (x > s.max[0]) s.max[0] = x;
+    if (y < s.min[1]) s.min[1] = y;
+    if (y > s.max[1]) s.max[1] = y;
+    if (z < s.min[2]) s.min[2] = z;
+    if (z > s.max[2]) s.max[2] = z;
+  }
+  s.sum[0] = sum_x; s.sum[1] = sum_y; s.sum[2] = sum_z;
+  s.sum_sq[0] = sum_sq_x; s.sum_sq[1] = sum_sq_y; s.sum_sq[2] = sum_sq_z;
+}
+
+static void kernelScan(BenchStats& s) {
+  for (uint8_t a = 0; a < 3; a++) {
+    KernelAxisStats k;
+    statsScanI32(soa[a], BENCH_SAMPLES, &k);
+    s.min[a] = k.min;
+    s.max[a] = k.max;
+    s.sum[a] = k.sum;
+    s.sum_sq[a] = k.sum_sq;
+  }
+}
+
+static void separateKernels(BenchStats& s) {
+  for (uint8_t a = 0; a < 3; a++) {
+    statsMinMaxI32(soa[a], BENCH_SAMPLES, &s.min[a], &s.max[a]);
+    s.sum[a] = statsSumI32(soa[a], BENCH_SAMPLES);
+    s.sum_sq[a] = statsSumSqI32(soa[a], BENCH_SAMPLES);
+  }
+}
+
+static bool sameStats(const BenchStats& a, const BenchStats& b) {
+  for (uint8_t i = 0; i < 3; i++) {
+    if (a.min[i] != b.min[i] || a.max[i] != b.max[i] || a.sum[i] != b.sum[i] || a.sum_sq[i] != b.sum_sq[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Plain loops the single kernels are checked against
+static long long loopDotI32(const int32_t* a, const int32_t* b, uint32_t n) {
+  long long dot = 0;
+  for (uint32_t i = 0; i < n; i++) dot += (long long)a[i] * b[i];
+  return dot;
+}
+
+static float loopSumF32(const float* v, uint32_t n) {
+  float sum = 0;
+  for (uint32_t i = 0; i < n; i++) sum += v[i];
+  return sum;
+}
+
+static float loopDotF32(const float* a, const float* b, uint32_t n) {
+  float dot = 0;
+  for (uint32_t i = 0; i < n; i++) dot += a[i] * b[i];
+  return dot;
+}
+
+// Relative to the magnitude of the terms, so a sum near zero is not held to
+// an impossible tolerance
+static bool closeF32(float got, float ref, float scale) {
+  return fabsf(got - ref) <= BENCH_FLOAT_TOL * (scale > 1e-30f ? scale : 1e-30f);
+}
+
+static bool checkFail(const char* kernel, uint32_t n) {
+  BENCH_PRINTF("FAIL: %s n=%lu\n", kernel, (unsigned long)n);
+  return false;
+}
+
+// Short lengths cover the remainder loops, the long ones the vector body
+static bool checkKernels() {
+  static const uint32_t lengths[] = { 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 255, BENCH_SAMPLES - 1, BENCH_SAMPLES };
+  bool ok = true;
+
+  if (statsSumI32(soa[0], 0) != 0 || statsSumF32(fx, 0) != 0.0f || statsDotF32(fx, fy, 0) != 0.0f) {
+    ok = checkFail("empty input", 0);
+  }
+
+  for (uint32_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+    const uint32_t n = lengths[l];
+    const int32_t* v = soa[0];
+
+    long long sum = 0, sum_sq = 0;
+    int32_t mn = v[0], mx = v[0];
+    float fabs_sum = 0, fmn = fx[0], fmx = fx[0];
+    for (uint32_t i = 0; i < n; i++) {
+      sum += v[i];
+      sum_sq += (long long)v[i] * v[i];
+      if (v[i] < mn) mn = v[i];
+      if (v[i] > mx) mx = v[i];
+      fabs_sum += fabsf(fx[i]);
+      if (fx[i] < fmn) fmn = fx[i];
+      if (fx[i] > fmx) fmx = fx[i];
+    }
+
+    if (statsSumI32(v, n) != sum) ok = checkFail("statsSumI32", n);
+    if (statsSumSqI32(v, n) != sum_sq) ok = checkFail("statsSumSqI32", n);
+    if (statsDotI32(v, soa[1], n) != loopDotI32(v, soa[1], n)) ok = checkFail("statsDotI32", n);
+
+    int32_t kmn, kmx;
+    statsMinMaxI32(v, n, &kmn, &kmx);
+    if (kmn != mn || kmx != mx) ok = checkFail("statsMinMaxI32", n);
+
+    KernelAxisStats k;
+    statsScanI32(v, n, &k);
+    if (k.sum != sum || k.sum_sq != sum_sq || k.min != mn || k.max != mx) ok = checkFail("statsScanI32", n);
+
+    if (!closeF32(statsSumF32(fx, n), loopSumF32(fx, n), fabs_sum)) ok = checkFail("statsSumF32", n);
+    const float fsq = loopDotF32(fx, fx, n);
+    if (!closeF32(statsSumSqF32(fx, n), fsq, fsq)) ok = checkFail("statsSumSqF32", n);
+    if (!closeF32(statsDotF32(fx, fy, n), loopDotF32(fx, fy, n), sqrtf(fsq * loopDotF32(fy, fy, n)))) {
+      ok = checkFail("statsDotF32", n);
+    }
+
+    float kfmn, kfmx;
+    statsMinMaxF32(fx, n, &kfmn, &kfmx);
+    if (kfmn != fmn || kfmx != fmx) ok = checkFail("statsMinMaxF32", n);
+  }
+
+  BenchStats ref, fused, separate;
+  referenceLoop(ref);
+  kernelScan(fused);
+  separateKernels(separate);
+  if (!sameStats(ref, fused)) ok = checkFail("statsScanI32 x3 vs baseline", BENCH_SAMPLES);
+  if (!sameStats(ref, separate)) ok = checkFail("separate kernels x3 vs baseline", BENCH_SAMPLES);
+  return ok;
+}
+
+template <typename F>
+static float timeWindow(F fn) {
+  unsigned long start = benchNowUs();
+  for (uint32_t it = 0; it < BENCH_ITERATIONS; it++) {
+    fn();
+  }
+  return (float)(benchNowUs() - start) / BENCH_ITERATIONS;
+}
+
+static bool runBenchmark() {
+  fillWindow();
+
+  BENCH_PRINTF("Stats kernels (%s), %d samples x 3 axes, %d iterations\n",
+               statsKernelBackend(), BENCH_SAMPLES, BENCH_ITERATIONS);
+  bool ok = checkKernels();
+  BENCH_PRINTF("Results match reference: %s\n", ok ? "PASS" : "FAIL");
+
+  BenchStats s;
+  float t_ref = timeWindow([&]() { referenceLoop(s); sink += s.sum_sq[0]; });
+  float t_fused = timeWindow([&]() { kernelScan(s); sink += s.sum_sq[0]; });
+  float t_separate = timeWindow([&]() { separateKernels(s); sink += s.sum_sq[0]; });
+  float t_float_ref = timeWindow([&]() { sink += (long long)loopDotF32(fx, fx, BENCH_SAMPLES); });
+  float t_float = timeWindow([&]() { sink += (long long)statsSumSqF32(fx, BENCH_SAMPLES); });
+
+  BENCH_PRINTF("AoS window loop (baseline): %8.2f us/window\n", t_ref);
+  BENCH_PRINTF("statsScanI32 x3:            %8.2f us/window (%.1fx)\n", t_fused, t_ref / t_fused);
+  BENCH_PRINTF("min/max+sum+sum_sq x3:      %8.2f us/window (%.1fx)\n", t_separate, t_ref / t_separate);
+  BENCH_PRINTF("float sum_sq loop:          %8.2f us\n", t_float_ref);
+  BENCH_PRINTF("statsSumSqF32:              %8.2f us (%.1fx)\n", t_float, t_float_ref / t_float);
+  return ok;
+}
+
+#ifdef ARDUINO
+void setup() {
+  Serial.begin(115200);
+  delay(2000);
+  runBenchmark();
+}
+
+void loop() {
+  delay(1000);
+}
+#else
+int main() {
+  return runBenchmark() ? 0 : 1;
+}
+#endif
@@ -0,0 +1,35 @@
+// Just enough of the Arduino core to build the DSP and statistics modules
+// into a host program; see the host tests for the build lines
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include "freertos/FreeRTOS.h"
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define DMA_ATTR
+#define EXT_RAM_ATTR
+
+// The modules' debug output is dropped; the tests print with printf
+struct HostSerial {
+  template <typename... Args> void print(Args...) {}
+  template <typename... Args> void println(Args...) {}
+  template <typename... Args> int printf(Args...) { return 0; }
+};
+static HostSerial Serial __attribute__((unused));
+
+static inline unsigned long micros() {
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+static inline unsigned long millis() { return micros() / 1000; }
+
+#endif // HOST_ARDUINO_H
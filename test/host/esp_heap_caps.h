@@ -0,0 +1,21 @@
+// Host stand-in for the ESP-IDF capability allocator: everything is plain
+// heap, and there is no PSRAM
+
+#ifndef HOST_ESP_HEAP_CAPS_H
+#define HOST_ESP_HEAP_CAPS_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_8BIT      (1 << 2)
+#define MALLOC_CAP_DMA       (1 << 3)
+#define MALLOC_CAP_SPIRAM    (1 << 10)
+#define MALLOC_CAP_INTERNAL  (1 << 11)
+
+static inline void* heap_caps_malloc(size_t size, uint32_t caps) {
+  return (caps & MALLOC_CAP_SPIRAM) ? NULL : malloc(size);
+}
+static inline void heap_caps_free(void* ptr) { free(ptr); }
+static inline size_t heap_caps_get_largest_free_block(uint32_t) { return 1 << 20; }
+
+#endif // HOST_ESP_HEAP_CAPS_H
@@ -0,0 +1,11 @@
+// Single-threaded host stand-in for the spinlocks the modules take
+
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED { 0 }
+#define portENTER_CRITICAL(mux) (void)(mux)
+#define portEXIT_CRITICAL(mux) (void)(mux)
+
+#endif // HOST_FREERTOS_H
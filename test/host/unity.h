@@ -0,0 +1,70 @@
+// Host stand-in for the part of Unity the test suites use, so a suite built
+// for `pio test` also builds into a plain host program. A failed assertion
+// ends the current test, as in Unity, and UNITY_END() returns the number of
+// failed tests.
+
+#ifndef HOST_UNITY_H
+#define HOST_UNITY_H
+
+#include <stdio.h>
+#include <setjmp.h>
+
+struct HostUnity {
+  const char* file;
+  const char* test;
+  unsigned tests;
+  unsigned failures;
+  bool failed;
+  jmp_buf abort_test;
+};
+
+inline HostUnity& hostUnity() {
+  static HostUnity state;
+  return state;
+}
+
+inline void hostUnityBegin(const char* file) {
+  HostUnity& u = hostUnity();
+  u.file = file;
+  u.tests = 0;
+  u.failures = 0;
+}
+
+inline void hostUnityFail(int line, const char* message) {
+  HostUnity& u = hostUnity();
+  printf("%s:%d:%s:FAIL: %s\n", u.file, line, u.test, message ? message : "");
+  u.failed = true;
+  longjmp(u.abort_test, 1);
+}
+
+inline void hostUnityRun(void (*fn)(), const char* name, int line) {
+  HostUnity& u = hostUnity();
+  u.test = name;
+  u.failed = false;
+  u.tests++;
+  if (setjmp(u.abort_test) == 0) {
+    fn();
+  }
+  if (u.failed) {
+    u.failures++;
+  } else {
+    printf("%s:%d:%s:PASS\n", u.file, line, name);
+  }
+}
+
+inline int hostUnityEnd() {
+  HostUnity& u = hostUnity();
+  printf("-----------------------\n%u Tests %u Failures 0 Ignored\n%s\n", u.tests, u.failures,
+         u.failures ? "FAIL" : "OK");
+  return (int)u.failures;
+}
+
+#define UNITY_BEGIN() hostUnityBegin(__FILE__)
+#define UNITY_END() hostUnityEnd()
+#define RUN_TEST(fn) hostUnityRun(fn, #fn, __LINE__)
+
+#define TEST_FAIL_MESSAGE(message) hostUnityFail(__LINE__, (message))
+#define TEST_ASSERT_TRUE_MESSAGE(condition, message) \
+  do { if (!(condition)) hostUnityFail(__LINE__, (message)); } while (0)
+
+#endif // HOST_UNITY_H
@@ -1,5 +1,5 @@
 // Test program to verify accelerometer abstraction works
-// Compile with either USE_ADXL355 or USE_MPU6050 defined
+// The sensor is detected at boot; define USE_ADXL355 or USE_MPU6050 to force one
 
 #include <Arduino.h>
 #include "accelerometer_interface.h"
@@ -0,0 +1,92 @@
+// Biquad coefficient table and design formulas
+//
+// Every (rate, type, corner) the flash table answers for must come out of
+// designCoeffs() bit for bit. The designed sections must also have the
+// response they are named for: -3 dB at a Butterworth corner, 0 dB at the
+// band-pass center, unity at Nyquist for the DC blocker. Finally the
+// fixed-point cascade must take 1 g of gravity out completely through a
+// 2 Hz high-pass, which is what the error feedback is for.
+
+#include "test_signal_processing.h"
+#include "filter_chain.h"
+
+#define TEST_GAIN_TOL_DB  0.01  // Coefficient rounding is far below this
+
+// |H(e^jw)| in dB of a Q3.28 section
+static double gainDb(const BiquadCoeffs& c, double w) {
+  const double one = (double)(1L << FILTER_COEFF_FRAC_BITS);
+  const double b0 = c.b0 / one, b1 = c.b1 / one, b2 = c.b2 / one, a1 = c.a1 / one, a2 = c.a2 / one;
+  const double nr = b0 + b1 * cos(w) + b2 * cos(2 * w), ni = -b1 * sin(w) - b2 * sin(2 * w);
+  const double dr = 1.0 + a1 * cos(w) + a2 * cos(2 * w), di = -a1 * sin(w) - a2 * sin(2 * w);
+  return 10.0 * log10((nr * nr + ni * ni) / (dr * dr + di * di));
+}
+
+static void testTable() {
+  static const uint16_t rates[] = { 4000, 2000, 1000, 500, 250, 125 };
+  uint32_t entries = 0;
+  for (uint8_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+    for (uint8_t type = FILTER_DC_BLOCK; type <= FILTER_BANDPASS; type++) {
+      for (uint16_t corner = 0; corner <= rates[r] / 2; corner++) {
+        BiquadCoeffs table, designed;
+        if (!SampleFilter::lookupCoeffs(type, rates[r], corner, table)) {
+          continue;
+        }
+        entries++;
+        TEST_ASSERT_TRUE_MESSAGE(SampleFilter::designCoeffs(type, rates[r], corner, designed) &&
+                                 memcmp(&table, &designed, sizeof(table)) == 0,
+                                 testMessage("table entry %u Hz, type %u, %u Hz differs from the design",
+                                             rates[r], type, corner));
+        if (type == FILTER_DC_BLOCK) {
+          break;  // Every corner maps to the one DC-blocker entry
+        }
+      }
+    }
+  }
+  TEST_ASSERT_TRUE_MESSAGE(entries > 0, "no table entries found");
+}
+
+static void checkResponse(uint8_t type, uint16_t rate, uint16_t corner, double w, double expected_db) {
+  BiquadCoeffs c;
+  TEST_ASSERT_TRUE_MESSAGE(SampleFilter::designCoeffs(type, rate, corner, c),
+                           testMessage("type %u, %u Hz @ %u Hz not designed", type, corner, rate));
+  const double db = gainDb(c, w);
+  TEST_ASSERT_TRUE_MESSAGE(fabs(db - expected_db) <= TEST_GAIN_TOL_DB,
+                           testMessage("type %u, %u Hz @ %u Hz: %.4f dB, expected %.4f dB",
+                                       type, corner, rate, db, expected_db));
+}
+
+static void testResponses() {
+  static const uint16_t rates[] = { 4000, 1000, 250 };
+  static const uint16_t corners[] = { 2, 10, 50, 100 };
+  const double half_power_db = 10.0 * log10(0.5);
+  for (uint8_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+    for (uint8_t k = 0; k < sizeof(corners) / sizeof(corners[0]); k++) {
+      const double w = 2.0 * M_PI * corners[k] / rates[r];
+      checkResponse(FILTER_HIGHPASS, rates[r], corners[k], w, half_power_db);
+      checkResponse(FILTER_LOWPASS, rates[r], corners[k], w, half_power_db);
+      checkResponse(FILTER_BANDPASS, rates[r], corners[k], w, 0.0);
+    }
+    checkResponse(FILTER_DC_BLOCK, rates[r], 0, M_PI, 0.0);
+  }
+}
+
+static void testGravityRemoval() {
+  AxisFilter filter;
+  memset(&filter, 0, sizeof(filter));
+  SampleFilter::designCoeffs(FILTER_HIGHPASS, 1000, 2, filter.coeffs[0]);
+  filter.sections = 1;
+  filter.clearState();
+
+  int32_t y = 0;
+  for (uint32_t i = 0; i < 20000; i++) {
+    y = filter.process(256000);
+  }
+  TEST_ASSERT_TRUE_MESSAGE(y == 0, testMessage("2 Hz high-pass leaves %ld counts of a 256000-count step after 20 s",
+                                               (long)y));
+}
+
+void runFilterCoeffsTests() {
+  RUN_TEST(testTable);
+  RUN_TEST(testResponses);
+  RUN_TEST(testGravityRemoval);
+}
@@ -0,0 +1,154 @@
+// Fixed-point window statistics: correctness and reproducibility
+//
+// A window with negative origin, minimum and mean, and one with 1 g of
+// gravity, go through both the tumbling DataBuffer and the SlidingWindow.
+// The two must agree field for field, every field must be within one LSB
+// of a double-precision reference, and the results must equal the golden
+// values below, recorded on a host. The same golden values on the ESP32
+// confirm the board and a host compute the same bits.
+
+#include "test_signal_processing.h"
+#include "data_buffer.h"
+#include "sliding_window.h"
+
+#define TEST_SAMPLES  1000
+
+struct GoldenAxis {
+  int32_t avg, min, max, rms, std, crest, skew, kurt;
+};
+
+// Recorded from this test on a host, axis order x, y, z
+static const GoldenAxis golden[2][3] = {
+  {
+    { -76806900, -82173184, -71433216, 76864938, 2986442, 117923, 49, 120986 },
+    { -1280, -2323712, 2284288, 1337164, 1337164, 113825, -863, 117456 },
+    { -134209512, -134217472, -134201344, 134209512, 4639, 115391, 3568, 121099 },
+  },
+  {
+    { -4113, -1541888, 1521152, 756490, 756479, 133222, -639, 126337 },
+    { 448462, -786432, 23763456, 3305121, 3274554, 466620, 436668, 3036777 },
+    { 65538054, 64769024, 66299392, 65539174, 383244, 131507, 679, 126692 },
+  },
+};
+static const int32_t golden_vector_rms[2] = { 3272134, 3382579 };
+
+static void check(bool ok, const char* what, int window, int axis, long got, long expected) {
+  TEST_ASSERT_TRUE_MESSAGE(ok, testMessage("window %d axis %d %s: %ld, expected %ld", window, axis, what, got, expected));
+}
+
+// Period-p triangle wave of the given amplitude, integer only
+static int32_t triangle(uint32_t i, uint32_t p, int32_t amplitude) {
+  int32_t phase = (int32_t)(i % p);
+  int32_t half = (int32_t)p / 2;
+  int32_t ramp = phase < half ? phase : (int32_t)p - phase;
+  return (int32_t)(((int64_t)4 * amplitude * ramp) / (int32_t)p) - amplitude;
+}
+
+// Deterministic 20-bit test signal: a tone, a slow swing and LCG noise, in
+// integers only so the inputs are the same on every target
+static void fillWindow(int window, int32_t* x, int32_t* y, int32_t* z) {
+  uint32_t seed = 2024 + window;
+  for (uint32_t i = 0; i < TEST_SAMPLES; i++) {
+    seed = seed * 1103515245u + 12345u;
+    int32_t noise = (int32_t)((seed >> 16) & 0x7FF) - 1024;
+    int32_t tone = triangle(i, 20, 20000);
+    if (window == 0) {
+      x[i] = -300000 + tone + noise;
+      y[i] = -triangle(i, 90, 9000) - 77;
+      z[i] = -524287 + (noise & 0x3F);  // Pinned near the negative limit
+    } else {
+      x[i] = tone / 4 + noise;
+      y[i] = noise * 3 + (i % 50 == 0 ? 90000 : 0);  // Impulsive: high crest and kurtosis
+      z[i] = 256000 + tone / 8 - noise / 2;
+    }
+  }
+}
+
+static void checkReference(int window, int axis, const int32_t* v, const BufferStats& s) {
+  const int32_t* avg[3] = { &s.avg_x, &s.avg_y, &s.avg_z };
+  const int32_t* mn[3] = { &s.min_x, &s.min_y, &s.min_z };
+  const int32_t* mx[3] = { &s.max_x, &s.max_y, &s.max_z };
+  const int32_t* rms[3] = { &s.rms_x, &s.rms_y, &s.rms_z };
+  const int32_t* sd[3] = { &s.std_x, &s.std_y, &s.std_z };
+
+  double sum = 0, sum_sq = 0;
+  int32_t lo = v[0], hi = v[0];
+  for (uint32_t i = 0; i < TEST_SAMPLES; i++) {
+    sum += v[i];
+    sum_sq += (double)(v[i] - v[0]) * (v[i] - v[0]);
+    if (v[i] < lo) lo = v[i];
+    if (v[i] > hi) hi = v[i];
+  }
+  const double q = 1 << STATS_FRAC_BITS;
+  const double mean = sum / TEST_SAMPLES;
+  const double d = mean - v[0];
+  const double var = sum_sq / TEST_SAMPLES - d * d;
+  const long ref_avg = lround(mean * q);
+  const long ref_std = lround(sqrt(var) * q);
+  const long ref_rms = lround(sqrt(var + mean * mean) * q);
+
+  check(*mn[axis] == lo * 256L, "min", window, axis, *mn[axis], lo * 256L);
+  check(*mx[axis] == hi * 256L, "max", window, axis, *mx[axis], hi * 256L);
+  check(labs(*avg[axis] - ref_avg) <= 1, "avg vs reference", window, axis, *avg[axis], ref_avg);
+  check(labs(*sd[axis] - ref_std) <= 1, "std vs reference", window, axis, *sd[axis], ref_std);
+  check(labs(*rms[axis] - ref_rms) <= 1, "rms vs reference", window, axis, *rms[axis], ref_rms);
+}
+
+static void checkWindow(int window) {
+  static ChannelBuffer buffer;
+  static int32_t x[TEST_SAMPLES], y[TEST_SAMPLES], z[TEST_SAMPLES];
+  SlidingWindow sliding;
+  sliding.begin();
+
+  fillWindow(window, x, y, z);
+  buffer.configure(TEST_SAMPLES, 1000, 256000);
+  sliding.configure(TEST_SAMPLES, TEST_SAMPLES / 4, 1000, 256000);
+  for (uint32_t i = 0; i < TEST_SAMPLES; i++) {
+    buffer.addSample(x[i], y[i], z[i], i * 1000UL);
+    sliding.addSample(x[i], y[i], z[i], i * 1000UL);
+  }
+  BufferStats tumbling, slid;
+  buffer.calculateStats(tumbling);
+  sliding.calculateStats(slid);
+
+  const int32_t* axes[3] = { x, y, z };
+  const BufferStats& s = tumbling;
+  const GoldenAxis got[3] = {
+    { s.avg_x, s.min_x, s.max_x, s.rms_x, s.std_x, s.crest_x, s.skew_x, s.kurt_x },
+    { s.avg_y, s.min_y, s.max_y, s.rms_y, s.std_y, s.crest_y, s.skew_y, s.kurt_y },
+    { s.avg_z, s.min_z, s.max_z, s.rms_z, s.std_z, s.crest_z, s.skew_z, s.kurt_z },
+  };
+  for (int a = 0; a < 3; a++) {
+    checkReference(window, a, axes[a], tumbling);
+    const GoldenAxis& g = golden[window][a];
+    if (memcmp(&got[a], &g, sizeof(g)) != 0) {
+      TEST_FAIL_MESSAGE(testMessage("window %d axis %d differs from golden, got { %ld, %ld, %ld, %ld, %ld, %ld, %ld, %ld }",
+                                    window, a, (long)got[a].avg, (long)got[a].min, (long)got[a].max, (long)got[a].rms,
+                                    (long)got[a].std, (long)got[a].crest, (long)got[a].skew, (long)got[a].kurt));
+    }
+  }
+  check(s.vector_rms == golden_vector_rms[window], "vector rms golden", window, 0, s.vector_rms,
+        golden_vector_rms[window]);
+
+  // Same window through the sliding path: identical bits
+  const int32_t* a = &tumbling.avg_x;
+  const int32_t* b = &slid.avg_x;
+  for (int f = 0; &a[f] <= &tumbling.vector_rms; f++) {
+    check(a[f] == b[f], "sliding vs tumbling, field", window, f, b[f], a[f]);
+  }
+}
+
+// Negative origin, minimum and mean; z pinned near the negative limit
+static void testNegativeWindow() {
+  checkWindow(0);
+}
+
+// 1 g on z, impulsive y
+static void testGravityWindow() {
+  checkWindow(1);
+}
+
+void runFixedPointStatsTests() {
+  RUN_TEST(testNegativeWindow);
+  RUN_TEST(testGravityWindow);
+}
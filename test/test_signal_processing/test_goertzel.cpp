@@ -0,0 +1,110 @@
+// Goertzel tone bank against a direct DFT
+//
+// Tones on and off the bin grid, near DC, near Nyquist and in 65535-sample
+// blocks are tracked with gravity and a slow wobble on the other axis. The
+// amplitude and phase must match a double-precision DFT of the mean-removed
+// block at the target frequency. A tone half a bin off its target must read
+// 2/pi (-3.9 dB) of its amplitude, as the register map documents, and a
+// second read of the same block must return the cached result unchanged.
+
+#include "test_signal_processing.h"
+#include "goertzel.h"
+
+#define TEST_COUNTS_PER_G  256000
+#define TEST_AMP_TOL       2e-5   // g
+#define TEST_PHASE_TOL     0.05   // deg
+#define TEST_LEAK_TOL      1e-3   // g; sidelobes of the 0.01 g wobble on Z, gravity must not add to it
+
+// Feeds one block of a cosine tone on X (plus an offset) and 1 g with a
+// 3.3 Hz wobble on Z; returns the DFT of the mean-removed X block at
+// target_hz as amplitude (g) and phase (deg)
+static void runBlock(uint16_t fs, uint16_t n, double tone_hz, double amp_g, double phase_deg,
+                     double target_hz, double& ref_amp, double& ref_phase) {
+  double sum = 0;
+  for (uint16_t i = 0; i < n; i++) {
+    const double t = (double)i / fs;
+    sum += lround(TEST_COUNTS_PER_G * (amp_g * cos(2 * M_PI * tone_hz * t + phase_deg * M_PI / 180) + 0.3));
+  }
+  const double mean = sum / n;
+  const double w = 2 * M_PI * target_hz / fs;
+  double re = 0, im = 0;
+  for (uint16_t i = 0; i < n; i++) {
+    const double t = (double)i / fs;
+    const int32_t x = lround(TEST_COUNTS_PER_G * (amp_g * cos(2 * M_PI * tone_hz * t + phase_deg * M_PI / 180) + 0.3));
+    const int32_t z = lround(TEST_COUNTS_PER_G * (1.0 + 0.01 * sin(2 * M_PI * 3.3 * t)));
+    toneBank.process(0, x, 0, z);
+    re += (x - mean) * cos(w * i);
+    im -= (x - mean) * sin(w * i);
+  }
+  ref_amp = 2 * sqrt(re * re + im * im) / n / TEST_COUNTS_PER_G;
+  ref_phase = atan2(im, re) * 180 / M_PI;
+}
+
+static void configureTone(uint16_t fs, uint16_t n, uint16_t target_dhz) {
+  const uint16_t tones[GOERTZEL_NUM_TONES] = { 0, target_dhz, 0, 0 };  // Slot 1, to check the slot mapping
+  toneBank.setFrequencies(tones);
+  toneBank.configure(fs, TEST_COUNTS_PER_G, n);
+}
+
+static void checkTone(uint16_t fs, uint16_t n, double tone_hz, double amp_g, double phase_deg, uint16_t target_dhz) {
+  configureTone(fs, n, target_dhz);
+  double ref_amp, ref_phase;
+  runBlock(fs, n, tone_hz, amp_g, phase_deg, target_dhz / 10.0, ref_amp, ref_phase);
+
+  ToneResult r;
+  TEST_ASSERT_TRUE_MESSAGE(toneBank.getResult(0, r) && r.block_samples == n && r.frequency_dhz[1] == target_dhz,
+                           testMessage("%.1f Hz @ %u Hz, %u samples: no result", tone_hz, fs, n));
+  double dphase = fabs(r.phase_deg[1][0] - ref_phase);
+  if (dphase > 180) dphase = 360 - dphase;
+  TEST_ASSERT_TRUE_MESSAGE(fabs(r.amplitude_g[1][0] - ref_amp) <= TEST_AMP_TOL && dphase <= TEST_PHASE_TOL,
+                           testMessage("%.1f Hz @ %u Hz, %u samples: %.6f g %.3f deg, DFT %.6f g %.3f deg",
+                                       tone_hz, fs, n, r.amplitude_g[1][0], r.phase_deg[1][0], ref_amp, ref_phase));
+  TEST_ASSERT_TRUE_MESSAGE(r.amplitude_g[1][2] <= TEST_LEAK_TOL,
+                           testMessage("%.1f Hz @ %u Hz: gravity leaks %.6f g into Z", tone_hz, fs, r.amplitude_g[1][2]));
+}
+
+static void testScalloping() {
+  // 1 Hz bins; the tone sits half a bin above the 25 Hz target
+  configureTone(1000, 1000, 250);
+  double ref_amp, ref_phase;
+  runBlock(1000, 1000, 25.5, 0.1, 0, 25.0, ref_amp, ref_phase);
+  ToneResult r;
+  toneBank.getResult(0, r);
+  const double ratio = r.amplitude_g[1][0] / 0.1;
+  TEST_ASSERT_TRUE_MESSAGE(fabs(ratio - 2 / M_PI) <= 0.01,
+                           testMessage("half-bin tone reads %.4f of its amplitude, expected %.4f", ratio, 2 / M_PI));
+}
+
+static void testCache() {
+  configureTone(1000, 1000, 250);
+  double ref_amp, ref_phase;
+  runBlock(1000, 1000, 25, 0.1, 30, 25.0, ref_amp, ref_phase);
+  ToneResult first, again, next;
+  toneBank.getResult(0, first);
+  toneBank.getResult(0, again);
+  TEST_ASSERT_TRUE_MESSAGE(memcmp(&first, &again, sizeof(first)) == 0, "second read of a block differs from the first");
+  runBlock(1000, 1000, 25, 0.05, 30, 25.0, ref_amp, ref_phase);
+  toneBank.getResult(0, next);
+  TEST_ASSERT_TRUE_MESSAGE(next.sequence == first.sequence + 1 && fabs(next.amplitude_g[1][0] - 0.05) <= TEST_AMP_TOL,
+                           testMessage("next block not picked up: sequence %lu, %.6f g", (unsigned long)next.sequence,
+                                       next.amplitude_g[1][0]));
+}
+
+static void testTonesOnGrid() {
+  checkTone(1000, 1000, 25.0, 0.1, 30, 250);       // On a bin
+  checkTone(1000, 1000, 50.0, 0.02, -60, 500);
+  checkTone(1000, 1000, 25.3, 0.1, 30, 253);       // Between bins, tracked exactly
+  checkTone(250, 2500, 0.5, 0.2, 10, 5);
+}
+
+static void testTonesAtBandEdges() {
+  checkTone(4000, 65535, 1.5, 0.05, 100, 15);      // Near DC, longest block
+  checkTone(4000, 65535, 1800.0, 0.05, -170, 18000);  // Near Nyquist
+}
+
+void runGoertzelTests() {
+  RUN_TEST(testTonesOnGrid);
+  RUN_TEST(testTonesAtBandEdges);
+  RUN_TEST(testScalloping);
+  RUN_TEST(testCache);
+}
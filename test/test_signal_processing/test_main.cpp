@@ -0,0 +1,54 @@
+// Signal processing and statistics tests
+//
+// One Unity suite for the modules that turn samples into results: window
+// statistics, filters, velocity, FFT spectrum and the Goertzel tone bank.
+// Each test_*.cpp here covers one of them and says what it checks.
+//
+// On the ESP32: pio test -f test_signal_processing
+// On a host, with test/host standing in for the Arduino core and Unity:
+//   g++ -O2 -std=gnu++11 -ffp-contract=off -Iinclude -Itest/host -o signal_tests
+//       test/test_signal_processing/*.cpp src/data_buffer.cpp src/sliding_window.cpp
+//       src/filter_chain.cpp src/velocity.cpp src/spectrum.cpp src/packed_history.cpp
+//       src/stats_kernels.cpp src/goertzel.cpp
+//   ./signal_tests
+
+#include "test_signal_processing.h"
+#include <stdarg.h>
+
+const char* testMessage(const char* format, ...) {
+  static char message[192];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(message, sizeof(message), format, args);
+  va_end(args);
+  return message;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static int runAll() {
+  UNITY_BEGIN();
+  runFixedPointStatsTests();
+  runShapeStatsTests();
+  runFilterCoeffsTests();
+  runVelocityTests();
+  runSpectrumFftTests();
+  runGoertzelTests();
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+  delay(2000);  // Let the monitor attach
+  runAll();
+}
+
+void loop() {
+  delay(1000);
+}
+#else
+int main() {
+  return runAll() ? 1 : 0;
+}
+#endif
@@ -0,0 +1,88 @@
+// Skewness and kurtosis on distributions with known moments
+//
+// Each window is built so its sample moments are known in closed form:
+//   - a shuffled discrete uniform over 1000 levels spanning most of the
+//     20-bit range: skewness 0, kurtosis 3 - 6 (n^2 + 1) / (5 (n^2 - 1))
+//   - a two-point distribution, 10% at one level: skewness 0.8 / 0.3,
+//     kurtosis (1 - 3pq) / pq
+//   - a sine over whole periods on 1 g of gravity: skewness 0, kurtosis 1.5
+// Both the tumbling DataBuffer and the SlidingWindow must get them within
+// two Q.16 LSB. The sliding window first sees unrelated samples, so its
+// result also depends on removing them again exactly.
+
+#include "test_signal_processing.h"
+#include "data_buffer.h"
+#include "sliding_window.h"
+
+#define TEST_SAMPLES    1000
+#define TEST_TOL_LSB    2
+
+static int32_t x[TEST_SAMPLES], y[TEST_SAMPLES], z[TEST_SAMPLES];
+
+static void buildWindows() {
+  for (int32_t i = 0; i < TEST_SAMPLES; i++) {
+    // 7 is coprime with 1000, so (7 i) mod 1000 visits every level once
+    x[i] = ((7 * i) % TEST_SAMPLES) * 1000 - 499500;
+    y[i] = (i % 10 == 3) ? 400000 : -20000;
+    z[i] = 256000 + (int32_t)lround(150000.0 * sin(2 * M_PI * i / 50.0));
+  }
+}
+
+static void expectShape(const char* path, const char* what, int32_t got, double expected) {
+  const double lsb = 1 << SHAPE_FRAC_BITS;
+  TEST_ASSERT_TRUE_MESSAGE(fabs(got - expected * lsb) <= TEST_TOL_LSB,
+                           testMessage("%s %s: %.6f, expected %.6f", path, what, got / lsb, expected));
+}
+
+static void checkStats(const char* path, const BufferStats& s) {
+  const double n2 = (double)TEST_SAMPLES * TEST_SAMPLES;
+  const double pq = 0.1 * 0.9;
+  expectShape(path, "uniform skewness", s.skew_x, 0.0);
+  expectShape(path, "uniform kurtosis", s.kurt_x, 3.0 - 6.0 * (n2 + 1) / (5.0 * (n2 - 1)));
+  expectShape(path, "two-point skewness", s.skew_y, 0.8 / sqrt(pq));
+  expectShape(path, "two-point kurtosis", s.kurt_y, (1.0 - 3.0 * pq) / pq);
+  expectShape(path, "sine skewness", s.skew_z, 0.0);
+  expectShape(path, "sine kurtosis", s.kurt_z, 1.5);
+}
+
+static void testTumbling() {
+  buildWindows();
+
+  static ChannelBuffer buffer;
+  buffer.configure(TEST_SAMPLES, 1000, 256000);
+  for (uint32_t i = 0; i < TEST_SAMPLES; i++) {
+    buffer.addSample(x[i], y[i], z[i], i * 1000UL);
+  }
+  BufferStats tumbling;
+  buffer.calculateStats(tumbling);
+  checkStats("tumbling", tumbling);
+}
+
+static void testSliding() {
+  buildWindows();
+
+  // Three windows of something else first, then the test window
+  SlidingWindow sliding;
+  sliding.begin();
+  sliding.configure(TEST_SAMPLES, TEST_SAMPLES / 10, 1000, 256000);
+  uint32_t seed = 7;
+  for (uint32_t i = 0; i < 3 * TEST_SAMPLES; i++) {
+    seed = seed * 1103515245u + 12345u;
+    int32_t v = (int32_t)((seed >> 8) & 0xFFFFF) - 524288;
+    sliding.addSample(v, -v / 3, v / 2 + 1000, i * 1000UL);
+  }
+  BufferStats slid;
+  memset(&slid, 0, sizeof(slid));
+  for (uint32_t i = 0; i < TEST_SAMPLES; i++) {
+    if (sliding.addSample(x[i], y[i], z[i], (3 * TEST_SAMPLES + i) * 1000UL) && i == TEST_SAMPLES - 1) {
+      sliding.calculateStats(slid);
+    }
+  }
+  TEST_ASSERT_TRUE_MESSAGE(slid.sample_count == TEST_SAMPLES, "sliding window did not complete on the last test sample");
+  checkStats("sliding", slid);
+}
+
+void runShapeStatsTests() {
+  RUN_TEST(testTumbling);
+  RUN_TEST(testSliding);
+}
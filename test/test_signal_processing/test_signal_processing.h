@@ -0,0 +1,19 @@
+#ifndef TEST_SIGNAL_PROCESSING_H
+#define TEST_SIGNAL_PROCESSING_H
+
+#include <Arduino.h>
+#include <unity.h>
+
+// Failure text with the values that failed. Unity only evaluates the message
+// of a failing assertion, and stops that test on it, so one buffer will do.
+const char* testMessage(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+// One per module under test, each a group of RUN_TEST()s
+void runFixedPointStatsTests();
+void runShapeStatsTests();
+void runFilterCoeffsTests();
+void runVelocityTests();
+void runSpectrumFftTests();
+void runGoertzelTests();
+
+#endif // TEST_SIGNAL_PROCESSING_H
@@ -0,0 +1,105 @@
+// Shared real FFT and spectrum analyzer
+//
+// fftRealPower() is checked against a direct double-precision DFT at both
+// sizes in use (512 points for the envelope, 1024 for the spectrum). The
+// spectrum analyzer is then run end to end on a 50.3 Hz + 180 Hz tone pair
+// with 1 g of gravity and a 7 Hz wobble. Its peaks and band energies must
+// match the analytic values, and the values it gave before the FFT and
+// peak picking were split out for the envelope analyzer.
+
+#include "test_signal_processing.h"
+#include "spectrum.h"
+#include "envelope.h"
+
+#define TEST_FFT_TOL     1e-5   // Power error relative to the spectrum's peak
+#define TEST_MAX_HALF    (SPECTRUM_FFT_SIZE / 2)
+
+static_assert(ENVELOPE_FFT_SIZE <= SPECTRUM_FFT_SIZE, "FFT check buffers sized for the spectrum");
+
+static void expectNear(const char* what, double got, double expected, double tol) {
+  TEST_ASSERT_TRUE_MESSAGE(fabs(got - expected) <= tol,
+                           testMessage("%s: %.5f, expected %.5f +- %.5f", what, got, expected, tol));
+}
+
+static void checkFft(uint16_t half) {
+  static float data[2 * TEST_MAX_HALF], input[2 * TEST_MAX_HALF];
+  static float tw_cos[TEST_MAX_HALF], tw_sin[TEST_MAX_HALF], power[TEST_MAX_HALF + 1];
+  const uint16_t n = 2 * half;
+  for (uint16_t k = 0; k < half; k++) {
+    tw_cos[k] = cosf(2.0f * (float)M_PI * k / n);
+    tw_sin[k] = sinf(2.0f * (float)M_PI * k / n);
+  }
+  uint32_t seed = 99;
+  for (uint16_t i = 0; i < n; i++) {
+    seed = seed * 1103515245u + 12345u;
+    input[i] = (float)((int32_t)((seed >> 12) & 0xFFFF) - 32768) / 32768.0f + 0.3f * sinf(0.2f * i);
+    data[i] = input[i];
+  }
+  fftRealPower(data, half, tw_cos, tw_sin, power);
+
+  double ref[TEST_MAX_HALF + 1];
+  double peak = 0;
+  for (uint16_t k = 0; k <= half; k++) {
+    double re = 0, im = 0;
+    for (uint16_t i = 0; i < n; i++) {
+      const double w = 2.0 * M_PI * (double)((uint32_t)k * i % n) / n;
+      re += input[i] * cos(w);
+      im -= input[i] * sin(w);
+    }
+    ref[k] = re * re + im * im;
+    if (ref[k] > peak) peak = ref[k];
+  }
+  double worst = 0;
+  for (uint16_t k = 0; k <= half; k++) {
+    const double err = fabs(power[k] - ref[k]) / peak;
+    if (err > worst) worst = err;
+  }
+  TEST_ASSERT_TRUE_MESSAGE(worst <= TEST_FFT_TOL,
+                           testMessage("%u-point FFT power off the DFT by %.2e of the peak", n, worst));
+}
+
+static void testAnalyzer() {
+  static PackedHistory history[NUM_ACCEL_CHANNELS];
+  const float counts_per_g = 256000.0f;
+  history[0].begin(4096, 4096);
+  spectrumAnalyzer.begin();
+  for (uint32_t i = 0; i < 2000; i++) {
+    const double t = i / 1000.0;
+    int32_t x = (int32_t)lround(counts_per_g * (0.5 * sin(2 * M_PI * 50.3 * t) + 0.1 * sin(2 * M_PI * 180 * t)));
+    int32_t z = (int32_t)lround(counts_per_g * (1.0 + 0.02 * sin(2 * M_PI * 7 * t)));
+    history[0].add(x, 0, z, i * 1000UL);
+  }
+  spectrumAnalyzer.markDue(0);
+  SpectrumResult r;
+  TEST_ASSERT_TRUE_MESSAGE(spectrumAnalyzer.stage(history, 1000, counts_per_g), "spectrum not staged");
+  spectrumAnalyzer.process();
+  TEST_ASSERT_TRUE_MESSAGE(spectrumAnalyzer.getResult(0, r), "no spectrum result");
+
+  // Before the split: x (50.30 Hz, 0.4999 g) (179.95 Hz, 0.1000 g), bands
+  // 0.3536 / 0.0707 g; z (6.96 Hz, 0.0200 g), band 0.0141 g
+  const AxisSpectrum& x = r.axis[0];
+  const AxisSpectrum& z = r.axis[2];
+  expectNear("x peak 1 frequency", x.peaks[0].frequency_hz, 50.30, 0.01);
+  expectNear("x peak 1 amplitude", x.peaks[0].amplitude_g, 0.4999, 0.0002);
+  expectNear("x peak 2 frequency", x.peaks[1].frequency_hz, 179.95, 0.01);
+  expectNear("x peak 2 amplitude", x.peaks[1].amplitude_g, 0.1000, 0.0002);
+  expectNear("x 10-100 Hz band", x.band_rms_g[1], 0.5 / sqrt(2.0), 0.0002);
+  expectNear("x 100-250 Hz band", x.band_rms_g[2], 0.1 / sqrt(2.0), 0.0002);
+  expectNear("z peak frequency", z.peaks[0].frequency_hz, 6.96, 0.01);
+  expectNear("z peak amplitude", z.peaks[0].amplitude_g, 0.0200, 0.0002);
+  expectNear("z 2-10 Hz band", z.band_rms_g[0], 0.02 / sqrt(2.0), 0.0002);
+}
+
+static void testEnvelopeFft() {
+  checkFft(ENVELOPE_FFT_SIZE / 2);
+}
+
+static void testSpectrumFft() {
+  checkFft(SPECTRUM_FFT_SIZE / 2);
+}
+
+void runSpectrumFftTests() {
+  RUN_TEST(testEnvelopeFft);
+  RUN_TEST(testSpectrumFft);
+  RUN_TEST(testAnalyzer);
+}
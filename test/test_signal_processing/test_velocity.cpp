@@ -0,0 +1,67 @@
+// Velocity RMS near the high-pass corner
+//
+// A 0.1 g sine on X (and on Z, over 1 g of gravity) must give the velocity
+// RMS of an ideal integrator behind the 2nd-order Butterworth high-pass,
+// 0.1 g / (2 pi f) / sqrt(2) * |H(f)|, within 1.5%, including tones close
+// to the high-pass corner where the integrator leak used to read low.
+// Gravity alone must read zero.
+
+#include "test_signal_processing.h"
+#include "velocity.h"
+
+#define TEST_COUNTS_PER_G  256000
+#define TEST_REL_TOL       0.015
+
+static void checkTone(uint16_t fs, uint16_t highpass_hz, double tone_hz) {
+  // Blocks of two seconds hold whole periods of every tone used here
+  velocityMeter.setSettings(DEFAULT_ISO_MACHINE_CLASS, highpass_hz);
+  velocityMeter.configure(fs, TEST_COUNTS_PER_G, 2 * fs);
+  for (uint32_t n = 0; n < 20UL * fs; n++) {
+    const double a = 0.1 * sin(2 * M_PI * tone_hz * n / fs);
+    velocityMeter.processSample(0, (int32_t)lround(a * TEST_COUNTS_PER_G), 0,
+                                (int32_t)lround((1.0 + a) * TEST_COUNTS_PER_G));
+  }
+  VelocityResult r;
+  velocityMeter.getResult(0, r);
+
+  const double ratio = highpass_hz / tone_hz;
+  const double expected = 0.1 * 9806650.0 / (2 * M_PI * tone_hz) / sqrt(2.0) / sqrt(1 + ratio * ratio * ratio * ratio);
+  for (uint8_t a = 0; a < 3; a += 2) {
+    TEST_ASSERT_TRUE_MESSAGE(fabs(r.rms_um_s[a] - expected) <= TEST_REL_TOL * expected,
+                             testMessage("%.1f Hz, %u Hz high-pass @ %u Hz, axis %u: %lu um/s, expected %.0f",
+                                         tone_hz, highpass_hz, fs, a, (unsigned long)r.rms_um_s[a], expected));
+  }
+}
+
+static void testGravity() {
+  velocityMeter.setSettings(DEFAULT_ISO_MACHINE_CLASS, 2);
+  velocityMeter.configure(1000, TEST_COUNTS_PER_G, 1000);
+  for (uint32_t n = 0; n < 5000; n++) {
+    velocityMeter.processSample(0, 1000, -500, TEST_COUNTS_PER_G);
+  }
+  VelocityResult r;
+  velocityMeter.getResult(0, r);
+  TEST_ASSERT_TRUE_MESSAGE(r.rms_um_s[0] == 0 && r.rms_um_s[1] == 0 && r.rms_um_s[2] == 0,
+                           testMessage("gravity alone reads %lu %lu %lu um/s", (unsigned long)r.rms_um_s[0],
+                                       (unsigned long)r.rms_um_s[1], (unsigned long)r.rms_um_s[2]));
+}
+
+// Tones well above the high-pass corner
+static void testTonesAboveCorner() {
+  checkTone(1000, 10, 50.0);
+  checkTone(1000, 2, 5.0);
+  checkTone(4000, 2, 5.0);
+}
+
+// Tones close to the corner, where the integrator leak used to read low
+static void testTonesNearCorner() {
+  checkTone(1000, 2, 2.5);
+  checkTone(1000, 10, 12.5);
+  checkTone(4000, 2, 2.5);
+}
+
+void runVelocityTests() {
+  RUN_TEST(testTonesAboveCorner);
+  RUN_TEST(testTonesNearCorner);
+  RUN_TEST(testGravity);
+}